@@ -21,25 +21,29 @@ int main()
     cmat rhoG1 = prj(G1);
 
     // then construct the graph state via 2 methods:
-    // qpp::apply() and qpp::applyCTRL()
+    // a single fused layer of Control-Phases (qpp::DiagonalGate), applied in
+    // one pass over the state, and qpp::applyCTRL_inplace()
     // result should be the same, we check later
-    cmat H3 = kronpow(gt.H, 3); // all |+>
-    G0 = (H3 * G0).eval();
+    KronOperator H3(gt.H, 3); // all |+>, one Hadamard at a time
+    H3.apply_inplace(G0);
     G1 = G0;
-    rhoG0 = (H3 * rhoG0 * adjoint(H3)).eval();
+    H3.apply_inplace(rhoG0);
     rhoG1 = rhoG0;
-    // apply pairwise Control-Phases
+    // pairwise Control-Phases
+    DiagonalGate layer({2, 2, 2});
     for (idx i = 0; i < 3; ++i)
         for (idx j = i + 1; j < 3; ++j)
         {
             if (Gamma[i][j])
             {
-                G0 = apply(G0, gt.CZ, {i, j});
-                G1 = applyCTRL(G1, gt.Z, {i}, {j});
-                rhoG0 = apply(rhoG0, gt.CZ, {i, j});
-                rhoG1 = applyCTRL(rhoG1, gt.Z, {i}, {j});
+                layer.add(gt.CZ, {i, j});
+                // in-place, no extra copies of the states
+                applyCTRL_inplace(G1, gt.Z, {i}, {j});
+                applyCTRL_inplace(rhoG1, gt.Z, {i}, {j});
             }
         }
+    layer.apply_inplace(G0);
+    layer.apply_inplace(rhoG0);
     // end construction
 
     std::cout << ">> Resulting graph states:\n";
@@ -25,8 +25,8 @@ int main()
 
     ket psi = mket(n2multiidx(0, dims)); // computational |0>^\otimes n
 
-    // apply H^\otimes n, no aliasing
-    psi = (kronpow(gt.H, n) * psi).eval();
+    // apply H^\otimes n, one qubit at a time, without the N x N matrix
+    KronOperator(gt.H, n).apply_inplace(psi);
 
     cmat G = 2 * prj(psi) - gt.Id(N); // Diffusion operator
 
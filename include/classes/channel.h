@@ -0,0 +1,254 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file classes/channel.h
+* \brief Quantum channels with a precomputed superoperator
+*/
+
+#ifndef CLASSES_CHANNEL_H_
+#define CLASSES_CHANNEL_H_
+
+namespace qpp
+{
+/**
+* \class qpp::Channel
+* \brief Quantum channel specified by a set of Kraus operators
+* \see qpp::apply(), qpp::kraus2super()
+*
+* Precomputes the superoperator matrix of the channel once (see
+* qpp::kraus2super()), so that the channel can be applied many times, e.g.
+* after every layer of a noisy circuit, to any subsystem of a multi-partite
+* density matrix. Each application is a single pass over the density matrix
+* that maps every \f$D_A\times D_A\f$ block with the superoperator, hence its
+* cost does not depend on the number of Kraus operators.
+*/
+class Channel
+{
+    std::vector<cmat> Ks_; ///< Kraus operators
+    idx DA_;               ///< dimension of the Kraus operators
+    cmat S_;               ///< superoperator matrix
+
+public:
+    /**
+    * \brief Constructs the channel from its Kraus operators
+    *
+    * \param Ks Set of Kraus operators
+    */
+    explicit Channel(const std::vector<cmat>& Ks) :
+            Ks_{Ks}, DA_{}, S_{}
+    {
+        // EXCEPTION CHECKS
+
+        if (Ks.size() == 0)
+            throw exception::ZeroSize("qpp::Channel::Channel()");
+        if (!internal::check_nonzero_size(Ks[0]))
+            throw exception::ZeroSize("qpp::Channel::Channel()");
+        if (!internal::check_square_mat(Ks[0]))
+            throw exception::MatrixNotSquare("qpp::Channel::Channel()");
+        for (auto&& it : Ks)
+            if (it.rows() != Ks[0].rows() || it.cols() != Ks[0].rows())
+                throw exception::DimsNotEqual("qpp::Channel::Channel()");
+        // END EXCEPTION CHECKS
+
+        DA_ = static_cast<idx>(Ks[0].rows());
+        S_ = kraus2super(Ks);
+    }
+
+    /**
+    * \brief Kraus operators
+    *
+    * \return Set of Kraus operators
+    */
+    const std::vector<cmat>& get_Ks() const noexcept
+    {
+        return Ks_;
+    }
+
+    /**
+    * \brief Superoperator matrix
+    * \see qpp::kraus2super()
+    *
+    * \return Superoperator matrix
+    */
+    const cmat& get_super() const noexcept
+    {
+        return S_;
+    }
+
+    /**
+    * \brief Dimension of the system the channel acts on
+    *
+    * \return Dimension of the Kraus operators
+    */
+    idx get_D() const noexcept
+    {
+        return DA_;
+    }
+
+    /**
+    * \brief Applies in-place the channel to the part \a subsys of the
+    * multi-partite density matrix \a A
+    *
+    * \param A Eigen expression, overwritten by the output density matrix
+    * \param subsys Subsystem indexes where the channel is applied
+    * \param dims Dimensions of the multi-partite system
+    */
+    template<typename Derived>
+    void apply_inplace(Eigen::MatrixBase<Derived>& A,
+                       const std::vector<idx>& subsys,
+                       const std::vector<idx>& dims) const
+    {
+        auto& rA = A.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero sizes
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::Channel::apply_inplace()");
+
+        // check square matrix for the A
+        if (!internal::check_square_mat(rA))
+            throw exception::MatrixNotSquare(
+                    "qpp::Channel::apply_inplace()");
+
+        // check that dimension is valid
+        if (!internal::check_dims(dims))
+            throw exception::DimsInvalid("qpp::Channel::apply_inplace()");
+
+        // check that dims match A matrix
+        if (!internal::check_dims_match_mat(dims, rA))
+            throw exception::DimsMismatchMatrix(
+                    "qpp::Channel::apply_inplace()");
+
+        // check subsys is valid w.r.t. dims
+        if (!internal::check_subsys_match_dims(subsys, dims))
+            throw exception::SubsysMismatchDims(
+                    "qpp::Channel::apply_inplace()");
+
+        // check that the channel matches the dimensions of the subsys
+        std::vector<idx> subsys_dims(subsys.size());
+        for (idx i = 0; i < subsys.size(); ++i)
+            subsys_dims[i] = dims[subsys[i]];
+        if (!internal::check_dims_match_mat(subsys_dims, Ks_[0]))
+            throw exception::MatrixMismatchSubsys(
+                    "qpp::Channel::apply_inplace()");
+        // END EXCEPTION CHECKS
+
+        internal::apply_super_rho_inplace(
+                rA, S_, internal::get_subsys_offsets(subsys, dims),
+                internal::get_subsys_offsets(complement(subsys, dims.size()),
+                                             dims));
+    }
+
+    /**
+    * \brief Applies in-place the channel to the part \a subsys of the
+    * multi-partite density matrix \a A
+    *
+    * \param A Eigen expression, overwritten by the output density matrix
+    * \param subsys Subsystem indexes where the channel is applied
+    * \param d Subsystem dimensions
+    */
+    template<typename Derived>
+    void apply_inplace(Eigen::MatrixBase<Derived>& A,
+                       const std::vector<idx>& subsys, idx d = 2) const
+    {
+        auto& rA = A.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero size
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::Channel::apply_inplace()");
+
+        // check valid dims
+        if (d < 2)
+            throw exception::DimsInvalid("qpp::Channel::apply_inplace()");
+        // END EXCEPTION CHECKS
+
+        idx N = internal::get_num_subsys(static_cast<idx>(rA.rows()), d);
+        std::vector<idx> dims(N, d); // local dimensions vector
+
+        apply_inplace(rA, subsys, dims);
+    }
+
+    /**
+    * \brief Applies the channel to the part \a subsys of the multi-partite
+    * density matrix \a A
+    *
+    * \param A Eigen expression
+    * \param subsys Subsystem indexes where the channel is applied
+    * \param dims Dimensions of the multi-partite system
+    * \return Output density matrix after the action of the channel
+    */
+    template<typename Derived>
+    cmat apply(const Eigen::MatrixBase<Derived>& A,
+               const std::vector<idx>& subsys,
+               const std::vector<idx>& dims) const
+    {
+        cmat result = A.derived();
+        apply_inplace(result, subsys, dims);
+
+        return result;
+    }
+
+    /**
+    * \brief Applies the channel to the part \a subsys of the multi-partite
+    * density matrix \a A
+    *
+    * \param A Eigen expression
+    * \param subsys Subsystem indexes where the channel is applied
+    * \param d Subsystem dimensions
+    * \return Output density matrix after the action of the channel
+    */
+    template<typename Derived>
+    cmat apply(const Eigen::MatrixBase<Derived>& A,
+               const std::vector<idx>& subsys, idx d = 2) const
+    {
+        cmat result = A.derived();
+        apply_inplace(result, subsys, d);
+
+        return result;
+    }
+
+    /**
+    * \brief Applies the channel to the density matrix \a A
+    *
+    * \param A Eigen expression
+    * \return Output density matrix after the action of the channel
+    */
+    template<typename Derived>
+    cmat apply(const Eigen::MatrixBase<Derived>& A) const
+    {
+        // EXCEPTION CHECKS
+
+        if (static_cast<idx>(A.rows()) != DA_ ||
+            static_cast<idx>(A.cols()) != DA_)
+            throw exception::DimsMismatchMatrix("qpp::Channel::apply()");
+        // END EXCEPTION CHECKS
+
+        return apply(A, {0}, std::vector<idx>{DA_});
+    }
+}; /* class Channel */
+
+} /* namespace qpp */
+
+#endif /* CLASSES_CHANNEL_H_ */
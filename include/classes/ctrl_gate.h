@@ -0,0 +1,296 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file classes/ctrl_gate.h
+* \brief Matrix-free (controlled) gates acting on multi-partite systems
+*/
+
+#ifndef CLASSES_CTRL_GATE_H_
+#define CLASSES_CTRL_GATE_H_
+
+namespace qpp
+{
+/**
+* \class qpp::CtrlGate
+* \brief Matrix-free operator of a (controlled) gate acting on part of a
+* multi-partite system
+* \see qpp::Gates::CTRL_op(), qpp::Gates::expandout_op()
+*
+* Stores only the gate, its control and target subsystems and the dimensions
+* of the system, instead of the \f$D\times D\f$ matrix returned by
+* qpp::Gates::CTRL() or qpp::Gates::expandout(). It applies itself to kets
+* and density matrices with the same kernels as qpp::applyCTRL(), in
+* \f$O(D\cdot D_A)\f$ operations per column, where \f$D_A\f$ is the
+* dimension of the gate. The full matrix is only built on request, by
+* qpp::CtrlGate::to_dense().
+*
+* Example:
+* \code
+* CtrlGate CX = gt.CTRL_op(gt.X, {0}, {5}, 20); // no 2^20 x 2^20 matrix
+* ket psi = CX * mket(std::vector<idx>(20, 1));
+* \endcode
+*/
+class CtrlGate
+{
+    std::vector<idx> ctrl_;   ///< control subsystems
+    std::vector<idx> subsys_; ///< subsystems where the gate is applied
+    std::vector<idx> dims_;   ///< dimensions of the system
+    std::vector<cmat> Ai_;    ///< powers of the gate, Ai_[1] is the gate
+
+    // applies the gate to the ket or density matrix state, no error checks
+    template<typename Derived>
+    void apply_inplace_(Eigen::MatrixBase<Derived>& state) const
+    {
+        if (state.rows() > 1)
+            internal::apply_ctrl_inplace(state, Ai_, ctrl_, subsys_, dims_);
+    }
+
+public:
+    /**
+    * \brief Constructs the controlled gate
+    *
+    * \note The dimension of the gate \a A must match the dimension of
+    * \a subsys. Also, all control subsystems in \a ctrl must have the same
+    * dimension.
+    *
+    * \param A Eigen expression
+    * \param ctrl Control subsystem indexes, may be empty
+    * \param subsys Subsystem indexes where the gate \a A is applied
+    * \param dims Dimensions of the multi-partite system
+    */
+    template<typename Derived>
+    CtrlGate(const Eigen::MatrixBase<Derived>& A,
+             const std::vector<idx>& ctrl, const std::vector<idx>& subsys,
+             const std::vector<idx>& dims) :
+            ctrl_{ctrl}, subsys_{subsys}, dims_{dims}, Ai_{}
+    {
+        const cmat rA = A.template cast<cplx>();
+
+        // EXCEPTION CHECKS
+
+        // check zero sizes
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::CtrlGate::CtrlGate()");
+
+        // check square matrix for the gate
+        if (!internal::check_square_mat(rA))
+            throw exception::MatrixNotSquare("qpp::CtrlGate::CtrlGate()");
+
+        // check that dimension is valid
+        if (!internal::check_dims(dims))
+            throw exception::DimsInvalid("qpp::CtrlGate::CtrlGate()");
+
+        // check subsys is valid w.r.t. dims
+        if (subsys.size() == 0)
+            throw exception::ZeroSize("qpp::CtrlGate::CtrlGate()");
+        if (!internal::check_subsys_match_dims(subsys, dims))
+            throw exception::SubsysMismatchDims("qpp::CtrlGate::CtrlGate()");
+
+        // check that all control subsystems have the same dimension
+        for (auto&& k : ctrl)
+            if (k >= dims.size() || dims[k] != dims[ctrl[0]])
+                throw exception::DimsNotEqual("qpp::CtrlGate::CtrlGate()");
+
+        // check that ctrl + gate subsystem is valid
+        // with respect to local dimensions
+        std::vector<idx> ctrlgate = ctrl;
+        ctrlgate.insert(std::end(ctrlgate), std::begin(subsys),
+                        std::end(subsys));
+        std::sort(std::begin(ctrlgate), std::end(ctrlgate));
+        if (!internal::check_subsys_match_dims(ctrlgate, dims))
+            throw exception::SubsysMismatchDims("qpp::CtrlGate::CtrlGate()");
+
+        // check that gate matches the dimensions of the subsys
+        std::vector<idx> subsys_dims(subsys.size());
+        for (idx i = 0; i < subsys.size(); ++i)
+            subsys_dims[i] = dims[subsys[i]];
+        if (!internal::check_dims_match_mat(subsys_dims, rA))
+            throw exception::MatrixMismatchSubsys(
+                    "qpp::CtrlGate::CtrlGate()");
+        // END EXCEPTION CHECKS
+
+        // A^i is applied when all controls are equal to i
+        idx d = ctrl.size() > 0 ? dims[ctrl[0]] : 2;
+        Ai_ = internal::gate_powers<cplx>(rA, std::max(d, idx{2}));
+    }
+
+    /**
+    * \brief Gate
+    *
+    * \return Gate, without the controls
+    */
+    const cmat& get_gate() const noexcept
+    {
+        return Ai_[1];
+    }
+
+    /**
+    * \brief Control subsystems
+    *
+    * \return Control subsystem indexes
+    */
+    const std::vector<idx>& get_ctrl() const noexcept
+    {
+        return ctrl_;
+    }
+
+    /**
+    * \brief Subsystems where the gate is applied
+    *
+    * \return Subsystem indexes where the gate is applied
+    */
+    const std::vector<idx>& get_subsys() const noexcept
+    {
+        return subsys_;
+    }
+
+    /**
+    * \brief Dimensions of the system
+    *
+    * \return Dimensions of the multi-partite system
+    */
+    const std::vector<idx>& get_dims() const noexcept
+    {
+        return dims_;
+    }
+
+    /**
+    * \brief Total dimension of the system
+    *
+    * \return Total dimension of the multi-partite system
+    */
+    idx get_D() const noexcept
+    {
+        return std::accumulate(std::begin(dims_), std::end(dims_),
+                               static_cast<idx>(1), std::multiplies<idx>());
+    }
+
+    /**
+    * \brief Dense matrix of the operator
+    *
+    * \note Allocates a \f$D\times D\f$ matrix, only meant for the cases when
+    * the full matrix is really needed
+    *
+    * \return Matrix of the operator, identical to the one returned by
+    * qpp::Gates::CTRL() or qpp::Gates::expandout()
+    */
+    cmat to_dense() const
+    {
+        return internal::ctrl_gate_to_dense(
+                Ai_, internal::CtrlGateIndex(ctrl_, subsys_, dims_));
+    }
+
+    /**
+    * \brief Applies in-place the operator to the state vector or density
+    * matrix \a state, i.e. \f$|\psi\rangle\to C|\psi\rangle\f$ or
+    * \f$\rho\to C\rho C^\dagger\f$
+    *
+    * \param state Eigen expression, overwritten by the output state
+    */
+    template<typename Derived>
+    void apply_inplace(Eigen::MatrixBase<Derived>& state) const
+    {
+        auto& rstate = state.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero sizes
+        if (!internal::check_nonzero_size(rstate))
+            throw exception::ZeroSize("qpp::CtrlGate::apply_inplace()");
+
+        // check that state is a ket or a density matrix matching dims
+        if (internal::check_cvector(rstate))
+        {
+            if (!internal::check_dims_match_cvect(dims_, rstate))
+                throw exception::DimsMismatchCvector(
+                        "qpp::CtrlGate::apply_inplace()");
+        } else if (internal::check_square_mat(rstate))
+        {
+            if (!internal::check_dims_match_mat(dims_, rstate))
+                throw exception::DimsMismatchMatrix(
+                        "qpp::CtrlGate::apply_inplace()");
+        } else
+            throw exception::MatrixNotSquareNorCvector(
+                    "qpp::CtrlGate::apply_inplace()");
+        // END EXCEPTION CHECKS
+
+        apply_inplace_(rstate);
+    }
+
+    /**
+    * \brief Applies the operator to the state vector or density matrix
+    * \a state, i.e. \f$|\psi\rangle\to C|\psi\rangle\f$ or
+    * \f$\rho\to C\rho C^\dagger\f$
+    *
+    * \param state Eigen expression
+    * \return Operator applied to \a state
+    */
+    template<typename Derived>
+    cmat apply(const Eigen::MatrixBase<Derived>& state) const
+    {
+        cmat result = state.derived();
+        apply_inplace(result);
+
+        return result;
+    }
+
+    /**
+    * \brief Matrix product of the operator with \a A, column by column
+    *
+    * \note For a density matrix \f$\rho\f$ this is \f$C\rho\f$, use
+    * qpp::CtrlGate::apply() for \f$C\rho C^\dagger\f$
+    *
+    * \param A Eigen expression, with as many rows as the total dimension of
+    * the system
+    * \return Product \f$CA\f$
+    */
+    template<typename Derived>
+    cmat operator*(const Eigen::MatrixBase<Derived>& A) const
+    {
+        cmat result = A.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero sizes
+        if (!internal::check_nonzero_size(result))
+            throw exception::ZeroSize("qpp::CtrlGate::operator*()");
+
+        // check that the number of rows matches dims
+        if (static_cast<idx>(result.rows()) != get_D())
+            throw exception::DimsMismatchMatrix("qpp::CtrlGate::operator*()");
+        // END EXCEPTION CHECKS
+
+        ket col;
+        for (idx c = 0; c < static_cast<idx>(result.cols()); ++c)
+        {
+            col = result.col(c);
+            apply_inplace_(col);
+            result.col(c) = col;
+        }
+
+        return result;
+    }
+}; /* class CtrlGate */
+
+} /* namespace qpp */
+
+#endif /* CLASSES_CTRL_GATE_H_ */
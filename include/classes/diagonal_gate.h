@@ -0,0 +1,373 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file classes/diagonal_gate.h
+* \brief Diagonal gates acting on multi-partite systems
+*/
+
+#ifndef CLASSES_DIAGONAL_GATE_H_
+#define CLASSES_DIAGONAL_GATE_H_
+
+namespace qpp
+{
+/**
+* \class qpp::DiagonalGate
+* \brief Diagonal gate (e.g. a product of Z, S, T, CZ, controlled phases)
+* acting on a multi-partite system
+* \see qpp::apply(), qpp::applyCTRL()
+*
+* The gate is stored as a product of diagonal factors, each one given by the
+* table of its phases on a few subsystems. Gates added one after the other
+* are fused: a factor acting on subsystems that are already covered by
+* another factor is multiplied into the phase table of the latter. Applying
+* the gate is an elementwise multiplication of the state by its phases, done
+* in a single pass over the state whatever the number of fused gates, e.g. a
+* whole layer of controlled-phase gates.
+*
+* Example:
+* \code
+* DiagonalGate layer({2, 2, 2});
+* layer.add(gt.CZ, {0, 1}).add(gt.CZ, {1, 2}).add(gt.T, {2});
+* ket psi = layer.apply(st.plus(3)); // single pass over psi
+* \endcode
+*/
+class DiagonalGate
+{
+    std::vector<idx> dims_;                  ///< dimensions of the system
+    std::vector<std::vector<idx>> subsys_;   ///< sorted subsystems per factor
+    std::vector<dyn_col_vect<cplx>> phases_; ///< phase table per factor
+
+    // index of the basis state m of the subsystems from, restricted to the
+    // subsystems to (a subset of from, in any order)
+    idx restrict_(idx m, const std::vector<idx>& from,
+                  const std::vector<idx>& to) const
+    {
+        idx midx[maxn];
+        for (idx k = from.size(); k-- > 0;)
+        {
+            midx[from[k]] = m % dims_[from[k]];
+            m /= dims_[from[k]];
+        }
+        idx result = 0;
+        for (auto&& k : to)
+            result = result * dims_[k] + midx[k];
+
+        return result;
+    }
+
+    // product of the dimensions of the subsystems subsys
+    idx dim_(const std::vector<idx>& subsys) const
+    {
+        idx result = 1;
+        for (auto&& k : subsys)
+            result *= dims_[k];
+
+        return result;
+    }
+
+    // multiplies the factor with phase table phases on the sorted subsystems
+    // subsys into the gate
+    void add_factor_(const std::vector<idx>& subsys, dyn_col_vect<cplx> phases)
+    {
+        // covered by an existing factor, multiply it in
+        for (idx f = 0; f < subsys_.size(); ++f)
+            if (std::includes(std::begin(subsys_[f]), std::end(subsys_[f]),
+                              std::begin(subsys), std::end(subsys)))
+            {
+                for (idx m = 0; m < static_cast<idx>(phases_[f].rows()); ++m)
+                    phases_[f](m) *= phases(restrict_(m, subsys_[f], subsys));
+                return;
+            }
+
+        // absorb the existing factors it covers
+        for (idx f = subsys_.size(); f-- > 0;)
+            if (std::includes(std::begin(subsys), std::end(subsys),
+                              std::begin(subsys_[f]), std::end(subsys_[f])))
+            {
+                for (idx m = 0; m < static_cast<idx>(phases.rows()); ++m)
+                    phases(m) *= phases_[f](restrict_(m, subsys, subsys_[f]));
+                subsys_.erase(std::begin(subsys_) + f);
+                phases_.erase(std::begin(phases_) + f);
+            }
+        subsys_.push_back(subsys);
+        phases_.push_back(std::move(phases));
+    }
+
+public:
+    /**
+    * \brief Constructs the identity gate on a multi-partite system
+    *
+    * \param dims Dimensions of the multi-partite system
+    */
+    explicit DiagonalGate(const std::vector<idx>& dims) :
+            dims_{dims}, subsys_{}, phases_{}
+    {
+        // EXCEPTION CHECKS
+
+        if (!internal::check_dims(dims))
+            throw exception::DimsInvalid("qpp::DiagonalGate::DiagonalGate()");
+        // END EXCEPTION CHECKS
+    }
+
+    /**
+    * \brief Multiplies the gate by the diagonal gate \a A acting on the part
+    * \a subsys of the system
+    *
+    * \param A Eigen expression, diagonal matrix
+    * \param subsys Subsystem indexes where the gate \a A is applied
+    * \return Reference to the current instance
+    */
+    template<typename Derived>
+    DiagonalGate& add(const Eigen::MatrixBase<Derived>& A,
+                      const std::vector<idx>& subsys)
+    {
+        const cmat rA = A.template cast<cplx>();
+
+        // EXCEPTION CHECKS
+
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::DiagonalGate::add()");
+        if (!internal::check_square_mat(rA))
+            throw exception::MatrixNotSquare("qpp::DiagonalGate::add()");
+        if (!internal::check_diagonal(rA))
+            throw exception::CustomException("qpp::DiagonalGate::add()",
+                                             "Not a diagonal matrix!");
+        if (!internal::check_subsys_match_dims(subsys, dims_))
+            throw exception::SubsysMismatchDims("qpp::DiagonalGate::add()");
+        std::vector<idx> subsys_dims(subsys.size());
+        for (idx i = 0; i < subsys.size(); ++i)
+            subsys_dims[i] = dims_[subsys[i]];
+        if (!internal::check_dims_match_mat(subsys_dims, rA))
+            throw exception::MatrixMismatchSubsys("qpp::DiagonalGate::add()");
+        // END EXCEPTION CHECKS
+
+        std::vector<idx> sorted = subsys;
+        std::sort(std::begin(sorted), std::end(sorted));
+        dyn_col_vect<cplx> phases(rA.rows());
+        for (idx m = 0; m < static_cast<idx>(rA.rows()); ++m)
+        {
+            idx a = restrict_(m, sorted, subsys);
+            phases(m) = rA(a, a);
+        }
+        add_factor_(sorted, std::move(phases));
+
+        return *this;
+    }
+
+    /**
+    * \brief Multiplies the gate by the controlled diagonal gate \a A, acting
+    * on the part \a subsys of the system and controlled by the subsystems
+    * \a ctrl
+    * \see qpp::applyCTRL()
+    *
+    * \note All control subsystems in \a ctrl must have the same dimension
+    *
+    * \param A Eigen expression, diagonal matrix
+    * \param ctrl Control subsystem indexes
+    * \param subsys Subsystem indexes where the gate \a A is applied
+    * \return Reference to the current instance
+    */
+    template<typename Derived>
+    DiagonalGate& add_ctrl(const Eigen::MatrixBase<Derived>& A,
+                           const std::vector<idx>& ctrl,
+                           const std::vector<idx>& subsys)
+    {
+        const cmat rA = A.template cast<cplx>();
+
+        // EXCEPTION CHECKS
+
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::DiagonalGate::add_ctrl()");
+        if (!internal::check_square_mat(rA))
+            throw exception::MatrixNotSquare(
+                    "qpp::DiagonalGate::add_ctrl()");
+        if (!internal::check_diagonal(rA))
+            throw exception::CustomException("qpp::DiagonalGate::add_ctrl()",
+                                             "Not a diagonal matrix!");
+        std::vector<idx> ctrlgate = ctrl;
+        ctrlgate.insert(std::end(ctrlgate), std::begin(subsys),
+                        std::end(subsys));
+        if (!internal::check_subsys_match_dims(ctrlgate, dims_))
+            throw exception::SubsysMismatchDims(
+                    "qpp::DiagonalGate::add_ctrl()");
+        idx d = ctrl.size() > 0 ? dims_[ctrl[0]] : 1;
+        for (idx i = 1; i < ctrl.size(); ++i)
+            if (dims_[ctrl[i]] != d)
+                throw exception::DimsNotEqual(
+                        "qpp::DiagonalGate::add_ctrl()");
+        std::vector<idx> subsys_dims(subsys.size());
+        for (idx i = 0; i < subsys.size(); ++i)
+            subsys_dims[i] = dims_[subsys[i]];
+        if (!internal::check_dims_match_mat(subsys_dims, rA))
+            throw exception::MatrixMismatchSubsys(
+                    "qpp::DiagonalGate::add_ctrl()");
+        // END EXCEPTION CHECKS
+
+        if (ctrl.empty())
+            return add(rA, subsys);
+
+        // A^i is applied when all controls are equal to i
+        std::vector<cmat> Ai =
+                internal::gate_powers<cplx>(rA, std::max(d, idx{2}));
+        std::sort(std::begin(ctrlgate), std::end(ctrlgate));
+        dyn_col_vect<cplx> phases = dyn_col_vect<cplx>::Ones(dim_(ctrlgate));
+        // index of the control basis state |11...1>
+        const idx ones = d > 1 ? (dim_(ctrl) - 1) / (d - 1) : 1;
+        for (idx m = 0; m < static_cast<idx>(phases.rows()); ++m)
+        {
+            // the controls are all equal to i iff c = i * ones
+            idx c = restrict_(m, ctrlgate, ctrl);
+            if (c % ones != 0)
+                continue;
+            idx i = c / ones;
+            idx a = restrict_(m, ctrlgate, subsys);
+            phases(m) = Ai[i](a, a);
+        }
+        add_factor_(ctrlgate, std::move(phases));
+
+        return *this;
+    }
+
+    /**
+    * \brief Multiplies the gate by another diagonal gate acting on the same
+    * system
+    *
+    * \param other Diagonal gate
+    * \return Reference to the current instance
+    */
+    DiagonalGate& add(const DiagonalGate& other)
+    {
+        // EXCEPTION CHECKS
+
+        if (other.dims_ != dims_)
+            throw exception::DimsNotEqual("qpp::DiagonalGate::add()");
+        // END EXCEPTION CHECKS
+
+        for (idx f = 0; f < other.subsys_.size(); ++f)
+            add_factor_(other.subsys_[f], other.phases_[f]);
+
+        return *this;
+    }
+
+    /**
+    * \brief Dimensions of the multi-partite system
+    *
+    * \return Dimensions of the multi-partite system
+    */
+    const std::vector<idx>& get_dims() const noexcept
+    {
+        return dims_;
+    }
+
+    /**
+    * \brief Number of factors the fused gates are stored as
+    *
+    * \return Number of diagonal factors
+    */
+    idx get_num_factors() const noexcept
+    {
+        return subsys_.size();
+    }
+
+    /**
+    * \brief Diagonal of the gate
+    *
+    * \return Diagonal of the gate, as a complex dynamic column vector of
+    * the total dimension of the system
+    */
+    ket get_diag() const
+    {
+        idx D = std::accumulate(std::begin(dims_), std::end(dims_),
+                                static_cast<idx>(1), std::multiplies<idx>());
+        ket result = ket::Ones(D);
+        internal::apply_phases_ket_inplace(result, dims_, subsys_, phases_);
+
+        return result;
+    }
+
+    /**
+    * \brief Dense matrix of the gate
+    *
+    * \return Diagonal matrix of the gate
+    */
+    cmat to_dense() const
+    {
+        return get_diag().asDiagonal();
+    }
+
+    /**
+    * \brief Applies in-place the gate to the state vector or density matrix
+    * \a A, i.e. \f$|\psi\rangle \to U|\psi\rangle\f$ or
+    * \f$\rho \to U\rho U^\dagger\f$
+    *
+    * \param A Eigen expression, overwritten by the output state
+    */
+    template<typename Derived>
+    void apply_inplace(Eigen::MatrixBase<Derived>& A) const
+    {
+        auto& rA = A.derived();
+
+        // EXCEPTION CHECKS
+
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::DiagonalGate::apply_inplace()");
+        if (internal::check_cvector(rA))
+        {
+            if (!internal::check_dims_match_cvect(dims_, rA))
+                throw exception::DimsMismatchCvector(
+                        "qpp::DiagonalGate::apply_inplace()");
+        } else if (internal::check_square_mat(rA))
+        {
+            if (!internal::check_dims_match_mat(dims_, rA))
+                throw exception::DimsMismatchMatrix(
+                        "qpp::DiagonalGate::apply_inplace()");
+        } else
+            throw exception::MatrixNotSquareNorCvector(
+                    "qpp::DiagonalGate::apply_inplace()");
+        // END EXCEPTION CHECKS
+
+        if (internal::check_cvector(rA))
+            internal::apply_phases_ket_inplace(rA, dims_, subsys_, phases_);
+        else
+            internal::apply_diag_rho_inplace(rA, get_diag());
+    }
+
+    /**
+    * \brief Applies the gate to the state vector or density matrix \a A
+    *
+    * \param A Eigen expression
+    * \return \f$U|\psi\rangle\f$ for a state vector or
+    * \f$U\rho U^\dagger\f$ for a density matrix
+    */
+    template<typename Derived>
+    cmat apply(const Eigen::MatrixBase<Derived>& A) const
+    {
+        cmat result = A.derived();
+        apply_inplace(result);
+
+        return result;
+    }
+}; /* class DiagonalGate */
+
+} /* namespace qpp */
+
+#endif /* CLASSES_DIAGONAL_GATE_H_ */
@@ -188,7 +188,12 @@ public:
             throw exception::DimsInvalid("qpp::Gates::Xd()");
         // END EXCEPTION CHECKS
 
-        return Fd(D).inverse() * Zd(D) * Fd(D);
+        // monomial, |j> -> |j + 1 mod D>, equal to Fd(D)^(-1) * Zd(D) * Fd(D)
+        cmat result = cmat::Zero(D, D);
+        for (idx j = 0; j < D; ++j)
+            result((j + 1) % D, j) = 1;
+
+        return result;
     }
 
     /**
@@ -279,104 +284,57 @@ public:
             throw exception::DimsMismatchMatrix("qpp::Gates::CTRL()");
         // END EXCEPTION CHECKS
 
-        // Use static allocation for speed!
-        idx Cdims[maxn];
-        idx midx_row[maxn];
-        idx midx_col[maxn];
-
-        idx CdimsA[maxn];
-        idx midxA_row[maxn];
-        idx midxA_col[maxn];
-
-        idx Cdims_bar[maxn];
-        idx Csubsys_bar[maxn];
-        idx midx_bar[maxn];
-
-        idx Ngate = subsys.size();
-        idx Nctrl = ctrl.size();
-        idx Nsubsys_bar = N - ctrlgate.size();
-        idx D = static_cast<idx>(std::llround(std::pow(d, N)));
-        idx DA = static_cast<idx>(rA.rows());
-        idx Dsubsys_bar = static_cast<idx>(
-                std::llround(std::pow(d, Nsubsys_bar)));
-
-        // compute the complementary subsystem of ctrlgate w.r.t. dims
-        std::vector<idx> subsys_bar = complement(ctrlgate, N);
-        std::copy(std::begin(subsys_bar), std::end(subsys_bar),
-                  std::begin(Csubsys_bar));
-
-        for (idx k = 0; k < N; ++k)
-        {
-            midx_row[k] = midx_col[k] = 0;
-            Cdims[k] = d;
-        }
-
-        for (idx k = 0; k < Nsubsys_bar; ++k)
-        {
-            Cdims_bar[k] = d;
-            midx_bar[k] = 0;
-        }
-
-        for (idx k = 0; k < Ngate; ++k)
-        {
-            midxA_row[k] = midxA_col[k] = 0;
-            CdimsA[k] = d;
-        }
-
-        dyn_mat<typename Derived::Scalar> result = dyn_mat<
-                typename Derived::Scalar>
-        ::Identity(D, D);
-        dyn_mat<typename Derived::Scalar> Ak;
-
-        // run over the complement indexes
-        for (idx i = 0; i < Dsubsys_bar; ++i)
-        {
-            // get the complement row multi-index
-            internal::n2multiidx(i, Nsubsys_bar, Cdims_bar, midx_bar);
-            for (idx k = 0; k < d; ++k)
-            {
-                Ak = powm(rA, k); // compute rA^k
-                // run over the subsys row multi-index
-                for (idx a = 0; a < DA; ++a)
-                {
-                    // get the subsys row multi-index
-                    internal::n2multiidx(a, Ngate, CdimsA, midxA_row);
-
-                    // construct the result row multi-index
-
-                    // first the ctrl part (equal for both row and column)
-                    for (idx c = 0; c < Nctrl; ++c)
-                        midx_row[ctrl[c]] = midx_col[ctrl[c]] = k;
-
-                    // then the complement part (equal for column)
-                    for (idx c = 0; c < Nsubsys_bar; ++c)
-                        midx_row[Csubsys_bar[c]] = midx_col[Csubsys_bar[c]] =
-                                midx_bar[c];
-
-                    // then the subsys part
-                    for (idx c = 0; c < Ngate; ++c)
-                        midx_row[subsys[c]] = midxA_row[c];
-
-                    // run over the subsys column multi-index
-                    for (idx b = 0; b < DA; ++b)
-                    {
-                        // get the subsys column multi-index
-                        internal::n2multiidx(b, Ngate, CdimsA, midxA_col);
-
-                        // construct the result column multi-index
-                        for (idx c = 0; c < Ngate; ++c)
-                            midx_col[subsys[c]] = midxA_col[c];
-
-                        // finally write the values
-                        result(internal::multiidx2n(midx_row, N, Cdims),
-                               internal::multiidx2n(midx_col, N, Cdims))
-                                = Ak(a, b);
-                    }
-                }
-            }
-        }
+        // table of powers A^k, A^k is applied when all controls are equal
+        // to k, written block by block over the identity
+        std::vector<dyn_mat<typename Derived::Scalar>> Ai =
+                internal::gate_powers<typename Derived::Scalar>(
+                        rA, std::max(d, static_cast<idx>(2)));
 
-        return result;
+        return internal::ctrl_gate_to_dense(
+                Ai, internal::CtrlGateIndex(ctrl, subsys, dims));
+    }
+
+    /**
+    * \brief Generates the multi-partite multiple-controlled-\a A gate as a
+    * matrix-free operator
+    * \see qpp::Gates::CTRL(), qpp::applyCTRL()
+    *
+    * The operator applies itself to kets and density matrices in
+    * \f$O(D\cdot D_A)\f$ operations, and is only converted to the matrix
+    * returned by qpp::Gates::CTRL() by qpp::CtrlGate::to_dense()
+    *
+    * \note The dimension of the gate \a A must match
+    * the dimension of \a subsys
+    *
+    * \param A Eigen expression
+    * \param ctrl Control subsystem indexes
+    * \param subsys Subsystem indexes where the gate \a A is applied
+    * \param N Total number of subsystems
+    * \param d Subsystem dimensions
+    * \return CTRL-A gate, as a qpp::CtrlGate
+    */
+    template<typename Derived>
+    CtrlGate CTRL_op(const Eigen::MatrixBase<Derived>& A,
+                     const std::vector<idx>& ctrl,
+                     const std::vector<idx>& subsys,
+                     idx N, idx d = 2) const
+    {
+        // EXCEPTION CHECKS
+
+        // check lists zero size
+        if (ctrl.size() == 0)
+            throw exception::ZeroSize("qpp::Gates::CTRL_op()");
+
+        // check out of range
+        if (N == 0)
+            throw exception::OutOfRange("qpp::Gates::CTRL_op()");
+
+        // check valid local dimension
+        if (d == 0)
+            throw exception::DimsInvalid("qpp::Gates::CTRL_op()");
+        // END EXCEPTION CHECKS
+
+        return CtrlGate(A, ctrl, subsys, std::vector<idx>(N, d));
     }
 
     /**
@@ -424,52 +382,12 @@ public:
             throw exception::DimsMismatchMatrix("qpp::Gates::expandout()");
         // END EXCEPTION CHECKS
 
-        idx D = std::accumulate(std::begin(dims), std::end(dims),
-                                static_cast<idx>(1), std::multiplies<idx>());
-        dyn_mat<typename Derived::Scalar> result = dyn_mat<
-                typename Derived::Scalar>
-        ::Identity(D, D);
-
-        idx Cdims[maxn];
-        idx midx_row[maxn];
-        idx midx_col[maxn];
+        // the gate written block by block over the identity
+        std::vector<dyn_mat<typename Derived::Scalar>> Ai =
+                internal::gate_powers<typename Derived::Scalar>(rA, 2);
 
-        for (idx k = 0; k < dims.size(); ++k)
-        {
-            midx_row[k] = midx_col[k] = 0;
-            Cdims[k] = dims[k];
-        }
-
-        // run over the main diagonal multi-indexes
-        for (idx i = 0; i < D; ++i)
-        {
-            // get row multi_index
-            internal::n2multiidx(i, dims.size(), Cdims, midx_row);
-            // get column multi_index (same as row)
-            internal::n2multiidx(i, dims.size(), Cdims, midx_col);
-            // run over the gate row multi-index
-            for (idx a = 0; a < static_cast<idx>(rA.rows());
-                 ++a)
-            {
-                // construct the total row multi-index
-                midx_row[pos] = a;
-
-                // run over the gate column multi-index
-                for (idx b = 0;
-                     b < static_cast<idx>(rA.cols()); ++b)
-                {
-                    // construct the total column multi-index
-                    midx_col[pos] = b;
-
-                    // finally write the values
-                    result(internal::multiidx2n(midx_row, dims.size(), Cdims),
-                           internal::multiidx2n(midx_col, dims.size(), Cdims))
-                            = rA(a, b);
-                }
-            }
-        }
-
-        return result;
+        return internal::ctrl_gate_to_dense(
+                Ai, internal::CtrlGateIndex({}, {pos}, dims));
     }
 
     /**
@@ -537,6 +455,83 @@ public:
 
         return this->expandout(A, pos, dims);
     }
+
+    /**
+    * \brief Expands out as a matrix-free operator
+    * \see qpp::Gates::expandout(), qpp::apply()
+    *
+    *  Expands out \a A as an operator on a multi-partite system, which
+    *  applies itself to kets and density matrices in \f$O(D\cdot D_A)\f$
+    *  operations, and is only converted to the matrix returned by
+    *  qpp::Gates::expandout() by qpp::CtrlGate::to_dense()
+    *
+    * \param A Eigen expression
+    * \param pos Position
+    * \param dims Dimensions of the multi-partite system
+    * \return Tensor product
+    * \f$ I\otimes\cdots\otimes I\otimes A \otimes I \otimes\cdots\otimes I\f$,
+    * with \a A on position \a pos, as a qpp::CtrlGate
+    */
+    template<typename Derived>
+    CtrlGate expandout_op(const Eigen::MatrixBase<Derived>& A, idx pos,
+                          const std::vector<idx>& dims) const
+    {
+        // EXCEPTION CHECKS
+
+        // check that position is valid
+        if (pos >= dims.size())
+            throw exception::OutOfRange("qpp::Gates::expandout_op()");
+        // END EXCEPTION CHECKS
+
+        return CtrlGate(A, {}, {pos}, dims);
+    }
+
+    /**
+    * \brief Expands out as a matrix-free operator
+    * \see qpp::Gates::expandout(), qpp::apply()
+    *
+    * \note The std::initializer_list overload exists for the same reason as
+    * for qpp::Gates::expandout()
+    *
+    * \param A Eigen expression
+    * \param pos Position
+    * \param dims Dimensions of the multi-partite system
+    * \return Tensor product
+    * \f$ I\otimes\cdots\otimes I\otimes A \otimes I \otimes\cdots\otimes I\f$,
+    * with \a A on position \a pos, as a qpp::CtrlGate
+    */
+    template<typename Derived>
+    CtrlGate expandout_op(const Eigen::MatrixBase<Derived>& A, idx pos,
+                          const std::initializer_list<idx>& dims) const
+    {
+        return this->expandout_op(A, pos, std::vector<idx>(dims));
+    }
+
+    /**
+    * \brief Expands out as a matrix-free operator
+    * \see qpp::Gates::expandout(), qpp::apply()
+    *
+    * \param A Eigen expression
+    * \param pos Position
+    * \param N Number of subsystems
+    * \param d Subsystem dimension
+    * \return Tensor product
+    * \f$ I\otimes\cdots\otimes I\otimes A \otimes I \otimes\cdots\otimes I\f$,
+    * with \a A on position \a pos, as a qpp::CtrlGate
+    */
+    template<typename Derived>
+    CtrlGate expandout_op(const Eigen::MatrixBase<Derived>& A, idx pos,
+                          idx N, idx d = 2) const
+    {
+        // EXCEPTION CHECKS
+
+        // check valid dims
+        if (d == 0)
+            throw exception::DimsInvalid("qpp::Gates::expandout_op()");
+        // END EXCEPTION CHECKS
+
+        return this->expandout_op(A, pos, std::vector<idx>(N, d));
+    }
 }; /* class Gates */
 
 } /* namespace qpp */
@@ -0,0 +1,277 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file classes/kron_operator.h
+* \brief Lazy Kronecker products of gates
+*/
+
+#ifndef CLASSES_KRON_OPERATOR_H_
+#define CLASSES_KRON_OPERATOR_H_
+
+namespace qpp
+{
+/**
+* \class qpp::KronOperator
+* \brief Lazy Kronecker product \f$A_0\otimes A_1\otimes\cdots\otimes
+* A_{n-1}\f$ of square matrices (gates)
+* \see qpp::kron(), qpp::kronpow()
+*
+* Keeps the factors instead of the \f$D\times D\f$ product, and applies
+* itself to a state as a sequence of local gates, the factor \f$A_k\f$ acting
+* on the subsystem \a k, with the kernels of qpp::apply(). For \a n qubits
+* this takes \f$O(n 2^n)\f$ operations on a ket instead of the \f$O(4^n)\f$
+* of a matrix-vector product with the product (and its \f$O(4^n)\f$
+* memory). Identity factors are skipped.
+*
+* Example:
+* \code
+* KronOperator Hn(gt.H, 20); // lazy kronpow(gt.H, 20)
+* ket psi = Hn.apply(mket(std::vector<idx>(20, 0))); // |+>^{\otimes 20}
+* \endcode
+*/
+class KronOperator
+{
+    std::vector<cmat> As_;            ///< factors
+    std::vector<idx> dims_;           ///< dimensions of the factors
+    std::vector<std::vector<cmat>> Ai_; ///< powers 0 and 1 of the factors
+    std::vector<idx> active_;         ///< non-identity factors
+
+    // sets the dimensions and the factors to be applied, no error checks
+    void init_()
+    {
+        for (idx k = 0; k < As_.size(); ++k)
+        {
+            dims_.push_back(static_cast<idx>(As_[k].rows()));
+            Ai_.push_back(internal::gate_powers<cplx>(As_[k], 2));
+            if (As_[k] != Ai_[k][0])
+                active_.push_back(k);
+        }
+    }
+
+    // applies the product to the ket or density matrix state, no error checks
+    template<typename Derived>
+    void apply_inplace_(Eigen::MatrixBase<Derived>& state) const
+    {
+        if (state.rows() == 1)
+            return;
+        for (auto&& k : active_)
+            internal::apply_ctrl_inplace(state, Ai_[k], {}, {k}, dims_);
+    }
+
+public:
+    /**
+    * \brief Constructs the Kronecker product of the factors \a As
+    *
+    * \param As Square matrices, e.g. \a {A0, A1, ..., An-1}
+    */
+    explicit KronOperator(const std::vector<cmat>& As) :
+            As_{As}, dims_{}, Ai_{}, active_{}
+    {
+        // EXCEPTION CHECKS
+
+        if (As.size() == 0)
+            throw exception::ZeroSize("qpp::KronOperator::KronOperator()");
+        for (auto&& A : As)
+        {
+            if (!internal::check_nonzero_size(A))
+                throw exception::ZeroSize(
+                        "qpp::KronOperator::KronOperator()");
+            if (!internal::check_square_mat(A))
+                throw exception::MatrixNotSquare(
+                        "qpp::KronOperator::KronOperator()");
+        }
+        if (As.size() > maxn)
+            throw exception::OutOfRange("qpp::KronOperator::KronOperator()");
+        // END EXCEPTION CHECKS
+
+        init_();
+    }
+
+    /**
+    * \brief Constructs the Kronecker power \f$A^{\otimes n}\f$
+    *
+    * \param A Eigen expression, square matrix
+    * \param n Positive integer
+    */
+    template<typename Derived>
+    KronOperator(const Eigen::MatrixBase<Derived>& A, idx n) :
+            As_{}, dims_{}, Ai_{}, active_{}
+    {
+        const cmat rA = A.template cast<cplx>();
+
+        // EXCEPTION CHECKS
+
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::KronOperator::KronOperator()");
+        if (!internal::check_square_mat(rA))
+            throw exception::MatrixNotSquare(
+                    "qpp::KronOperator::KronOperator()");
+        if (n == 0 || n > maxn)
+            throw exception::OutOfRange("qpp::KronOperator::KronOperator()");
+        // END EXCEPTION CHECKS
+
+        As_.assign(n, rA);
+        init_();
+    }
+
+    /**
+    * \brief Factors of the product
+    *
+    * \return Factors, in the order of the subsystems
+    */
+    const std::vector<cmat>& get_factors() const noexcept
+    {
+        return As_;
+    }
+
+    /**
+    * \brief Dimensions of the subsystems
+    *
+    * \return Dimensions of the factors
+    */
+    const std::vector<idx>& get_dims() const noexcept
+    {
+        return dims_;
+    }
+
+    /**
+    * \brief Total dimension
+    *
+    * \return Dimension of the product
+    */
+    idx get_D() const noexcept
+    {
+        return std::accumulate(std::begin(dims_), std::end(dims_),
+                               static_cast<idx>(1), std::multiplies<idx>());
+    }
+
+    /**
+    * \brief Dense matrix of the product
+    *
+    * \note Allocates a \f$D\times D\f$ matrix, computed in parallel from
+    * the products of the two halves of the factors, see qpp::kron()
+    *
+    * \return Kronecker product of the factors
+    */
+    cmat to_dense() const
+    {
+        return kron(As_);
+    }
+
+    /**
+    * \brief Applies in-place the product to the state vector or density
+    * matrix \a state, one factor at a time, i.e.
+    * \f$|\psi\rangle\to (A_0\otimes\cdots\otimes A_{n-1})|\psi\rangle\f$ or
+    * \f$\rho\to (A_0\otimes\cdots\otimes A_{n-1})\rho
+    * (A_0\otimes\cdots\otimes A_{n-1})^\dagger\f$
+    *
+    * \param state Eigen expression, overwritten by the output state
+    */
+    template<typename Derived>
+    void apply_inplace(Eigen::MatrixBase<Derived>& state) const
+    {
+        auto& rstate = state.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero sizes
+        if (!internal::check_nonzero_size(rstate))
+            throw exception::ZeroSize("qpp::KronOperator::apply_inplace()");
+
+        // check that state is a ket or a density matrix matching dims
+        if (internal::check_cvector(rstate))
+        {
+            if (!internal::check_dims_match_cvect(dims_, rstate))
+                throw exception::DimsMismatchCvector(
+                        "qpp::KronOperator::apply_inplace()");
+        } else if (internal::check_square_mat(rstate))
+        {
+            if (!internal::check_dims_match_mat(dims_, rstate))
+                throw exception::DimsMismatchMatrix(
+                        "qpp::KronOperator::apply_inplace()");
+        } else
+            throw exception::MatrixNotSquareNorCvector(
+                    "qpp::KronOperator::apply_inplace()");
+        // END EXCEPTION CHECKS
+
+        apply_inplace_(rstate);
+    }
+
+    /**
+    * \brief Applies the product to the state vector or density matrix
+    * \a state, one factor at a time
+    * \see qpp::KronOperator::apply_inplace()
+    *
+    * \param state Eigen expression
+    * \return Product applied to \a state
+    */
+    template<typename Derived>
+    cmat apply(const Eigen::MatrixBase<Derived>& state) const
+    {
+        cmat result = state.derived();
+        apply_inplace(result);
+
+        return result;
+    }
+
+    /**
+    * \brief Matrix product of the Kronecker product with \a A, column by
+    * column
+    *
+    * \note For a density matrix \f$\rho\f$ this is \f$K\rho\f$, use
+    * qpp::KronOperator::apply() for \f$K\rho K^\dagger\f$
+    *
+    * \param A Eigen expression, with as many rows as the total dimension
+    * \return Product \f$KA\f$
+    */
+    template<typename Derived>
+    cmat operator*(const Eigen::MatrixBase<Derived>& A) const
+    {
+        cmat result = A.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero sizes
+        if (!internal::check_nonzero_size(result))
+            throw exception::ZeroSize("qpp::KronOperator::operator*()");
+
+        // check that the number of rows matches dims
+        if (static_cast<idx>(result.rows()) != get_D())
+            throw exception::DimsMismatchMatrix(
+                    "qpp::KronOperator::operator*()");
+        // END EXCEPTION CHECKS
+
+        ket col;
+        for (idx c = 0; c < static_cast<idx>(result.cols()); ++c)
+        {
+            col = result.col(c);
+            apply_inplace_(col);
+            result.col(c) = col;
+        }
+
+        return result;
+    }
+}; /* class KronOperator */
+
+} /* namespace qpp */
+
+#endif /* CLASSES_KRON_OPERATOR_H_ */
@@ -0,0 +1,436 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file classes/measurement.h
+* \brief Measurements with lazily computed post-measurement states
+*/
+
+#ifndef CLASSES_MEASUREMENT_H_
+#define CLASSES_MEASUREMENT_H_
+
+namespace qpp
+{
+/**
+* \class qpp::Measurement
+* \brief Measurement of a part of a multi-partite state, with lazily
+* computed post-measurement states
+* \see qpp::measure()
+*
+* Measures the part \a subsys of a multi-partite state vector or density
+* matrix, using either a set of Kraus operators or an orthonormal basis
+* (rank-1 POVM), as qpp::measure() does. The outcome is sampled on
+* construction from the outcome probabilities, which are computed from the
+* reduced state of the measured subsystems only. The post-measurement states
+* are computed only when requested, hence the measurement costs a single
+* copy of the state, independently of the number of outcomes.
+*
+* \note The measurement is destructive, i.e. the measured subsystems are
+* traced away. To measure the whole system use \a subsys = {0} and
+* \a dims = {D}.
+*
+* \note A density matrix measured in a rank-1 POVM with non-normalized
+* vectors \f$v_i\f$ yields the probabilities
+* \f$\langle v_i|\rho|v_i\rangle\f$, as for kets, whereas qpp::measure()
+* yields \f$\|v_i\|^2\langle v_i|\rho|v_i\rangle\f$
+*/
+class Measurement
+{
+    std::vector<cmat> Ks_;     ///< Kraus operators (Kraus measurements)
+    cmat V_;                   ///< basis vectors (rank-1 measurements)
+    bool rank1_;               ///< measured with the columns of V_
+    bool is_ket_;              ///< the measured state is a ket
+    cmat state_;               ///< ket reshaped as Dsubsys x Dbar, or rho
+    std::vector<idx> os_;      ///< offsets of the measured subsystems
+    std::vector<idx> ob_;      ///< offsets of the remaining subsystems
+    std::vector<double> prob_; ///< outcome probabilities
+    idx result_;               ///< sampled outcome
+
+    // dimensions of a system of dimension D made of subsystems of dimension d
+    static std::vector<idx> get_dims_(idx D, idx d)
+    {
+        // EXCEPTION CHECKS
+
+        // check zero size
+        if (D == 0)
+            throw exception::ZeroSize("qpp::Measurement::Measurement()");
+
+        // check valid dims
+        if (d < 2)
+            throw exception::DimsInvalid("qpp::Measurement::Measurement()");
+        // END EXCEPTION CHECKS
+
+        return std::vector<idx>(internal::get_num_subsys(D, d), d);
+    }
+
+    // stores the state and its reduced state on subsys, in the order of
+    // subsys, then computes the probabilities and samples the outcome
+    template<typename Derived>
+    void measure_(const Eigen::MatrixBase<Derived>& A,
+                  const std::vector<idx>& subsys,
+                  const std::vector<idx>& dims)
+    {
+        const cmat& rA = A.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero-size
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::Measurement::Measurement()");
+
+        // check that dimension is valid
+        if (!internal::check_dims(dims))
+            throw exception::DimsInvalid("qpp::Measurement::Measurement()");
+
+        // check square matrix or column vector
+        if (internal::check_square_mat(rA))
+        {
+            // check that dims match rho matrix
+            if (!internal::check_dims_match_mat(dims, rA))
+                throw exception::DimsMismatchMatrix(
+                        "qpp::Measurement::Measurement()");
+        } else if (internal::check_cvector(rA))
+        {
+            // check that dims match psi column vector
+            if (!internal::check_dims_match_cvect(dims, rA))
+                throw exception::DimsMismatchCvector(
+                        "qpp::Measurement::Measurement()");
+        } else
+            throw exception::MatrixNotSquareNorCvector(
+                    "qpp::Measurement::Measurement()");
+
+        // check subsys is valid w.r.t. dims
+        if (!internal::check_subsys_match_dims(subsys, dims))
+            throw exception::SubsysMismatchDims(
+                    "qpp::Measurement::Measurement()");
+
+        // check the measurement operators
+        idx Dsubsys = 1;
+        for (auto&& i : subsys)
+            Dsubsys *= dims[i];
+        if (rank1_)
+        {
+            if (!internal::check_nonzero_size(V_))
+                throw exception::ZeroSize("qpp::Measurement::Measurement()");
+            if (Dsubsys != static_cast<idx>(V_.rows()))
+                throw exception::DimsMismatchMatrix(
+                        "qpp::Measurement::Measurement()");
+        } else
+        {
+            if (Ks_.size() == 0)
+                throw exception::ZeroSize("qpp::Measurement::Measurement()");
+            if (!internal::check_square_mat(Ks_[0]))
+                throw exception::MatrixNotSquare(
+                        "qpp::Measurement::Measurement()");
+            if (Dsubsys != static_cast<idx>(Ks_[0].rows()))
+                throw exception::DimsMismatchMatrix(
+                        "qpp::Measurement::Measurement()");
+            for (auto&& it : Ks_)
+                if (it.rows() != Ks_[0].rows() ||
+                    it.cols() != Ks_[0].rows())
+                    throw exception::DimsNotEqual(
+                            "qpp::Measurement::Measurement()");
+        }
+        // END EXCEPTION CHECKS
+
+        is_ket_ = internal::check_cvector(rA);
+        os_ = internal::get_subsys_offsets(subsys, dims);
+        ob_ = internal::get_subsys_offsets(complement(subsys, dims.size()),
+                                           dims);
+        idx Dbar = ob_.size();
+
+        // reduced state of the measured subsystems
+        cmat rho_subsys;
+        if (is_ket_)
+        {
+            state_.resize(Dsubsys, Dbar);
+            for (idx b = 0; b < Dbar; ++b)
+                for (idx j = 0; j < Dsubsys; ++j)
+                    state_(j, b) = rA(ob_[b] + os_[j]);
+            rho_subsys = state_ * adjoint(state_);
+        } else
+        {
+            state_ = rA;
+            rho_subsys = cmat::Zero(Dsubsys, Dsubsys);
+            for (idx j2 = 0; j2 < Dsubsys; ++j2)
+                for (idx j1 = 0; j1 < Dsubsys; ++j1)
+                    for (idx b = 0; b < Dbar; ++b)
+                        rho_subsys(j1, j2) +=
+                                rA(ob_[b] + os_[j1], ob_[b] + os_[j2]);
+        }
+
+        // probabilities
+        idx M = rank1_ ? static_cast<idx>(V_.cols()) : Ks_.size();
+        prob_.resize(M);
+        for (idx i = 0; i < M; ++i)
+        {
+            if (rank1_)
+                prob_[i] = std::abs((adjoint(V_.col(i)) * rho_subsys *
+                                     V_.col(i)).value());
+            else
+                prob_[i] = std::abs(trace(Ks_[i] * rho_subsys *
+                                          adjoint(Ks_[i])));
+        }
+
+        // sample from the probability distribution
+        std::discrete_distribution<idx> dd(std::begin(prob_),
+                                           std::end(prob_));
+        result_ = dd(RandomDevices::get_instance().get_prng());
+    }
+
+public:
+    /**
+    * \brief Measures the part \a subsys of the multi-partite state vector
+    * or density matrix \a A using the set of Kraus operators \a Ks
+    *
+    * \note The dimension of all \a Ks must match the dimension of \a subsys
+    *
+    * \param A Eigen expression
+    * \param Ks Set of Kraus operators
+    * \param subsys Subsystem indexes that are measured
+    * \param dims Dimensions of the multi-partite system
+    */
+    template<typename Derived>
+    Measurement(const Eigen::MatrixBase<Derived>& A,
+                const std::vector<cmat>& Ks,
+                const std::vector<idx>& subsys,
+                const std::vector<idx>& dims) :
+            Ks_{Ks}, V_{}, rank1_{false}, is_ket_{}, state_{}, os_{}, ob_{},
+            prob_{}, result_{}
+    {
+        measure_(A, subsys, dims);
+    }
+
+    // std::initializer_list overload, avoids ambiguity for 2-element lists
+    /**
+    * \brief Measures the part \a subsys of the multi-partite state vector
+    * or density matrix \a A using the set of Kraus operators \a Ks
+    *
+    * \note The dimension of all \a Ks must match the dimension of \a subsys
+    *
+    * \param A Eigen expression
+    * \param Ks Set of Kraus operators
+    * \param subsys Subsystem indexes that are measured
+    * \param dims Dimensions of the multi-partite system
+    */
+    template<typename Derived>
+    Measurement(const Eigen::MatrixBase<Derived>& A,
+                const std::initializer_list<cmat>& Ks,
+                const std::vector<idx>& subsys,
+                const std::vector<idx>& dims) :
+            Measurement(A, std::vector<cmat>(Ks), subsys, dims)
+    {
+    }
+
+    /**
+    * \brief Measures the part \a subsys of the multi-partite state vector
+    * or density matrix \a A using the set of Kraus operators \a Ks
+    *
+    * \note The dimension of all \a Ks must match the dimension of \a subsys
+    *
+    * \param A Eigen expression
+    * \param Ks Set of Kraus operators
+    * \param subsys Subsystem indexes that are measured
+    * \param d Subsystem dimensions
+    */
+    template<typename Derived>
+    Measurement(const Eigen::MatrixBase<Derived>& A,
+                const std::vector<cmat>& Ks,
+                const std::vector<idx>& subsys,
+                idx d = 2) :
+            Measurement(A, Ks, subsys,
+                        get_dims_(static_cast<idx>(A.rows()), d))
+    {
+    }
+
+    // std::initializer_list overload, avoids ambiguity for 2-element lists
+    /**
+    * \brief Measures the part \a subsys of the multi-partite state vector
+    * or density matrix \a A using the set of Kraus operators \a Ks
+    *
+    * \note The dimension of all \a Ks must match the dimension of \a subsys
+    *
+    * \param A Eigen expression
+    * \param Ks Set of Kraus operators
+    * \param subsys Subsystem indexes that are measured
+    * \param d Subsystem dimensions
+    */
+    template<typename Derived>
+    Measurement(const Eigen::MatrixBase<Derived>& A,
+                const std::initializer_list<cmat>& Ks,
+                const std::vector<idx>& subsys,
+                idx d = 2) :
+            Measurement(A, std::vector<cmat>(Ks), subsys, d)
+    {
+    }
+
+    /**
+    * \brief Measures the part \a subsys of the multi-partite state vector
+    * or density matrix \a A in the orthonormal basis or rank-1 POVM
+    * specified by the matrix \a V
+    *
+    * \note The dimension of \a V must match the dimension of \a subsys
+    *
+    * \param A Eigen expression
+    * \param V Matrix whose columns represent the measurement basis vectors
+    * or the bra parts of the rank-1 POVM; the probability of the outcome
+    * \a i is \f$|\langle v_i|\psi\rangle|^2\f$ for kets and
+    * \f$\langle v_i|\rho|v_i\rangle\f$ for density matrices
+    * \param subsys Subsystem indexes that are measured
+    * \param dims Dimensions of the multi-partite system
+    */
+    template<typename Derived>
+    Measurement(const Eigen::MatrixBase<Derived>& A,
+                const cmat& V,
+                const std::vector<idx>& subsys,
+                const std::vector<idx>& dims) :
+            Ks_{}, V_{V}, rank1_{true}, is_ket_{}, state_{}, os_{}, ob_{},
+            prob_{}, result_{}
+    {
+        measure_(A, subsys, dims);
+    }
+
+    /**
+    * \brief Measures the part \a subsys of the multi-partite state vector
+    * or density matrix \a A in the orthonormal basis or rank-1 POVM
+    * specified by the matrix \a V
+    *
+    * \note The dimension of \a V must match the dimension of \a subsys
+    *
+    * \param A Eigen expression
+    * \param V Matrix whose columns represent the measurement basis vectors
+    * or the bra parts of the rank-1 POVM; the probability of the outcome
+    * \a i is \f$|\langle v_i|\psi\rangle|^2\f$ for kets and
+    * \f$\langle v_i|\rho|v_i\rangle\f$ for density matrices
+    * \param subsys Subsystem indexes that are measured
+    * \param d Subsystem dimensions
+    */
+    template<typename Derived>
+    Measurement(const Eigen::MatrixBase<Derived>& A,
+                const cmat& V,
+                const std::vector<idx>& subsys,
+                idx d = 2) :
+            Measurement(A, V, subsys,
+                        get_dims_(static_cast<idx>(A.rows()), d))
+    {
+    }
+
+    /**
+    * \brief Result of the measurement
+    *
+    * \return Index of the sampled outcome
+    */
+    idx get_result() const noexcept
+    {
+        return result_;
+    }
+
+    /**
+    * \brief Outcome probabilities
+    *
+    * \return Vector of outcome probabilities
+    */
+    const std::vector<double>& get_probs() const noexcept
+    {
+        return prob_;
+    }
+
+    /**
+    * \brief Post-measurement state corresponding to the outcome \a i,
+    * computed on demand
+    *
+    * \note A ket measured in a basis (rank-1 POVM) yields a ket, otherwise
+    * the post-measurement state is a density matrix. Outcomes with zero
+    * probability yield a zero state.
+    *
+    * \param i Outcome index
+    * \return Normalized post-measurement state of the remaining subsystems
+    */
+    cmat get_state(idx i) const
+    {
+        // EXCEPTION CHECKS
+
+        if (i >= prob_.size())
+            throw exception::OutOfRange("qpp::Measurement::get_state()");
+        // END EXCEPTION CHECKS
+
+        const idx Dsubsys = os_.size();
+        const idx Dbar = ob_.size();
+        const double p = prob_[i];
+
+        // ket measured in a basis, stays pure
+        if (rank1_ && is_ket_)
+        {
+            if (p <= eps)
+                return cmat::Zero(Dbar, 1);
+            return (adjoint(V_.col(i)) * state_).transpose() / std::sqrt(p);
+        }
+
+        if (p <= eps)
+            return cmat::Zero(Dbar, Dbar);
+
+        // ket measured with Kraus operators, the measured subsystems are
+        // traced away after applying the Kraus operator
+        if (is_ket_)
+        {
+            cmat N = Ks_[i] * state_;
+            return N.transpose() * N.conjugate() / p;
+        }
+
+        // density matrix, result(b1, b2) = Tr(E A_{b1 b2}), where E is the
+        // POVM element of the outcome and A_{b1 b2} is the block of rows b1
+        // and columns b2 w.r.t. the remaining subsystems
+        cmat E = rank1_ ? cmat(V_.col(i) * adjoint(V_.col(i)))
+                        : cmat(adjoint(Ks_[i]) * Ks_[i]);
+        cmat result(Dbar, Dbar);
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+        for (idx b2 = 0; b2 < Dbar; ++b2)
+            for (idx b1 = 0; b1 < Dbar; ++b1)
+            {
+                cplx sum = 0;
+                for (idx j2 = 0; j2 < Dsubsys; ++j2)
+                    for (idx j1 = 0; j1 < Dsubsys; ++j1)
+                        sum += E(j2, j1) *
+                               state_(ob_[b1] + os_[j1], ob_[b2] + os_[j2]);
+                result(b1, b2) = sum / p;
+            }
+
+        return result;
+    }
+
+    /**
+    * \brief Post-measurement state corresponding to the sampled outcome,
+    * computed on demand
+    * \see qpp::Measurement::get_state(idx)
+    *
+    * \return Normalized post-measurement state of the remaining subsystems
+    */
+    cmat get_state() const
+    {
+        return get_state(result_);
+    }
+}; /* class Measurement */
+
+} /* namespace qpp */
+
+#endif /* CLASSES_MEASUREMENT_H_ */
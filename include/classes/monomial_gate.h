@@ -0,0 +1,340 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file classes/monomial_gate.h
+* \brief Monomial (permutation times phases) gates
+*/
+
+#ifndef CLASSES_MONOMIAL_GATE_H_
+#define CLASSES_MONOMIAL_GATE_H_
+
+namespace qpp
+{
+/**
+* \class qpp::MonomialGate
+* \brief Monomial gate, i.e. a permutation of the basis states times phases,
+* \f$U|m\rangle = e^{i\phi_m}|\pi(m)\rangle\f$
+* \see qpp::apply()
+*
+* Covers the classical reversible gates (X, CNOT, SWAP, Toffoli, Fredkin,
+* qudit X) and any classical reversible function on a register, e.g. a
+* modular multiplier. The gate is stored as its permutation and phases only;
+* its application moves the amplitudes in-place along the cycles of the
+* permutation, without any arithmetic other than the phases and without
+* ever constructing the matrix of the gate.
+*
+* Example:
+* \code
+* // |x> -> |7x mod 15> on a 4 qubit register, identity on 15
+* MonomialGate U([](idx x) { return x < 15 ? (7 * x) % 15 : x; }, 16);
+* ket psi = U.apply(mket({0, 0, 1, 0, 1, 0}), {2, 3, 4, 5});
+* \endcode
+*/
+class MonomialGate
+{
+    // the phases and the cycles are stored as the powers 0 (unused, no
+    // controls) and 1 of the gate, as taken by the kernels
+    std::vector<idx> perm_;                             ///< permutation
+    std::vector<std::vector<cplx>> phases_;             ///< phases
+    std::vector<std::vector<std::vector<idx>>> cycles_; ///< non-trivial cycles
+
+    // sets the phases and computes the cycles, once perm_ is set
+    void init_(std::vector<cplx> phases)
+    {
+        phases_ = {{}, std::move(phases)};
+        cycles_ = {{}, internal::monomial_cycles(perm_, phases_[1])};
+    }
+
+    // applies the gate to the state, no error checks
+    template<typename Derived>
+    void apply_inplace_(Eigen::MatrixBase<Derived>& state,
+                        const std::vector<idx>& subsys,
+                        const std::vector<idx>& dims) const
+    {
+        internal::apply_monomial_inplace(state, cycles_, phases_, {}, subsys,
+                                         dims);
+    }
+
+public:
+    /**
+    * \brief Constructs the gate from its permutation and phases
+    *
+    * \param perm Permutation, the gate maps the basis state \a m to the
+    * basis state \a perm[m]
+    * \param phases Phases (or any non-zero factors), the basis state \a m
+    * being multiplied by \a phases[m]; all equal to 1 if empty
+    */
+    explicit MonomialGate(const std::vector<idx>& perm,
+                          const std::vector<cplx>& phases = {}) :
+            perm_{perm}, phases_{}, cycles_{}
+    {
+        // EXCEPTION CHECKS
+
+        if (!internal::check_nonzero_size(perm))
+            throw exception::ZeroSize("qpp::MonomialGate::MonomialGate()");
+        if (!internal::check_perm(perm))
+            throw exception::PermInvalid(
+                    "qpp::MonomialGate::MonomialGate()");
+        if (!phases.empty() && phases.size() != perm.size())
+            throw exception::SizeMismatch(
+                    "qpp::MonomialGate::MonomialGate()");
+        // END EXCEPTION CHECKS
+
+        init_(phases.empty() ? std::vector<cplx>(perm_.size(), 1) : phases);
+    }
+
+    /**
+    * \brief Constructs the gate from its matrix
+    *
+    * \param A Eigen expression, monomial matrix, e.g. qpp::Gates::CNOT
+    */
+    template<typename Derived>
+    explicit MonomialGate(const Eigen::MatrixBase<Derived>& A) :
+            perm_{}, phases_{}, cycles_{}
+    {
+        const cmat rA = A.template cast<cplx>();
+
+        // EXCEPTION CHECKS
+
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::MonomialGate::MonomialGate()");
+        if (!internal::check_square_mat(rA))
+            throw exception::MatrixNotSquare(
+                    "qpp::MonomialGate::MonomialGate()");
+        if (!internal::check_monomial(rA))
+            throw exception::CustomException(
+                    "qpp::MonomialGate::MonomialGate()",
+                    "Not a monomial matrix!");
+        // END EXCEPTION CHECKS
+
+        std::vector<cplx> phases;
+        internal::monomial_decompose(rA, perm_, phases);
+        init_(std::move(phases));
+    }
+
+    /**
+    * \brief Constructs the gate \f$|x\rangle\to|f(x)\rangle\f$ of the
+    * classical reversible function \a f on a register of dimension \a D
+    *
+    * \note The function \a f is evaluated once for each basis state of the
+    * register, and must be a bijection of {0, ..., D - 1}
+    *
+    * \param f Classical reversible function
+    * \param D Dimension of the register
+    */
+    MonomialGate(const std::function<idx(idx)>& f, idx D) :
+            perm_(D), phases_{}, cycles_{}
+    {
+        for (idx x = 0; x < D; ++x)
+            perm_[x] = f(x);
+
+        // EXCEPTION CHECKS
+
+        if (D == 0)
+            throw exception::ZeroSize("qpp::MonomialGate::MonomialGate()");
+        if (!internal::check_perm(perm_))
+            throw exception::CustomException(
+                    "qpp::MonomialGate::MonomialGate()",
+                    "The function is not a bijection!");
+        // END EXCEPTION CHECKS
+
+        init_(std::vector<cplx>(D, 1));
+    }
+
+    /**
+    * \brief Dimension of the system the gate acts on
+    *
+    * \return Dimension of the gate
+    */
+    idx get_D() const noexcept
+    {
+        return perm_.size();
+    }
+
+    /**
+    * \brief Permutation of the basis states
+    *
+    * \return Permutation, the basis state \a m is mapped to \a perm[m]
+    */
+    const std::vector<idx>& get_perm() const noexcept
+    {
+        return perm_;
+    }
+
+    /**
+    * \brief Phases
+    *
+    * \return Phases, the basis state \a m is multiplied by \a phases[m]
+    */
+    const std::vector<cplx>& get_phases() const noexcept
+    {
+        return phases_[1];
+    }
+
+    /**
+    * \brief Dense matrix of the gate
+    *
+    * \return Matrix of the gate
+    */
+    cmat to_dense() const
+    {
+        const idx D = perm_.size();
+        cmat result = cmat::Zero(D, D);
+        for (idx m = 0; m < D; ++m)
+            result(perm_[m], m) = phases_[1][m];
+
+        return result;
+    }
+
+    /**
+    * \brief Applies in-place the gate to the part \a subsys of the
+    * multi-partite state vector or density matrix \a state
+    *
+    * \param state Eigen expression, overwritten by the output state
+    * \param subsys Subsystem indexes where the gate is applied
+    * \param dims Dimensions of the multi-partite system
+    */
+    template<typename Derived>
+    void apply_inplace(Eigen::MatrixBase<Derived>& state,
+                       const std::vector<idx>& subsys,
+                       const std::vector<idx>& dims) const
+    {
+        auto& rstate = state.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero sizes
+        if (!internal::check_nonzero_size(rstate))
+            throw exception::ZeroSize("qpp::MonomialGate::apply_inplace()");
+
+        // check that dimension is valid
+        if (!internal::check_dims(dims))
+            throw exception::DimsInvalid(
+                    "qpp::MonomialGate::apply_inplace()");
+
+        // check subsys is valid w.r.t. dims
+        if (!internal::check_subsys_match_dims(subsys, dims))
+            throw exception::SubsysMismatchDims(
+                    "qpp::MonomialGate::apply_inplace()");
+
+        // check that the gate matches the dimensions of the subsys
+        idx DA = 1;
+        for (auto&& k : subsys)
+            DA *= dims[k];
+        if (DA != perm_.size())
+            throw exception::MatrixMismatchSubsys(
+                    "qpp::MonomialGate::apply_inplace()");
+
+        // check that state is a ket or a density matrix matching dims
+        if (internal::check_cvector(rstate))
+        {
+            if (!internal::check_dims_match_cvect(dims, rstate))
+                throw exception::DimsMismatchCvector(
+                        "qpp::MonomialGate::apply_inplace()");
+        } else if (internal::check_square_mat(rstate))
+        {
+            if (!internal::check_dims_match_mat(dims, rstate))
+                throw exception::DimsMismatchMatrix(
+                        "qpp::MonomialGate::apply_inplace()");
+        } else
+            throw exception::MatrixNotSquareNorCvector(
+                    "qpp::MonomialGate::apply_inplace()");
+        // END EXCEPTION CHECKS
+
+        apply_inplace_(rstate, subsys, dims);
+    }
+
+    /**
+    * \brief Applies in-place the gate to the part \a subsys of the
+    * multi-partite state vector or density matrix \a state
+    *
+    * \param state Eigen expression, overwritten by the output state
+    * \param subsys Subsystem indexes where the gate is applied
+    * \param d Subsystem dimensions
+    */
+    template<typename Derived>
+    void apply_inplace(Eigen::MatrixBase<Derived>& state,
+                       const std::vector<idx>& subsys, idx d = 2) const
+    {
+        auto& rstate = state.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero size
+        if (!internal::check_nonzero_size(rstate))
+            throw exception::ZeroSize("qpp::MonomialGate::apply_inplace()");
+
+        // check valid dims
+        if (d < 2)
+            throw exception::DimsInvalid(
+                    "qpp::MonomialGate::apply_inplace()");
+        // END EXCEPTION CHECKS
+
+        idx N = internal::get_num_subsys(static_cast<idx>(rstate.rows()), d);
+        std::vector<idx> dims(N, d); // local dimensions vector
+
+        apply_inplace(rstate, subsys, dims);
+    }
+
+    /**
+    * \brief Applies the gate to the part \a subsys of the multi-partite
+    * state vector or density matrix \a state
+    *
+    * \param state Eigen expression
+    * \param subsys Subsystem indexes where the gate is applied
+    * \param dims Dimensions of the multi-partite system
+    * \return Gate applied to the part \a subsys of \a state
+    */
+    template<typename Derived>
+    cmat apply(const Eigen::MatrixBase<Derived>& state,
+               const std::vector<idx>& subsys,
+               const std::vector<idx>& dims) const
+    {
+        cmat result = state.derived();
+        apply_inplace(result, subsys, dims);
+
+        return result;
+    }
+
+    /**
+    * \brief Applies the gate to the part \a subsys of the multi-partite
+    * state vector or density matrix \a state
+    *
+    * \param state Eigen expression
+    * \param subsys Subsystem indexes where the gate is applied
+    * \param d Subsystem dimensions
+    * \return Gate applied to the part \a subsys of \a state
+    */
+    template<typename Derived>
+    cmat apply(const Eigen::MatrixBase<Derived>& state,
+               const std::vector<idx>& subsys, idx d = 2) const
+    {
+        cmat result = state.derived();
+        apply_inplace(result, subsys, d);
+
+        return result;
+    }
+}; /* class MonomialGate */
+
+} /* namespace qpp */
+
+#endif /* CLASSES_MONOMIAL_GATE_H_ */
@@ -0,0 +1,334 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file classes/pauli_sum.h
+* \brief Multi-qubit Hamiltonians as sums of Pauli strings
+*/
+
+#ifndef CLASSES_PAULI_SUM_H_
+#define CLASSES_PAULI_SUM_H_
+
+namespace qpp
+{
+/**
+* \class qpp::PauliSum
+* \brief Multi-qubit Hamiltonian (or any Hermitian operator) given as a real
+* linear combination of Pauli strings
+* \see qpp::expval()
+*
+* The Hamiltonian \f$H = \sum_t c_t P_t\f$ is stored as its list of terms,
+* each Pauli string \f$P_t\f$ (e.g. "XIZ" for \f$X\otimes I\otimes Z\f$)
+* being kept as a pair of bit masks. Its action on a state vector and its
+* expectation values are computed directly from the amplitudes, without ever
+* constructing the \f$2^n\times 2^n\f$ matrix of \a H; the terms that flip
+* the same qubits share a single pass over the state. The matrix can still
+* be obtained, as a sparse or as a dense matrix, e.g. for the functions that
+* take a Hamiltonian as a qpp::cmat.
+*
+* Example:
+* \code
+* PauliSum H(3);
+* H.add(0.5, "ZZI").add(0.5, "IZZ").add(-1, {gt.X}, {1});
+* ket psi = H.apply(st.zero(3)); // H|000>
+* double E = H.expval(st.zero(3)); // <000|H|000>
+* \endcode
+*/
+class PauliSum
+{
+    idx n_;                           ///< number of qubits
+    std::vector<std::string> Ps_;     ///< Pauli strings
+    std::vector<double> coeffs_;      ///< coefficients
+    std::map<std::string, idx> pos_;  ///< position of each string
+
+    // the terms grouped by flip masks, as Pauli strings and coefficients
+    void get_groups_(std::vector<std::vector<internal::PauliString>>& groups,
+                     std::vector<std::vector<idx>>& terms) const
+    {
+        std::map<idx, idx> group_of; // flip mask -> group
+        for (idx t = 0; t < Ps_.size(); ++t)
+        {
+            internal::PauliString P(Ps_[t]);
+            auto it = group_of.find(P.x);
+            if (it == std::end(group_of))
+            {
+                it = group_of.emplace(P.x, groups.size()).first;
+                groups.emplace_back();
+                terms.emplace_back();
+            }
+            groups[it->second].push_back(P);
+            terms[it->second].push_back(t);
+        }
+    }
+
+public:
+    /**
+    * \brief Constructs the zero operator on \a n qubits
+    *
+    * \param n Number of qubits
+    */
+    explicit PauliSum(idx n) : n_{n}, Ps_{}, coeffs_{}, pos_{}
+    {
+        // EXCEPTION CHECKS
+
+        if (n == 0 || n >= 64)
+            throw exception::DimsInvalid("qpp::PauliSum::PauliSum()");
+        // END EXCEPTION CHECKS
+    }
+
+    /**
+    * \brief Adds the term \a coeff \a P
+    *
+    * \note Terms with the same Pauli string are merged
+    *
+    * \param coeff Real coefficient
+    * \param P Pauli string, one character I, X, Y or Z per qubit
+    * \return Reference to the current instance
+    */
+    PauliSum& add(double coeff, const std::string& P)
+    {
+        // EXCEPTION CHECKS
+
+        if (P.size() != n_)
+            throw exception::SizeMismatch("qpp::PauliSum::add()");
+        for (auto&& c : P)
+            if (!internal::PauliString::is_pauli(c))
+                throw exception::CustomException("qpp::PauliSum::add()",
+                                                 "Invalid Pauli string!");
+        // END EXCEPTION CHECKS
+
+        auto it = pos_.find(P);
+        if (it != std::end(pos_))
+            coeffs_[it->second] += coeff;
+        else
+        {
+            pos_[P] = Ps_.size();
+            Ps_.push_back(P);
+            coeffs_.push_back(coeff);
+        }
+
+        return *this;
+    }
+
+    /**
+    * \brief Adds the term \a coeff times the tensor product of the Pauli
+    * matrices \a paulis acting on the qubits \a subsys, and the identity on
+    * the other qubits
+    *
+    * \param coeff Real coefficient
+    * \param paulis Pauli matrices, each one of qpp::Gates::Id2,
+    * qpp::Gates::X, qpp::Gates::Y or qpp::Gates::Z
+    * \param subsys Qubit indexes where the Pauli matrices act
+    * \return Reference to the current instance
+    */
+    PauliSum& add(double coeff, const std::vector<cmat>& paulis,
+                  const std::vector<idx>& subsys)
+    {
+        // EXCEPTION CHECKS
+
+        if (paulis.size() != subsys.size())
+            throw exception::SizeMismatch("qpp::PauliSum::add()");
+        if (!internal::check_subsys_match_dims(subsys,
+                                               std::vector<idx>(n_, 2)))
+            throw exception::SubsysMismatchDims("qpp::PauliSum::add()");
+        // END EXCEPTION CHECKS
+
+        const Gates& gates = Gates::get_instance();
+        const std::vector<std::pair<char, const cmat*>> known{
+                {'I', &gates.Id2}, {'X', &gates.X}, {'Y', &gates.Y},
+                {'Z', &gates.Z}};
+        std::string P(n_, 'I');
+        for (idx i = 0; i < paulis.size(); ++i)
+        {
+            char c = 0;
+            if (paulis[i].rows() == 2 && paulis[i].cols() == 2)
+                for (auto&& elem : known)
+                    if (norm(paulis[i] - *elem.second) < eps)
+                        c = elem.first;
+            // EXCEPTION CHECKS
+
+            if (c == 0)
+                throw exception::CustomException("qpp::PauliSum::add()",
+                                                 "Not a Pauli matrix!");
+            // END EXCEPTION CHECKS
+            P[subsys[i]] = c;
+        }
+
+        return add(coeff, P);
+    }
+
+    /**
+    * \brief Number of qubits
+    *
+    * \return Number of qubits
+    */
+    idx get_n() const noexcept
+    {
+        return n_;
+    }
+
+    /**
+    * \brief Pauli strings of the terms
+    *
+    * \return Pauli strings, in the order in which they were added
+    */
+    const std::vector<std::string>& get_strings() const noexcept
+    {
+        return Ps_;
+    }
+
+    /**
+    * \brief Coefficients of the terms
+    *
+    * \return Coefficients, in the order of qpp::PauliSum::get_strings()
+    */
+    const std::vector<double>& get_coeffs() const noexcept
+    {
+        return coeffs_;
+    }
+
+    /**
+    * \brief Applies the operator to the state vector \a psi
+    *
+    * \param psi Column vector Eigen expression
+    * \return \f$H|\psi\rangle\f$, not normalized
+    */
+    template<typename Derived>
+    ket apply(const Eigen::MatrixBase<Derived>& psi) const
+    {
+        const dyn_mat<typename Derived::Scalar>& rpsi = psi.derived();
+
+        // EXCEPTION CHECKS
+
+        if (!internal::check_cvector(rpsi))
+            throw exception::MatrixNotCvector("qpp::PauliSum::apply()");
+        if (!internal::check_dims_match_cvect(std::vector<idx>(n_, 2), rpsi))
+            throw exception::DimsMismatchCvector("qpp::PauliSum::apply()");
+        // END EXCEPTION CHECKS
+
+        ket result = ket::Zero(rpsi.rows());
+        std::vector<std::vector<internal::PauliString>> groups;
+        std::vector<std::vector<idx>> terms;
+        get_groups_(groups, terms);
+        for (idx g = 0; g < groups.size(); ++g)
+        {
+            std::vector<cplx> w;
+            for (auto&& t : terms[g])
+                w.push_back(coeffs_[t]);
+            internal::add_pauli_terms(rpsi, groups[g], w, result);
+        }
+
+        return result;
+    }
+
+    /**
+    * \brief Expectation value of the operator in the state vector or
+    * density matrix \a A
+    *
+    * \param A Eigen expression
+    * \return \f$\langle\psi|H|\psi\rangle\f$ for a state vector or
+    * \f$\mathrm{Tr}(H A)\f$ for a density matrix
+    */
+    template<typename Derived>
+    double expval(const Eigen::MatrixBase<Derived>& A) const
+    {
+        const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA
+                = A.derived();
+
+        // EXCEPTION CHECKS
+
+        std::vector<idx> dims(n_, 2);
+        if (internal::check_square_mat(rA))
+        {
+            if (!internal::check_dims_match_mat(dims, rA))
+                throw exception::DimsMismatchMatrix(
+                        "qpp::PauliSum::expval()");
+        } else if (internal::check_cvector(rA))
+        {
+            if (!internal::check_dims_match_cvect(dims, rA))
+                throw exception::DimsMismatchCvector(
+                        "qpp::PauliSum::expval()");
+        } else
+            throw exception::MatrixNotSquareNorCvector(
+                    "qpp::PauliSum::expval()");
+        // END EXCEPTION CHECKS
+
+        double result = 0;
+        std::vector<std::vector<internal::PauliString>> groups;
+        std::vector<std::vector<idx>> terms;
+        get_groups_(groups, terms);
+        for (idx g = 0; g < groups.size(); ++g)
+        {
+            std::vector<cplx> ev = internal::pauli_expvals(rA, groups[g]);
+            for (idx i = 0; i < terms[g].size(); ++i)
+                result += coeffs_[terms[g][i]] * std::real(ev[i]);
+        }
+
+        return result;
+    }
+
+    /**
+    * \brief Sparse matrix of the operator
+    *
+    * \return Sparse \f$2^n\times 2^n\f$ matrix, with at most one non-zero
+    * element per column for each distinct set of flipped qubits
+    */
+    sp_cmat to_sparse() const
+    {
+        const idx D = static_cast<idx>(1) << n_;
+        std::vector<std::vector<internal::PauliString>> groups;
+        std::vector<std::vector<idx>> terms;
+        get_groups_(groups, terms);
+
+        std::vector<Eigen::Triplet<cplx>> triplets;
+        triplets.reserve(D * groups.size());
+        for (idx g = 0; g < groups.size(); ++g)
+            for (idx m = 0; m < D; ++m)
+            {
+                // element <m ^ x|H|m>
+                cplx f = 0;
+                for (idx i = 0; i < terms[g].size(); ++i)
+                    f += coeffs_[terms[g][i]] * groups[g][i].sign(m) *
+                         groups[g][i].phase();
+                if (f != 0.)
+                    triplets.emplace_back(m ^ groups[g][0].x, m, f);
+            }
+
+        sp_cmat result(D, D);
+        result.setFromTriplets(std::begin(triplets), std::end(triplets));
+
+        return result;
+    }
+
+    /**
+    * \brief Dense matrix of the operator
+    *
+    * \return Dense \f$2^n\times 2^n\f$ matrix
+    */
+    cmat to_dense() const
+    {
+        return cmat(to_sparse());
+    }
+}; /* class PauliSum */
+
+} /* namespace qpp */
+
+#endif /* CLASSES_PAULI_SUM_H_ */
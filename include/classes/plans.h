@@ -0,0 +1,624 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file classes/plans.h
+* \brief Precomputed plans for repeated subsystem operations
+*/
+
+#ifndef CLASSES_PLANS_H_
+#define CLASSES_PLANS_H_
+
+namespace qpp
+{
+/**
+* \class qpp::PtracePlan
+* \brief Partial trace plan
+* \see qpp::ptrace()
+*
+* Precomputes the index tables of the partial trace over a fixed list of
+* subsystems of a fixed multi-partite system, so that the partial trace of
+* many states can be computed without any index decoding. Executing the plan
+* into a result of the correct size, with a workspace of the correct size for
+* the gathered ket below, does not allocate memory.
+*
+* The partial trace of a ket is computed as \f$M M^\dagger\f$ with a single
+* rank-k update, where \f$M\f$ is the ket reshaped as a matrix with rows
+* indexed by the kept subsystems and columns indexed by the traced out ones.
+* The reshape is free when the traced out subsystems are the leading or the
+* trailing ones, otherwise the ket is gathered into a caller-owned workspace
+* (or into a temporary matrix, when no workspace is provided). Since the plan
+* itself is never modified, it can be executed concurrently, each thread
+* using its own workspace.
+*
+* The partial trace of a density matrix is computed as a sum of (strided)
+* diagonal blocks.
+*/
+class PtracePlan
+{
+    std::vector<idx> subsys_; ///< traced out subsystems
+    std::vector<idx> dims_;   ///< dimensions of the multi-partite system
+    idx D_;                   ///< total dimension
+    std::vector<idx> ob_;     ///< offsets of the kept subsystems
+    std::vector<idx> os_;     ///< offsets of the traced out subsystems
+    bool leading_;            ///< traced out subsystems are the leading ones
+    bool trailing_;           ///< traced out subsystems are the trailing ones
+
+    // result = M * adjoint(M), via a rank-k update of the lower triangle
+    template<typename Derived>
+    static void herk_(const Eigen::MatrixBase<Derived>& M,
+                      dyn_mat<typename Derived::Scalar>& result)
+    {
+        idx Dbar = static_cast<idx>(M.rows());
+        result.setZero();
+        result.template selfadjointView<Eigen::Lower>().rankUpdate(M);
+        for (idx j = 1; j < Dbar; ++j)
+            for (idx i = 0; i < j; ++i)
+                result(i, j) = std::conj(result(j, i));
+    }
+
+public:
+    /**
+    * \brief Constructs the partial trace plan
+    *
+    * \param subsys Subsystem indexes that are traced out
+    * \param dims Dimensions of the multi-partite system
+    */
+    PtracePlan(const std::vector<idx>& subsys, const std::vector<idx>& dims) :
+            subsys_{subsys}, dims_{dims}, D_{}, ob_{}, os_{},
+            leading_{}, trailing_{}
+    {
+        // EXCEPTION CHECKS
+
+        // check that dims is a valid dimension vector
+        if (!internal::check_dims(dims))
+            throw exception::DimsInvalid("qpp::PtracePlan::PtracePlan()");
+
+        // check that subsys are valid
+        if (!internal::check_subsys_match_dims(subsys, dims))
+            throw exception::SubsysMismatchDims(
+                    "qpp::PtracePlan::PtracePlan()");
+        // END EXCEPTION CHECKS
+
+        D_ = prod(dims);
+        ob_ = internal::get_subsys_offsets(complement(subsys, dims.size()),
+                                           dims);
+        os_ = internal::get_subsys_offsets(subsys, dims);
+        // both offset lists start at 0 and contain no repetitions, so they
+        // are contiguous ranges iff their maxima are as small as possible
+        leading_ = ob_.back() == ob_.size() - 1;
+        trailing_ = *std::max_element(std::begin(os_), std::end(os_)) ==
+                    os_.size() - 1;
+    }
+
+    /**
+    * \brief Constructs the partial trace plan
+    *
+    * \param subsys Subsystem indexes that are traced out
+    * \param N Number of subsystems
+    * \param d Subsystem dimensions
+    */
+    PtracePlan(const std::vector<idx>& subsys, idx N, idx d = 2) :
+            PtracePlan(subsys, std::vector<idx>(N, d))
+    {
+    }
+
+    /**
+    * \brief Traced out subsystems
+    *
+    * \return Subsystem indexes that are traced out
+    */
+    const std::vector<idx>& get_subsys() const noexcept
+    {
+        return subsys_;
+    }
+
+    /**
+    * \brief Dimensions of the multi-partite system
+    *
+    * \return Dimensions of the multi-partite system
+    */
+    const std::vector<idx>& get_dims() const noexcept
+    {
+        return dims_;
+    }
+
+    /**
+    * \brief Executes the plan
+    *
+    * \param A Eigen expression, state vector or density matrix
+    * \param result Partial trace of \a A, resized only if its size does not
+    * match the size of the reduced system
+    * \param workspace Matrix into which a ket is gathered when the traced out
+    * subsystems are neither the leading nor the trailing ones, resized only if
+    * its size does not match the product of the dimensions of the kept
+    * subsystems times the product of the dimensions of the traced out ones
+    */
+    template<typename Derived>
+    void execute(const Eigen::MatrixBase<Derived>& A,
+                 dyn_mat<typename Derived::Scalar>& result,
+                 dyn_mat<typename Derived::Scalar>& workspace) const
+    {
+        const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA
+                = A.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero-size
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::PtracePlan::execute()");
+        // END EXCEPTION CHECKS
+
+        idx Dbar = ob_.size();
+        idx Ds = os_.size();
+
+        //************ ket ************//
+        if (internal::check_cvector(rA)) // we have a ket
+        {
+            // check that dims match the dimension of A
+            if (static_cast<idx>(rA.rows()) != D_)
+                throw exception::DimsMismatchCvector(
+                        "qpp::PtracePlan::execute()");
+
+            result.resize(Dbar, Dbar);
+            using Scalar = typename Derived::Scalar;
+            // no copy if rA is already stored contiguously
+            Eigen::Ref<const dyn_col_vect<Scalar>> psi(rA);
+
+            // M(i, a) = psi(ob[i] + os[a])
+            if (leading_)
+                herk_(Eigen::Map<const dyn_mat<Scalar>>(psi.data(), Dbar, Ds),
+                      result);
+            else if (trailing_)
+                herk_(Eigen::Map<const dyn_mat<Scalar>>(psi.data(), Ds, Dbar)
+                              .transpose(), result);
+            else
+            {
+                workspace.resize(Dbar, Ds);
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+                for (idx a = 0; a < Ds; ++a)
+                    for (idx i = 0; i < Dbar; ++i)
+                        workspace(i, a) = psi(ob_[i] + os_[a]);
+                herk_(workspace, result);
+            }
+        }
+            //************ density matrix ************//
+        else if (internal::check_square_mat(rA)) // we have a density operator
+        {
+            // check that dims match the dimension of A
+            if (static_cast<idx>(rA.rows()) != D_)
+                throw exception::DimsMismatchMatrix(
+                        "qpp::PtracePlan::execute()");
+
+            result.resize(Dbar, Dbar);
+            // sum of the diagonal blocks
+            if (leading_)
+            {
+                result = rA.block(0, 0, Dbar, Dbar);
+                for (idx a = 1; a < Ds; ++a)
+                    result += rA.block(os_[a], os_[a], Dbar, Dbar);
+                return;
+            }
+
+            // sum of the strided diagonal blocks
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+            for (idx j = 0; j < Dbar; ++j) // column major order for speed
+            {
+                for (idx i = 0; i < Dbar; ++i)
+                    result(i, j) = rA(ob_[i], ob_[j]);
+                for (idx a = 1; a < Ds; ++a)
+                    for (idx i = 0; i < Dbar; ++i)
+                        result(i, j) += rA(ob_[i] + os_[a], ob_[j] + os_[a]);
+            }
+        }
+            //************ Exception: not ket nor density matrix ************//
+        else
+            throw exception::MatrixNotSquareNorCvector(
+                    "qpp::PtracePlan::execute()");
+    }
+
+    /**
+    * \brief Executes the plan
+    *
+    * \note Allocates a temporary workspace for kets whose traced out
+    * subsystems are neither the leading nor the trailing ones, use the
+    * overload taking a workspace to reuse it between executions
+    *
+    * \param A Eigen expression, state vector or density matrix
+    * \param result Partial trace of \a A, resized only if its size does not
+    * match the size of the reduced system
+    */
+    template<typename Derived>
+    void execute(const Eigen::MatrixBase<Derived>& A,
+                 dyn_mat<typename Derived::Scalar>& result) const
+    {
+        dyn_mat<typename Derived::Scalar> workspace;
+        execute(A, result, workspace);
+    }
+
+    /**
+    * \brief Executes the plan
+    *
+    * \param A Eigen expression, state vector or density matrix
+    * \return Partial trace of \a A, as a dynamic matrix
+    * over the same scalar field as \a A
+    */
+    template<typename Derived>
+    dyn_mat<typename Derived::Scalar>
+    execute(const Eigen::MatrixBase<Derived>& A) const
+    {
+        dyn_mat<typename Derived::Scalar> result;
+        execute(A, result);
+
+        return result;
+    }
+}; /* class PtracePlan */
+
+/**
+* \class qpp::PtransposePlan
+* \brief Partial transpose plan
+* \see qpp::ptranspose()
+*
+* Precomputes the index tables of the partial transpose over a fixed list of
+* subsystems of a fixed multi-partite system, so that the partial transpose of
+* many states can be computed without any index decoding. Executing the plan
+* into a result of the correct size does not allocate memory. The partial
+* transpose of a density matrix is performed by a cache-blocked tensor
+* transpose.
+*/
+class PtransposePlan
+{
+    std::vector<idx> subsys_; ///< transposed subsystems
+    std::vector<idx> dims_;   ///< dimensions of the multi-partite system
+    idx D_;                   ///< total dimension
+    std::vector<idx> part_;   ///< transposed part of each global index
+    internal::TensorTranspose rho_tt_; ///< density matrix reshuffling
+
+public:
+    /**
+    * \brief Constructs the partial transpose plan
+    *
+    * \param subsys Subsystem indexes that are transposed
+    * \param dims Dimensions of the multi-partite system
+    */
+    PtransposePlan(const std::vector<idx>& subsys,
+                   const std::vector<idx>& dims) :
+            subsys_{subsys}, dims_{dims}, D_{}, part_{}, rho_tt_{}
+    {
+        // EXCEPTION CHECKS
+
+        // check that dims is a valid dimension vector
+        if (!internal::check_dims(dims))
+            throw exception::DimsInvalid(
+                    "qpp::PtransposePlan::PtransposePlan()");
+
+        // check that subsys are valid
+        if (!internal::check_subsys_match_dims(subsys, dims))
+            throw exception::SubsysMismatchDims(
+                    "qpp::PtransposePlan::PtransposePlan()");
+        // END EXCEPTION CHECKS
+
+        D_ = prod(dims);
+        std::vector<idx> ob = internal::get_subsys_offsets(
+                complement(subsys, dims.size()), dims);
+        std::vector<idx> os = internal::get_subsys_offsets(subsys, dims);
+        part_.resize(D_);
+        for (auto&& b : ob)
+            for (auto&& s : os)
+                part_[b + s] = s;
+
+        // a column-major density matrix is a tensor with the column indexes
+        // followed by the row indexes; swap them for the subsystems subsys
+        idx N = dims.size();
+        std::vector<idx> dims2(2 * N), perm2(2 * N);
+        for (idx i = 0; i < N; ++i)
+        {
+            dims2[i] = dims2[N + i] = dims[i];
+            perm2[i] = i;
+            perm2[N + i] = N + i;
+        }
+        for (auto&& i : subsys)
+            std::swap(perm2[i], perm2[N + i]);
+        rho_tt_ = internal::TensorTranspose(dims2, perm2);
+    }
+
+    /**
+    * \brief Constructs the partial transpose plan
+    *
+    * \param subsys Subsystem indexes that are transposed
+    * \param N Number of subsystems
+    * \param d Subsystem dimensions
+    */
+    PtransposePlan(const std::vector<idx>& subsys, idx N, idx d = 2) :
+            PtransposePlan(subsys, std::vector<idx>(N, d))
+    {
+    }
+
+    /**
+    * \brief Transposed subsystems
+    *
+    * \return Subsystem indexes that are transposed
+    */
+    const std::vector<idx>& get_subsys() const noexcept
+    {
+        return subsys_;
+    }
+
+    /**
+    * \brief Dimensions of the multi-partite system
+    *
+    * \return Dimensions of the multi-partite system
+    */
+    const std::vector<idx>& get_dims() const noexcept
+    {
+        return dims_;
+    }
+
+    /**
+    * \brief Executes the plan
+    *
+    * \param A Eigen expression, state vector or density matrix
+    * \param result Partial transpose of \a A, resized only if its size does
+    * not match the size of the system
+    */
+    template<typename Derived>
+    void execute(const Eigen::MatrixBase<Derived>& A,
+                 dyn_mat<typename Derived::Scalar>& result) const
+    {
+        const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA
+                = A.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero-size
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::PtransposePlan::execute()");
+        // END EXCEPTION CHECKS
+
+        //************ ket ************//
+        if (internal::check_cvector(rA)) // we have a ket
+        {
+            // check that dims match the dimension of A
+            if (static_cast<idx>(rA.rows()) != D_)
+                throw exception::DimsMismatchCvector(
+                        "qpp::PtransposePlan::execute()");
+
+            result.resize(D_, D_);
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+            for (idx j = 0; j < D_; ++j) // column major order for speed
+                for (idx i = 0; i < D_; ++i)
+                    result(i, j) = rA(i - part_[i] + part_[j]) *
+                                   std::conj(rA(j - part_[j] + part_[i]));
+        }
+            //************ density matrix ************//
+        else if (internal::check_square_mat(rA)) // we have a density operator
+        {
+            // check that dims match the dimension of A
+            if (static_cast<idx>(rA.rows()) != D_)
+                throw exception::DimsMismatchMatrix(
+                        "qpp::PtransposePlan::execute()");
+
+            result.resize(D_, D_);
+            // no copy if rA is already a dynamic matrix
+            const dyn_mat<typename Derived::Scalar>& rho = rA;
+            rho_tt_.execute(rho.data(), result.data());
+        }
+            //************ Exception: not ket nor density matrix ************//
+        else
+            throw exception::MatrixNotSquareNorCvector(
+                    "qpp::PtransposePlan::execute()");
+    }
+
+    /**
+    * \brief Executes the plan
+    *
+    * \param A Eigen expression, state vector or density matrix
+    * \return Partial transpose of \a A, as a dynamic matrix
+    * over the same scalar field as \a A
+    */
+    template<typename Derived>
+    dyn_mat<typename Derived::Scalar>
+    execute(const Eigen::MatrixBase<Derived>& A) const
+    {
+        dyn_mat<typename Derived::Scalar> result;
+        execute(A, result);
+
+        return result;
+    }
+}; /* class PtransposePlan */
+
+/**
+* \class qpp::SyspermutePlan
+* \brief Subsystem permutation plan
+* \see qpp::syspermute()
+*
+* Precomputes the index tables of a fixed subsystem permutation of a fixed
+* multi-partite system, so that many states can be permuted without any
+* index decoding. Executing the plan into a result of the correct size does
+* not allocate memory. The permutation is performed by a cache-blocked
+* tensor transpose.
+*/
+class SyspermutePlan
+{
+    std::vector<idx> perm_; ///< permutation
+    std::vector<idx> dims_; ///< dimensions of the multi-partite system
+    idx D_;                 ///< total dimension
+    internal::TensorTranspose ket_tt_; ///< ket reshuffling
+    internal::TensorTranspose rho_tt_; ///< density matrix reshuffling
+
+public:
+    /**
+    * \brief Constructs the subsystem permutation plan
+    *
+    * \param perm Permutation, the subsystem \a perm[\a i] is permuted to the
+    * location \a i
+    * \param dims Dimensions of the multi-partite system
+    */
+    SyspermutePlan(const std::vector<idx>& perm, const std::vector<idx>& dims) :
+            perm_{perm}, dims_{dims}, D_{}, ket_tt_{}, rho_tt_{}
+    {
+        // EXCEPTION CHECKS
+
+        // check that dims is a valid dimension vector
+        if (!internal::check_dims(dims))
+            throw exception::DimsInvalid(
+                    "qpp::SyspermutePlan::SyspermutePlan()");
+
+        // check that we have a valid permutation
+        if (!internal::check_perm(perm))
+            throw exception::PermInvalid(
+                    "qpp::SyspermutePlan::SyspermutePlan()");
+
+        // check that permutation match dimensions
+        if (perm.size() != dims.size())
+            throw exception::PermMismatchDims(
+                    "qpp::SyspermutePlan::SyspermutePlan()");
+        // END EXCEPTION CHECKS
+
+        D_ = prod(dims);
+        ket_tt_ = internal::TensorTranspose(dims, perm);
+
+        // a column-major density matrix is a tensor with the column indexes
+        // followed by the row indexes, both permuted by perm
+        idx N = dims.size();
+        std::vector<idx> dims2(2 * N), perm2(2 * N);
+        for (idx i = 0; i < N; ++i)
+        {
+            dims2[i] = dims2[N + i] = dims[i];
+            perm2[i] = perm[i];
+            perm2[N + i] = N + perm[i];
+        }
+        rho_tt_ = internal::TensorTranspose(dims2, perm2);
+    }
+
+    /**
+    * \brief Constructs the subsystem permutation plan
+    *
+    * \param perm Permutation, the subsystem \a perm[\a i] is permuted to the
+    * location \a i
+    * \param d Subsystem dimensions
+    */
+    explicit SyspermutePlan(const std::vector<idx>& perm, idx d = 2) :
+            SyspermutePlan(perm, std::vector<idx>(perm.size(), d))
+    {
+    }
+
+    /**
+    * \brief Permutation
+    *
+    * \return Permutation
+    */
+    const std::vector<idx>& get_perm() const noexcept
+    {
+        return perm_;
+    }
+
+    /**
+    * \brief Dimensions of the multi-partite system
+    *
+    * \return Dimensions of the multi-partite system
+    */
+    const std::vector<idx>& get_dims() const noexcept
+    {
+        return dims_;
+    }
+
+    /**
+    * \brief Executes the plan
+    *
+    * \param A Eigen expression, state vector or density matrix
+    * \param result Permuted system, resized only if its size does not match
+    * the size of \a A
+    */
+    template<typename Derived>
+    void execute(const Eigen::MatrixBase<Derived>& A,
+                 dyn_mat<typename Derived::Scalar>& result) const
+    {
+        const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA
+                = A.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero-size
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::SyspermutePlan::execute()");
+        // END EXCEPTION CHECKS
+
+        //************ ket ************//
+        if (internal::check_cvector(rA)) // we have a ket
+        {
+            // check that dims match the dimension of A
+            if (static_cast<idx>(rA.rows()) != D_)
+                throw exception::DimsMismatchCvector(
+                        "qpp::SyspermutePlan::execute()");
+
+            result.resize(D_, 1);
+            // no copy if rA is already stored contiguously
+            Eigen::Ref<const dyn_col_vect<typename Derived::Scalar>> psi(rA);
+            ket_tt_.execute(psi.data(), result.data());
+        }
+            //************ density matrix ************//
+        else if (internal::check_square_mat(rA)) // we have a density operator
+        {
+            // check that dims match the dimension of A
+            if (static_cast<idx>(rA.rows()) != D_)
+                throw exception::DimsMismatchMatrix(
+                        "qpp::SyspermutePlan::execute()");
+
+            result.resize(D_, D_);
+            // no copy if rA is already a dynamic matrix
+            const dyn_mat<typename Derived::Scalar>& rho = rA;
+            rho_tt_.execute(rho.data(), result.data());
+        }
+            //************ Exception: not ket nor density matrix ************//
+        else
+            throw exception::MatrixNotSquareNorCvector(
+                    "qpp::SyspermutePlan::execute()");
+    }
+
+    /**
+    * \brief Executes the plan
+    *
+    * \param A Eigen expression, state vector or density matrix
+    * \return Permuted system, as a dynamic matrix
+    * over the same scalar field as \a A
+    */
+    template<typename Derived>
+    dyn_mat<typename Derived::Scalar>
+    execute(const Eigen::MatrixBase<Derived>& A) const
+    {
+        dyn_mat<typename Derived::Scalar> result;
+        execute(A, result);
+
+        return result;
+    }
+}; /* class SyspermutePlan */
+
+} /* namespace qpp */
+
+#endif /* CLASSES_PLANS_H_ */
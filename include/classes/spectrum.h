@@ -0,0 +1,175 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file classes/spectrum.h
+* \brief Spectrum of a Hermitian matrix, computed once and queried many times
+*/
+
+#ifndef CLASSES_SPECTRUM_H_
+#define CLASSES_SPECTRUM_H_
+
+namespace qpp
+{
+/**
+* \class qpp::Spectrum
+* \brief Spectrum of a Hermitian matrix, e.g. of a density matrix
+* \see qpp::entropy(), qpp::renyi(), qpp::tsallis(), qpp::negativity(),
+* qpp::lognegativity()
+*
+* Diagonalizes the Hermitian matrix once on construction, so that any number
+* of spectral quantities (von-Neumann, Renyi and Tsallis entropies, purity,
+* negativity) can then be computed from the eigenvalues, each in
+* \f$O(D)\f$ operations instead of one \f$O(D^3)\f$ decomposition per query.
+*/
+class Spectrum
+{
+    std::vector<double> evals_; ///< eigenvalues, in decreasing order
+    cmat evects_;               ///< eigenvectors, if computed
+    bool has_evects_;           ///< the eigenvectors were computed
+
+public:
+    /**
+    * \brief Computes the spectrum of the Hermitian matrix \a A
+    *
+    * \param A Eigen expression
+    * \param compute_evects If true, computes also the eigenvectors
+    */
+    template<typename Derived>
+    explicit Spectrum(const Eigen::MatrixBase<Derived>& A,
+                      bool compute_evects = false) :
+            evals_{}, evects_{}, has_evects_{compute_evects}
+    {
+        const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+        // EXCEPTION CHECKS
+
+        // check zero-size
+        if (!internal::check_nonzero_size(rA))
+            throw exception::ZeroSize("qpp::Spectrum::Spectrum()");
+
+        // check square matrix
+        if (!internal::check_square_mat(rA))
+            throw exception::MatrixNotSquare("qpp::Spectrum::Spectrum()");
+
+        // check Hermitian matrix
+        if (!internal::check_hermitian(rA))
+            throw exception::CustomException("qpp::Spectrum::Spectrum()",
+                                             "Matrix is not Hermitian!");
+        // END EXCEPTION CHECKS
+
+        Eigen::SelfAdjointEigenSolver<cmat> es(
+                rA.template cast<cplx>(),
+                compute_evects ? Eigen::ComputeEigenvectors
+                               : Eigen::EigenvaluesOnly);
+
+        // Eigen sorts the eigenvalues in increasing order
+        const idx D = static_cast<idx>(rA.rows());
+        evals_.resize(D);
+        for (idx i = 0; i < D; ++i)
+            evals_[i] = es.eigenvalues()(D - 1 - i);
+        if (compute_evects)
+            evects_ = es.eigenvectors().rowwise().reverse();
+    }
+
+    /**
+    * \brief Eigenvalues
+    *
+    * \return Eigenvalues, in decreasing order
+    */
+    const std::vector<double>& get_evals() const noexcept
+    {
+        return evals_;
+    }
+
+    /**
+    * \brief Eigenvectors
+    *
+    * \note Available only if the spectrum was constructed with
+    * \a compute_evects = true
+    *
+    * \return Matrix whose columns are the normalized eigenvectors, in the
+    * order of qpp::Spectrum::get_evals()
+    */
+    const cmat& get_evects() const
+    {
+        // EXCEPTION CHECKS
+
+        if (!has_evects_)
+            throw exception::CustomException("qpp::Spectrum::get_evects()",
+                                             "Eigenvectors not computed!");
+        // END EXCEPTION CHECKS
+
+        return evects_;
+    }
+
+    /**
+    * \brief Whether the eigenvectors were computed
+    *
+    * \return True if the eigenvectors are available, false otherwise
+    */
+    bool has_evects() const noexcept
+    {
+        return has_evects_;
+    }
+
+    /**
+    * \brief Dimension of the matrix
+    *
+    * \return Number of eigenvalues
+    */
+    idx get_D() const noexcept
+    {
+        return evals_.size();
+    }
+
+    /**
+    * \brief Purity \f$\mathrm{Tr}(A^2)\f$
+    *
+    * \return Sum of the squared eigenvalues
+    */
+    double purity() const noexcept
+    {
+        double result = 0;
+        for (auto&& x : evals_)
+            result += x * x;
+
+        return result;
+    }
+
+    /**
+    * \brief Trace norm (Schatten-1 norm)
+    *
+    * \return Sum of the absolute values of the eigenvalues
+    */
+    double trace_norm() const noexcept
+    {
+        double result = 0;
+        for (auto&& x : evals_)
+            result += std::abs(x);
+
+        return result;
+    }
+}; /* class Spectrum */
+
+} /* namespace qpp */
+
+#endif /* CLASSES_SPECTRUM_H_ */
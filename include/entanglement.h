@@ -99,6 +99,55 @@ dyn_col_vect<double> schmidtcoeffs(const Eigen::MatrixBase<Derived>& A,
     return schmidtcoeffs(A, dims);
 }
 
+/**
+* \brief Leading Schmidt coefficients of the bi-partite pure state \a A
+* \see qpp::schmidtcoeffs()
+*
+* Truncated version, computes only the \a rank leading Schmidt coefficients,
+* or only those greater than \a tol, by randomized range finding with
+* power iterations; the cost scales with the number of computed
+* coefficients instead of the full Schmidt rank.
+*
+* \param A Eigen expression
+* \param dims Dimensions of the bi-partite system
+* \param rank Maximum number of Schmidt coefficients, use 0 for no limit
+* \param tol Threshold below which the Schmidt coefficients are discarded
+* \return Leading Schmidt coefficients of \a A, ordered in decreasing
+* order, as a real dynamic column vector
+*/
+template<typename Derived>
+dyn_col_vect<double> schmidtcoeffs(const Eigen::MatrixBase<Derived>& A,
+                                   const std::vector<idx>& dims,
+                                   idx rank, double tol = 0)
+{
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::schmidtcoeffs()");
+    // check bi-partite
+    if (dims.size() != 2)
+        throw exception::NotBipartite("qpp::schmidtcoeffs()");
+    // check column vector
+    if (!internal::check_cvector(rA))
+        throw exception::MatrixNotCvector("qpp::schmidtcoeffs()");
+    // check matching dimensions
+    if (!internal::check_dims_match_cvect(dims, rA))
+        throw exception::DimsMismatchCvector("qpp::schmidtcoeffs()");
+    // check the tolerance
+    if (tol < 0)
+        throw exception::OutOfRange("qpp::schmidtcoeffs()");
+    // END EXCEPTION CHECKS
+
+    cmat M = transpose(reshape(rA, dims[1], dims[0])).template cast<cplx>();
+    auto usv = internal::randomized_svd(
+            M, rank, tol, RandomDevices::get_instance().get_prng(), false);
+
+    return std::get<1>(usv);
+}
+
 /**
 * \brief Schmidt basis on Alice side
 *
@@ -162,6 +211,54 @@ cmat schmidtA(const Eigen::MatrixBase<Derived>& A, idx d = 2)
     return schmidtA(A, dims);
 }
 
+/**
+* \brief Leading Schmidt basis vectors on Alice side
+* \see qpp::schmidtA()
+*
+* Truncated version, computes only the \a rank leading Schmidt coefficients,
+* or only those greater than \a tol, by randomized range finding with
+* power iterations; the cost scales with the number of computed
+* coefficients instead of the full Schmidt rank.
+*
+* \param A Eigen expression
+* \param dims Dimensions of the bi-partite system
+* \param rank Maximum number of Schmidt coefficients, use 0 for no limit
+* \param tol Threshold below which the Schmidt coefficients are discarded
+* \return Matrix whose columns are the Schmidt basis vectors on Alice
+* side that correspond to the leading Schmidt coefficients
+*/
+template<typename Derived>
+cmat schmidtA(const Eigen::MatrixBase<Derived>& A,
+              const std::vector<idx>& dims, idx rank, double tol = 0)
+{
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::schmidtA()");
+    // check bi-partite
+    if (dims.size() != 2)
+        throw exception::NotBipartite("qpp::schmidtA()");
+    // check column vector
+    if (!internal::check_cvector(rA))
+        throw exception::MatrixNotCvector("qpp::schmidtA()");
+    // check matching dimensions
+    if (!internal::check_dims_match_cvect(dims, rA))
+        throw exception::DimsMismatchCvector("qpp::schmidtA()");
+    // check the tolerance
+    if (tol < 0)
+        throw exception::OutOfRange("qpp::schmidtA()");
+    // END EXCEPTION CHECKS
+
+    cmat M = transpose(reshape(rA, dims[1], dims[0])).template cast<cplx>();
+    auto usv = internal::randomized_svd(
+            M, rank, tol, RandomDevices::get_instance().get_prng());
+
+    return std::get<0>(usv);
+}
+
 /**
 * \brief Schmidt basis on Bob side
 *
@@ -227,6 +324,54 @@ cmat schmidtB(const Eigen::MatrixBase<Derived>& A, idx d = 2)
     return schmidtB(A, dims);
 }
 
+/**
+* \brief Leading Schmidt basis vectors on Bob side
+* \see qpp::schmidtB()
+*
+* Truncated version, computes only the \a rank leading Schmidt coefficients,
+* or only those greater than \a tol, by randomized range finding with
+* power iterations; the cost scales with the number of computed
+* coefficients instead of the full Schmidt rank.
+*
+* \param A Eigen expression
+* \param dims Dimensions of the bi-partite system
+* \param rank Maximum number of Schmidt coefficients, use 0 for no limit
+* \param tol Threshold below which the Schmidt coefficients are discarded
+* \return Matrix whose columns are the Schmidt basis vectors on Bob
+* side that correspond to the leading Schmidt coefficients
+*/
+template<typename Derived>
+cmat schmidtB(const Eigen::MatrixBase<Derived>& A,
+              const std::vector<idx>& dims, idx rank, double tol = 0)
+{
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::schmidtB()");
+    // check bi-partite
+    if (dims.size() != 2)
+        throw exception::NotBipartite("qpp::schmidtB()");
+    // check column vector
+    if (!internal::check_cvector(rA))
+        throw exception::MatrixNotCvector("qpp::schmidtB()");
+    // check matching dimensions
+    if (!internal::check_dims_match_cvect(dims, rA))
+        throw exception::DimsMismatchCvector("qpp::schmidtB()");
+    // check the tolerance
+    if (tol < 0)
+        throw exception::OutOfRange("qpp::schmidtB()");
+    // END EXCEPTION CHECKS
+
+    cmat M = transpose(reshape(rA, dims[1], dims[0])).template cast<cplx>();
+    auto usv = internal::randomized_svd(
+            M, rank, tol, RandomDevices::get_instance().get_prng());
+
+    return std::get<2>(usv).conjugate();
+}
+
 /**
 * \brief Schmidt probabilities of the bi-partite pure state \a A
 *
@@ -303,6 +448,61 @@ std::vector<double> schmidtprobs(const Eigen::MatrixBase<Derived>& A, idx d = 2)
     return schmidtprobs(A, dims);
 }
 
+/**
+* \brief Leading Schmidt probabilities of the bi-partite pure state \a A
+* \see qpp::schmidtprobs()
+*
+* Truncated version, computes only the \a rank leading Schmidt coefficients,
+* or only those greater than \a tol, by randomized range finding with
+* power iterations; the cost scales with the number of computed
+* coefficients instead of the full Schmidt rank.
+* The probabilities are the squares of the computed coefficients.
+*
+* \param A Eigen expression
+* \param dims Dimensions of the bi-partite system
+* \param rank Maximum number of Schmidt coefficients, use 0 for no limit
+* \param tol Threshold below which the Schmidt coefficients are discarded
+* \return Real vector consisting of the leading Schmidt probabilities of
+* \a A, ordered in decreasing order
+*/
+template<typename Derived>
+std::vector<double> schmidtprobs(const Eigen::MatrixBase<Derived>& A,
+                                 const std::vector<idx>& dims,
+                                 idx rank, double tol = 0)
+{
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::schmidtprobs()");
+    // check bi-partite
+    if (dims.size() != 2)
+        throw exception::NotBipartite("qpp::schmidtprobs()");
+    // check column vector
+    if (!internal::check_cvector(rA))
+        throw exception::MatrixNotCvector("qpp::schmidtprobs()");
+    // check matching dimensions
+    if (!internal::check_dims_match_cvect(dims, rA))
+        throw exception::DimsMismatchCvector("qpp::schmidtprobs()");
+    // check the tolerance
+    if (tol < 0)
+        throw exception::OutOfRange("qpp::schmidtprobs()");
+    // END EXCEPTION CHECKS
+
+    cmat M = transpose(reshape(rA, dims[1], dims[0])).template cast<cplx>();
+    auto usv = internal::randomized_svd(
+            M, rank, tol, RandomDevices::get_instance().get_prng(), false);
+
+    std::vector<double> result;
+    const dyn_col_vect<double>& scf = std::get<1>(usv);
+    for (idx i = 0; i < static_cast<idx>(scf.rows()); ++i)
+        result.push_back(std::pow(scf(i), 2));
+
+    return result;
+}
+
 /**
 * \brief Entanglement of the bi-partite pure state \a A
 *
@@ -372,6 +572,237 @@ double entanglement(const Eigen::MatrixBase<Derived>& A, idx d = 2)
     return entanglement(A, dims);
 }
 
+/**
+* \brief Schmidt probabilities of the multi-partite pure state \a A across
+* all its contiguous cuts
+* \see qpp::schmidtprobs(), qpp::entanglement_profile()
+*
+* The cut \a k (\f$0\leq k < n - 1\f$, with \a n the number of subsystems)
+* separates the subsystems \f$0,\ldots,k\f$ from the subsystems
+* \f$k+1,\ldots,n-1\f$. The reduced density matrix of the smaller side of
+* the middle cuts is computed once, and those of the other cuts are obtained
+* from it by tracing out one subsystem at a time; the spectra of the
+* different cuts are then computed in parallel.
+*
+* \param A Eigen expression
+* \param dims Dimensions of the multi-partite system
+* \return Vector whose \a k-th element contains the Schmidt probabilities of
+* \a A across the cut \a k, ordered in decreasing order
+*/
+template<typename Derived>
+std::vector<std::vector<double>>
+schmidtprobs_profile(const Eigen::MatrixBase<Derived>& A,
+                     const std::vector<idx>& dims)
+{
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::schmidtprobs_profile()");
+    // check that dims is a valid dimension vector
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::schmidtprobs_profile()");
+    // check column vector
+    if (!internal::check_cvector(rA))
+        throw exception::MatrixNotCvector("qpp::schmidtprobs_profile()");
+    // check matching dimensions
+    if (!internal::check_dims_match_cvect(dims, rA))
+        throw exception::DimsMismatchCvector("qpp::schmidtprobs_profile()");
+    // END EXCEPTION CHECKS
+
+    const idx n = dims.size();
+    const idx D = static_cast<idx>(rA.rows());
+    if (n < 2)
+        return {};
+    const ket psi = rA.template cast<cplx>();
+
+    // left dimension of every cut
+    std::vector<idx> DL(n - 1);
+    DL[0] = dims[0];
+    for (idx k = 1; k < n - 1; ++k)
+        DL[k] = DL[k - 1] * dims[k];
+
+    // the cuts 0, ..., kmid use the reduced density matrix of the left
+    // side, the others the one of the right side (the smaller sides)
+    idx kmid = 0;
+    while (kmid + 1 < n - 1 && DL[kmid + 1] <= D / DL[kmid + 1])
+        ++kmid;
+    bool left = DL[kmid] <= D / DL[kmid];
+    if (!left) // the right side is smaller for all cuts
+        kmid = 0;
+
+    // only the lower triangles of the reduced density matrices are computed
+    // (up to complex conjugation, which leaves the spectrum unchanged); with
+    // the column-major map M(j, i) = psi(i * DR + j), the left reduced state
+    // is M^dagger M, and the right one is M M^dagger
+    std::vector<cmat> rhos(n - 1);
+    if (left)
+    {
+        idx Dl = DL[kmid];
+        Eigen::Map<const cmat> M(psi.data(), D / Dl, Dl);
+        rhos[kmid] = cmat::Zero(Dl, Dl);
+        rhos[kmid].template selfadjointView<Eigen::Lower>().rankUpdate(
+                M.adjoint());
+
+        // trace out the last subsystem of the left side, one at a time
+        for (idx k = kmid; k-- > 0;)
+        {
+            const idx d = dims[k + 1];
+            const idx Dk = DL[k];
+            const cmat& big = rhos[k + 1];
+            rhos[k] = cmat::Zero(Dk, Dk);
+            for (idx b = 0; b < Dk; ++b)
+                for (idx a = b; a < Dk; ++a)
+                    for (idx s = 0; s < d; ++s)
+                        rhos[k](a, b) += big(a * d + s, b * d + s);
+        }
+    }
+
+    idx kright = left ? kmid + 1 : 0; // first cut with a smaller right side
+    if (kright < n - 1)
+    {
+        idx Dr = D / DL[kright];
+        Eigen::Map<const cmat> M(psi.data(), Dr, D / Dr);
+        rhos[kright] = cmat::Zero(Dr, Dr);
+        rhos[kright].template selfadjointView<Eigen::Lower>().rankUpdate(M);
+
+        // trace out the first subsystem of the right side, one at a time
+        for (idx k = kright + 1; k < n - 1; ++k)
+        {
+            const idx d = dims[k];
+            const idx Dk = D / DL[k];
+            const cmat& big = rhos[k - 1];
+            rhos[k] = cmat::Zero(Dk, Dk);
+            for (idx b = 0; b < Dk; ++b)
+                for (idx a = b; a < Dk; ++a)
+                    for (idx s = 0; s < d; ++s)
+                        rhos[k](a, b) += big(s * Dk + a, s * Dk + b);
+        }
+    }
+
+    // the spectra of the different cuts are independent
+    std::vector<std::vector<double>> result(n - 1);
+#ifdef WITH_OPENMP_
+#pragma omp parallel for schedule(dynamic)
+#endif // WITH_OPENMP_
+    for (idx k = 0; k < n - 1; ++k)
+    {
+        Eigen::SelfAdjointEigenSolver<cmat> es(rhos[k],
+                                               Eigen::EigenvaluesOnly);
+        const dyn_col_vect<double>& ev = es.eigenvalues();
+        const idx Dk = static_cast<idx>(ev.rows());
+        result[k].resize(Dk);
+        for (idx i = 0; i < Dk; ++i) // decreasing order, no rounding below 0
+            result[k][i] = std::max(ev(Dk - 1 - i), 0.);
+    }
+
+    return result;
+}
+
+/**
+* \brief Schmidt probabilities of the multi-partite pure state \a A across
+* all its contiguous cuts
+* \see qpp::schmidtprobs(), qpp::entanglement_profile()
+*
+* The cut \a k (\f$0\leq k < n - 1\f$, with \a n the number of subsystems)
+* separates the subsystems \f$0,\ldots,k\f$ from the subsystems
+* \f$k+1,\ldots,n-1\f$.
+*
+* \param A Eigen expression
+* \param d Subsystem dimensions
+* \return Vector whose \a k-th element contains the Schmidt probabilities of
+* \a A across the cut \a k, ordered in decreasing order
+*/
+template<typename Derived>
+std::vector<std::vector<double>>
+schmidtprobs_profile(const Eigen::MatrixBase<Derived>& A, idx d = 2)
+{
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(A))
+        throw exception::ZeroSize("qpp::schmidtprobs_profile()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::schmidtprobs_profile()");
+    // END EXCEPTION CHECKS
+
+    idx N = internal::get_num_subsys(static_cast<idx>(rA.rows()), d);
+    std::vector<idx> dims(N, d); // local dimensions vector
+
+    return schmidtprobs_profile(A, dims);
+}
+
+/**
+* \brief Entanglement of the multi-partite pure state \a A across all its
+* contiguous cuts
+* \see qpp::entanglement(), qpp::schmidtprobs_profile()
+*
+* The cut \a k (\f$0\leq k < n - 1\f$, with \a n the number of subsystems)
+* separates the subsystems \f$0,\ldots,k\f$ from the subsystems
+* \f$k+1,\ldots,n-1\f$. Other entropies of the cuts, e.g. qpp::renyi(),
+* can be computed from the result of qpp::schmidtprobs_profile().
+*
+* \param A Eigen expression
+* \param dims Dimensions of the multi-partite system
+* \return Vector whose \a k-th element is the entanglement of \a A across
+* the cut \a k, with the logarithm in base 2
+*/
+template<typename Derived>
+std::vector<double> entanglement_profile(const Eigen::MatrixBase<Derived>& A,
+                                         const std::vector<idx>& dims)
+{
+    std::vector<std::vector<double>> probs = schmidtprobs_profile(A, dims);
+
+    std::vector<double> result;
+    for (auto&& it : probs)
+        result.push_back(entropy(it));
+
+    return result;
+}
+
+/**
+* \brief Entanglement of the multi-partite pure state \a A across all its
+* contiguous cuts
+* \see qpp::entanglement(), qpp::schmidtprobs_profile()
+*
+* The cut \a k (\f$0\leq k < n - 1\f$, with \a n the number of subsystems)
+* separates the subsystems \f$0,\ldots,k\f$ from the subsystems
+* \f$k+1,\ldots,n-1\f$.
+*
+* \param A Eigen expression
+* \param d Subsystem dimensions
+* \return Vector whose \a k-th element is the entanglement of \a A across
+* the cut \a k, with the logarithm in base 2
+*/
+template<typename Derived>
+std::vector<double> entanglement_profile(const Eigen::MatrixBase<Derived>& A,
+                                         idx d = 2)
+{
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(A))
+        throw exception::ZeroSize("qpp::entanglement_profile()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::entanglement_profile()");
+    // END EXCEPTION CHECKS
+
+    idx N = internal::get_num_subsys(static_cast<idx>(rA.rows()), d);
+    std::vector<idx> dims(N, d); // local dimensions vector
+
+    return entanglement_profile(A, dims);
+}
+
 /**
 * \brief G-concurrence of the bi-partite pure state \a A
 *
@@ -470,6 +901,19 @@ double negativity(const Eigen::MatrixBase<Derived>& A, idx d = 2)
     return negativity(A, dims);
 }
 
+/**
+* \brief Negativity of a bi-partite mixed state, from the precomputed
+* spectrum \a spec of its partial transpose
+*
+* \param spec Spectrum of the partial transpose of the state, e.g.
+* \code Spectrum(ptranspose(rho, {0}, dims)) \endcode
+* \return Negativity
+*/
+inline double negativity(const Spectrum& spec)
+{
+    return (spec.trace_norm() - 1.) / 2.;
+}
+
 /**
 * \brief Logarithmic negativity of the bi-partite mixed state \a A
 *
@@ -531,6 +975,19 @@ double lognegativity(const Eigen::MatrixBase<Derived>& A, idx d = 2)
     return lognegativity(A, dims);
 }
 
+/**
+* \brief Logarithmic negativity of a bi-partite mixed state, from the
+* precomputed spectrum \a spec of its partial transpose
+*
+* \param spec Spectrum of the partial transpose of the state, e.g.
+* \code Spectrum(ptranspose(rho, {0}, dims)) \endcode
+* \return Logarithmic negativity, with the logarithm in base 2
+*/
+inline double lognegativity(const Spectrum& spec)
+{
+    return std::log2(spec.trace_norm());
+}
+
 /**
 * \brief Wootters concurrence of the bi-partite qubit mixed state \a A
 *
@@ -51,7 +51,7 @@ double entropy(const Eigen::MatrixBase<Derived>& A)
         throw exception::MatrixNotSquare("qpp::entropy()");
     // END EXCEPTION CHECKS
 
-    dmat ev = svals(rA); // get the singular values
+    dmat ev = internal::square_svals(rA); // get the singular values
     double result = 0;
     for (idx i = 0; i < static_cast<idx>(ev.rows()); ++i)
         if (ev(i) != 0) // not identically zero
@@ -83,6 +83,17 @@ inline double entropy(const std::vector<double>& prob)
     return result;
 }
 
+/**
+* \brief von-Neumann entropy of the precomputed spectrum \a spec
+*
+* \param spec Spectrum of a density matrix
+* \return von-Neumann entropy, with the logarithm in base 2
+*/
+inline double entropy(const Spectrum& spec)
+{
+    return entropy(spec.get_evals());
+}
+
 /**
 * \brief Renyi-\f$\alpha\f$ entropy of the density matrix \a A,
 * for \f$\alpha\geq 0\f$
@@ -121,9 +132,9 @@ double renyi(const Eigen::MatrixBase<Derived>& A, double alpha)
         return entropy(rA);
 
     if (alpha == infty) // H min
-        return -std::log2(svals(rA)[0]);
+        return -std::log2(internal::square_svals(rA)[0]);
 
-    dmat sv = svals(rA); // get the singular values
+    dmat sv = internal::square_svals(rA); // get the singular values
     double result = 0;
     for (idx i = 0; i < static_cast<idx>(sv.rows()); ++i)
         if (sv(i) != 0) // not identically zero
@@ -180,6 +191,23 @@ inline double renyi(const std::vector<double>& prob, double alpha)
     return std::log2(result) / (1 - alpha);
 }
 
+/**
+* \brief Renyi-\f$\alpha\f$ entropy of the precomputed spectrum \a spec,
+* for \f$\alpha\geq 0\f$
+*
+*\note When \f$ \alpha\to 1\f$ the Renyi entropy converges to the
+* von-Neumann entropy, with the logarithm in base 2
+*
+* \param spec Spectrum of a density matrix
+* \param alpha Non-negative real number,
+* use qpp::infty for \f$\alpha = \infty\f$
+* \return Renyi-\f$\alpha\f$ entropy, with the logarithm in base 2
+*/
+inline double renyi(const Spectrum& spec, double alpha)
+{
+    return renyi(spec.get_evals(), alpha);
+}
+
 /**
 * \brief Tsallis-\f$q\f$ entropy of the density matrix \a A,
 * for \f$q\geq 0\f$
@@ -214,7 +242,7 @@ double tsallis(const Eigen::MatrixBase<Derived>& A, double q)
     if (q == 1) // Shannon/von-Neumann with base e logarithm
         return entropy(rA) * std::log(2);
 
-    dmat ev = svals(rA); // get the singular values
+    dmat ev = internal::square_svals(rA); // get the singular values
     double result = 0;
     for (idx i = 0; i < static_cast<idx>(ev.rows()); ++i)
         if (ev(i) != 0) // not identically zero
@@ -258,6 +286,23 @@ inline double tsallis(const std::vector<double>& prob, double q)
     return (result - 1) / (1 - q);
 }
 
+/**
+* \brief Tsallis-\f$q\f$ entropy of the precomputed spectrum \a spec,
+* for \f$q\geq 0\f$
+*
+* \note When \f$ q\to 1\f$ the Tsallis entropy converges to the
+* von-Neumann entropy, with the logarithm in base \f$ e \f$
+*
+* \param spec Spectrum of a density matrix
+* \param q Non-negative real number
+*
+* \return Tsallis-\f$q\f$ entropy
+*/
+inline double tsallis(const Spectrum& spec, double q)
+{
+    return tsallis(spec.get_evals(), q);
+}
+
 /**
 * \brief Quantum mutual information between 2 subsystems of a composite system
 *
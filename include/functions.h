@@ -451,7 +451,7 @@ svd(const Eigen::MatrixBase<Derived>& A)
         throw exception::ZeroSize("qpp::svd()");
     // END EXCEPTION CHECKS
 
-    Eigen::JacobiSVD<dyn_mat<typename Derived::Scalar>>
+    internal::SVD<dyn_mat<typename Derived::Scalar>>
             sv(rA,
                Eigen::DecompositionOptions::ComputeFullU |
                Eigen::DecompositionOptions::ComputeFullV);
@@ -478,7 +478,7 @@ dyn_col_vect<double> svals(const Eigen::MatrixBase<Derived>& A)
         throw exception::ZeroSize("qpp::svals()");
     // END EXCEPTION CHECKS
 
-    Eigen::JacobiSVD<dyn_mat<typename Derived::Scalar>> sv(rA);
+    internal::SVD<dyn_mat<typename Derived::Scalar>> sv(rA);
 
     return sv.singularValues();
 }
@@ -502,7 +502,7 @@ cmat svdU(const Eigen::MatrixBase<Derived>& A)
         throw exception::ZeroSize("qpp::svdU()");
     // END EXCEPTION CHECKS
 
-    Eigen::JacobiSVD<dyn_mat<typename Derived::Scalar>>
+    internal::SVD<dyn_mat<typename Derived::Scalar>>
             sv(rA, Eigen::DecompositionOptions::ComputeFullU);
 
     return sv.matrixU();
@@ -527,7 +527,7 @@ cmat svdV(const Eigen::MatrixBase<Derived>& A)
         throw exception::ZeroSize("qpp::svdV()");
     // END EXCEPTION CHECKS
 
-    Eigen::JacobiSVD<dyn_mat<typename Derived::Scalar>>
+    internal::SVD<dyn_mat<typename Derived::Scalar>>
             sv(rA, Eigen::DecompositionOptions::ComputeFullV);
 
     return sv.matrixV();
@@ -538,6 +538,9 @@ cmat svdV(const Eigen::MatrixBase<Derived>& A)
 /**
 * \brief Functional calculus f(A)
 *
+* Hermitian matrices (up to qpp::eps) are diagonalized with the self-adjoint
+* eigensolver, which is faster and better conditioned than the general one.
+*
 * \param A Eigen expression
 * \param f Pointer-to-function from complex to complex
 * \return \a \f$f(A)\f$
@@ -558,6 +561,18 @@ cmat funm(const Eigen::MatrixBase<Derived>& A, cplx (* f)(const cplx&))
         throw exception::MatrixNotSquare("qpp::funm()");
     // END EXCEPTION CHECKS
 
+    // Hermitian input, f(A) = V f(D) V^dagger with V unitary
+    if (internal::check_hermitian(rA))
+    {
+        Eigen::SelfAdjointEigenSolver<cmat> es(rA.template cast<cplx>());
+        const cmat& evects = es.eigenvectors();
+        dyn_col_vect<cplx> evals = es.eigenvalues().template cast<cplx>();
+        for (idx i = 0; i < static_cast<idx>(evals.rows()); ++i)
+            evals(i) = (*f)(evals(i)); // apply f(x) to each eigenvalue
+
+        return (evects * evals.asDiagonal()) * evects.adjoint();
+    }
+
     Eigen::ComplexEigenSolver<cmat> es(rA.template cast<cplx>());
     cmat evects = es.eigenvectors();
     cmat evals = es.eigenvalues();
@@ -644,6 +659,176 @@ cmat expm(const Eigen::MatrixBase<Derived>& A)
     return funm(rA, &std::exp);
 }
 
+/**
+* \brief Action of the matrix exponential on a vector
+* \see qpp::expm()
+*
+* Computes \f$e^{tA}|\psi\rangle\f$ without computing \f$e^{tA}\f$, by Krylov
+* subspace projections of dimension at most 30 with adaptive time steps, so
+* that only matrix-vector products with \a A are needed. For a time evolution
+* under the Hamiltonian \a H use \a A = \a H and \a t = -i times the time.
+*
+* \param A Eigen expression
+* \param psi Column vector Eigen expression
+* \param t Complex number
+* \param tol Error tolerance per unit time; an exception is thrown if it
+* cannot be reached, e.g. if it is below the machine precision
+* \return \f$e^{tA}|\psi\rangle\f$
+*/
+template<typename Derived1, typename Derived2>
+ket expmv(const Eigen::MatrixBase<Derived1>& A,
+          const Eigen::MatrixBase<Derived2>& psi, cplx t = 1,
+          double tol = 1e-12)
+{
+    const dyn_mat<typename Derived1::Scalar>& rA = A.derived();
+    const dyn_mat<typename Derived2::Scalar>& rpsi = psi.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::expmv()");
+
+    // check square matrix
+    if (!internal::check_square_mat(rA))
+        throw exception::MatrixNotSquare("qpp::expmv()");
+
+    // check column vector
+    if (!internal::check_cvector(rpsi))
+        throw exception::MatrixNotCvector("qpp::expmv()");
+
+    // check matching dimensions
+    if (rA.rows() != rpsi.rows())
+        throw exception::DimsMismatchCvector("qpp::expmv()");
+
+    // check the tolerance
+    if (tol <= 0)
+        throw exception::OutOfRange("qpp::expmv()");
+    // END EXCEPTION CHECKS
+
+    const cmat cA = rA.template cast<cplx>();
+    double anorm = cA.cwiseAbs().rowwise().sum().maxCoeff();
+
+    return internal::krylov_expv([&cA](const ket& w) -> ket { return cA * w; },
+                                 rpsi.template cast<cplx>(), t, tol, anorm);
+}
+
+/**
+* \brief Action of the exponential of a sparse matrix on a vector
+* \see qpp::expm()
+*
+* Computes \f$e^{tA}|\psi\rangle\f$ without computing \f$e^{tA}\f$, by Krylov
+* subspace projections of dimension at most 30 with adaptive time steps, so
+* that only sparse matrix-vector products with \a A are needed. For a time
+* evolution under the Hamiltonian \a H use \a A = \a H and \a t = -i times
+* the time.
+*
+* \param A Eigen sparse matrix expression
+* \param psi Column vector Eigen expression
+* \param t Complex number
+* \param tol Error tolerance per unit time; an exception is thrown if it
+* cannot be reached, e.g. if it is below the machine precision
+* \return \f$e^{tA}|\psi\rangle\f$
+*/
+template<typename Derived1, typename Derived2>
+ket expmv(const Eigen::SparseMatrixBase<Derived1>& A,
+          const Eigen::MatrixBase<Derived2>& psi, cplx t = 1,
+          double tol = 1e-12)
+{
+    const sp_cmat rA = A.derived().template cast<cplx>();
+    const dyn_mat<typename Derived2::Scalar>& rpsi = psi.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (rA.rows() == 0 || rA.cols() == 0)
+        throw exception::ZeroSize("qpp::expmv()");
+
+    // check square matrix
+    if (rA.rows() != rA.cols())
+        throw exception::MatrixNotSquare("qpp::expmv()");
+
+    // check column vector
+    if (!internal::check_cvector(rpsi))
+        throw exception::MatrixNotCvector("qpp::expmv()");
+
+    // check matching dimensions
+    if (rA.rows() != rpsi.rows())
+        throw exception::DimsMismatchCvector("qpp::expmv()");
+
+    // check the tolerance
+    if (tol <= 0)
+        throw exception::OutOfRange("qpp::expmv()");
+    // END EXCEPTION CHECKS
+
+    // infinity norm
+    std::vector<double> row_sums(static_cast<idx>(rA.rows()));
+    for (idx k = 0; k < static_cast<idx>(rA.outerSize()); ++k)
+        for (sp_cmat::InnerIterator it(rA, k); it; ++it)
+            row_sums[static_cast<idx>(it.row())] += std::abs(it.value());
+    double anorm = *std::max_element(std::begin(row_sums),
+                                     std::end(row_sums));
+
+    return internal::krylov_expv([&rA](const ket& w) -> ket { return rA * w; },
+                                 rpsi.template cast<cplx>(), t, tol, anorm);
+}
+
+/**
+* \brief Action of the exponential of a matrix-free operator on a vector
+* \see qpp::expm()
+*
+* Computes \f$e^{tA}|\psi\rangle\f$ by Krylov subspace projections of
+* dimension at most 30 with adaptive time steps, where the operator \a A is
+* given only by its action on vectors, e.g. for a qpp::PauliSum \a H use
+* \code
+* ket result = expmv([&H](const ket& v) { return H.apply(v); }, psi, -1_i);
+* \endcode
+*
+* \param A Function that returns \f$A|v\rangle\f$ for the vector \a v
+* \param psi Column vector Eigen expression
+* \param t Complex number
+* \param tol Error tolerance per unit time; an exception is thrown if it
+* cannot be reached, e.g. if it is below the machine precision
+* \return \f$e^{tA}|\psi\rangle\f$
+*/
+template<typename Derived>
+ket expmv(const std::function<ket(const ket&)>& A,
+          const Eigen::MatrixBase<Derived>& psi, cplx t = 1,
+          double tol = 1e-12)
+{
+    const dyn_mat<typename Derived::Scalar>& rpsi = psi.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (!internal::check_nonzero_size(rpsi))
+        throw exception::ZeroSize("qpp::expmv()");
+
+    // check column vector
+    if (!internal::check_cvector(rpsi))
+        throw exception::MatrixNotCvector("qpp::expmv()");
+
+    // check the tolerance
+    if (tol <= 0)
+        throw exception::OutOfRange("qpp::expmv()");
+
+    // check that A preserves the dimension
+    const ket cpsi = rpsi.template cast<cplx>();
+    ket Apsi = A(cpsi);
+    if (Apsi.rows() != cpsi.rows())
+        throw exception::DimsMismatchCvector("qpp::expmv()");
+    // END EXCEPTION CHECKS
+
+    // the norm of A is estimated from its action on psi, this only sets the
+    // first time step
+    double anorm = 1;
+    double nrm = cpsi.norm();
+    if (nrm > 0)
+        anorm = Apsi.norm() / nrm;
+
+    return internal::krylov_expv(A, cpsi, t, tol, anorm);
+}
+
 /**
 * \brief Matrix logarithm
 *
@@ -723,7 +908,8 @@ cmat cosm(const Eigen::MatrixBase<Derived>& A)
 * \brief Matrix power
 * \see qpp::powm()
 *
-* Uses the spectral decomposition of \a A to compute the matrix power.
+* Uses the spectral decomposition of \a A to compute the matrix power,
+* computed with the self-adjoint eigensolver when \a A is Hermitian.
 * By convention \f$A^0 = I\f$.
 *
 * \param A Eigen expression
@@ -750,6 +936,18 @@ cmat spectralpowm(const Eigen::MatrixBase<Derived>& A, const cplx z)
     if (real(z) == 0 && imag(z) == 0)
         return cmat::Identity(rA.rows(), rA.rows());
 
+    // Hermitian input, A^z = V D^z V^dagger with V unitary
+    if (internal::check_hermitian(rA))
+    {
+        Eigen::SelfAdjointEigenSolver<cmat> es(rA.template cast<cplx>());
+        const cmat& evects = es.eigenvectors();
+        dyn_col_vect<cplx> evals = es.eigenvalues().template cast<cplx>();
+        for (idx i = 0; i < static_cast<idx>(evals.rows()); ++i)
+            evals(i) = std::pow(evals(i), z);
+
+        return (evects * evals.asDiagonal()) * evects.adjoint();
+    }
+
     Eigen::ComplexEigenSolver<cmat> es(rA.template cast<cplx>());
     cmat evects = es.eigenvectors();
     cmat evals = es.eigenvalues();
@@ -921,9 +1119,14 @@ dyn_mat<typename T::Scalar> kron(const T& head, const Args& ... tail)
 * \brief Kronecker product
 * \see qpp::kronpow()
 *
+* \note The product is split recursively into the products of the two halves
+* of \a As, so the last (largest) product copies blocks of about
+* \f$\sqrt{D}\times\sqrt{D}\f$ elements, in parallel, instead of \f$D^2/4\f$
+* small blocks when \a As is a list of qubit matrices
+* \see qpp::KronOperator for a lazy product applied one factor at a time
+*
 * \param As std::vector of Eigen expressions
-* \return Kronecker product of all elements in \a As,
-* evaluated from left to right, as a dynamic matrix
+* \return Kronecker product of all elements in \a As, as a dynamic matrix
 * over the same scalar field as its arguments
 */
 template<typename Derived>
@@ -939,13 +1142,13 @@ dyn_mat<typename Derived::Scalar> kron(const std::vector<Derived>& As)
             throw exception::ZeroSize("qpp::kron()");
     // END EXCEPTION CHECKS
 
-    dyn_mat<typename Derived::Scalar> result = As[0].derived();
-    for (idx i = 1; i < As.size(); ++i)
-    {
-        result = kron(result, As[i]);
-    }
+    if (As.size() == 1)
+        return As[0].derived();
 
-    return result;
+    // balanced split, the products of the halves are about sqrt(D) x sqrt(D)
+    auto middle = std::begin(As) + As.size() / 2;
+    return internal::kron2(kron(std::vector<Derived>(std::begin(As), middle)),
+                           kron(std::vector<Derived>(middle, std::end(As))));
 }
 
 // Kronecker product of a list of matrices, preserve return type
@@ -201,6 +201,130 @@ dyn_col_vect<typename Derived::Scalar> ip(
     return ip(phi, psi, subsys, dims);
 }
 
+/**
+* \brief Expectation values of the Pauli strings \a Ps in the multi-qubit
+* state vector or density matrix \a A
+* \see qpp::expval()
+*
+* The expectation values are computed directly from the amplitudes of \a A,
+* without constructing the Pauli operators. The strings are grouped by the
+* qubits they flip (i.e. their X and Y positions), and all the strings of a
+* group are evaluated in a single read-only pass over \a A. Hence, e.g., all
+* the diagonal (I and Z only) terms of a Hamiltonian cost a single pass.
+*
+* \param A Eigen expression
+* \param Ps Pauli strings, one character I, X, Y or Z per qubit, e.g. "XIZ"
+* for \f$X\otimes I\otimes Z\f$
+* \return Vector of expectation values, \f$\langle\psi|P|\psi\rangle\f$ for a
+* state vector or \f$\mathrm{Tr}(P A)\f$ for a density matrix, in the order
+* of \a Ps
+*/
+template<typename Derived>
+std::vector<double> expval(const Eigen::MatrixBase<Derived>& A,
+                           const std::vector<std::string>& Ps)
+{
+    const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA
+            = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::expval()");
+    if (Ps.size() == 0)
+        throw exception::ZeroSize("qpp::expval()");
+
+    // check the Pauli strings
+    idx N = Ps[0].size();
+    for (auto&& P : Ps)
+    {
+        if (P.size() != N)
+            throw exception::SizeMismatch("qpp::expval()");
+        for (auto&& c : P)
+            if (!internal::PauliString::is_pauli(c))
+                throw exception::CustomException("qpp::expval()",
+                                                 "Invalid Pauli string!");
+    }
+
+    // check that the Pauli strings match the state
+    if (N == 0 || N >= 64)
+        throw exception::DimsInvalid("qpp::expval()");
+    std::vector<idx> dims(N, 2);
+    if (internal::check_square_mat(rA))
+    {
+        if (!internal::check_dims_match_mat(dims, rA))
+            throw exception::DimsMismatchMatrix("qpp::expval()");
+    } else if (internal::check_cvector(rA))
+    {
+        if (!internal::check_dims_match_cvect(dims, rA))
+            throw exception::DimsMismatchCvector("qpp::expval()");
+    } else
+        throw exception::MatrixNotSquareNorCvector("qpp::expval()");
+    // END EXCEPTION CHECKS
+
+    // group the strings by their flip masks
+    std::map<idx, std::vector<idx>> groups;
+    std::vector<internal::PauliString> strings;
+    for (idx t = 0; t < Ps.size(); ++t)
+    {
+        strings.emplace_back(Ps[t]);
+        groups[strings.back().x].push_back(t);
+    }
+
+    std::vector<double> result(Ps.size());
+    for (auto&& group : groups)
+    {
+        std::vector<internal::PauliString> group_strings;
+        for (auto&& t : group.second)
+            group_strings.push_back(strings[t]);
+        std::vector<cplx> ev = internal::pauli_expvals(rA, group_strings);
+        for (idx i = 0; i < group.second.size(); ++i)
+            result[group.second[i]] = std::real(ev[i]);
+    }
+
+    return result;
+}
+
+// std::initializer_list overload, avoids ambiguity with the std::string
+// iterator-range constructor for 2-element lists
+/**
+* \brief Expectation values of the Pauli strings \a Ps in the multi-qubit
+* state vector or density matrix \a A
+* \see qpp::expval()
+*
+* \param A Eigen expression
+* \param Ps Pauli strings, one character I, X, Y or Z per qubit, e.g. "XIZ"
+* for \f$X\otimes I\otimes Z\f$
+* \return Vector of expectation values, \f$\langle\psi|P|\psi\rangle\f$ for a
+* state vector or \f$\mathrm{Tr}(P A)\f$ for a density matrix, in the order
+* of \a Ps
+*/
+template<typename Derived>
+std::vector<double> expval(const Eigen::MatrixBase<Derived>& A,
+                           const std::initializer_list<std::string>& Ps)
+{
+    return expval(A, std::vector<std::string>(Ps));
+}
+
+/**
+* \brief Expectation value of the Pauli string \a P in the multi-qubit state
+* vector or density matrix \a A
+*
+* The expectation value is computed in a single read-only pass over the
+* amplitudes of \a A, without constructing the Pauli operator.
+*
+* \param A Eigen expression
+* \param P Pauli string, one character I, X, Y or Z per qubit, e.g. "XIZ" for
+* \f$X\otimes I\otimes Z\f$
+* \return Expectation value, \f$\langle\psi|P|\psi\rangle\f$ for a state
+* vector or \f$\mathrm{Tr}(P A)\f$ for a density matrix
+*/
+template<typename Derived>
+double expval(const Eigen::MatrixBase<Derived>& A, const std::string& P)
+{
+    return expval(A, std::vector<std::string>{P})[0];
+}
+
 // full measurements
 /**
 * \brief Measures the state \a A using the set of Kraus operators \a Ks
@@ -295,6 +419,81 @@ measure(const Eigen::MatrixBase<Derived>& A,
     return measure(A, std::vector<cmat>(Ks));
 }
 
+/**
+* \brief Measures the state \a A using the set of sparse Kraus operators
+* \a Ks
+*
+* \param A Eigen expression
+* \param Ks Set of sparse Kraus operators, e.g. projectors onto subspaces
+* \return Tuple of: 1. Result of the measurement, 2.
+* Vector of outcome probabilities, and 3. Vector of post-measurement
+* normalized states
+*/
+template<typename Derived>
+std::tuple<idx, std::vector<double>, std::vector<cmat>>
+measure(const Eigen::MatrixBase<Derived>& A, const std::vector<sp_cmat>& Ks)
+{
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::measure()");
+
+    // check the Kraus operators
+    if (Ks.size() == 0)
+        throw exception::ZeroSize("qpp::measure()");
+    if (!internal::check_square_mat(Ks[0]))
+        throw exception::MatrixNotSquare("qpp::measure()");
+    if (Ks[0].rows() != rA.rows())
+        throw exception::DimsMismatchMatrix("qpp::measure()");
+    for (auto&& it : Ks)
+        if (it.rows() != Ks[0].rows() || it.cols() != Ks[0].rows())
+            throw exception::DimsNotEqual("qpp::measure()");
+    // END EXCEPTION CHECKS
+
+    // probabilities
+    std::vector<double> prob(Ks.size());
+    // resulting states
+    std::vector<cmat> outstates(Ks.size());
+
+    //************ density matrix ************//
+    if (internal::check_square_mat(rA)) // square matrix
+    {
+        for (idx i = 0; i < Ks.size(); ++i)
+        {
+            outstates[i] = cmat::Zero(rA.rows(), rA.rows());
+            cmat tmp = Ks[i] * rA;
+            tmp = tmp * Ks[i].adjoint(); // un-normalized;
+            prob[i] = std::abs(trace(tmp)); // probability
+            if (prob[i] > eps)
+                outstates[i] = tmp / prob[i]; // normalized
+        }
+    }
+        //************ ket ************//
+    else if (internal::check_cvector(rA)) // column vector
+    {
+        for (idx i = 0; i < Ks.size(); ++i)
+        {
+            outstates[i] = ket::Zero(rA.rows());
+            ket tmp = Ks[i] * rA; // un-normalized;
+            // probability
+            prob[i] = std::pow(norm(tmp), 2);
+            if (prob[i] > eps)
+                outstates[i] = tmp / std::sqrt(prob[i]); // normalized
+        }
+    } else
+        throw exception::MatrixNotSquareNorCvector("qpp::measure()");
+
+    // sample from the probability distribution
+    std::discrete_distribution<idx> dd(std::begin(prob),
+                                       std::end(prob));
+    idx result = dd(RandomDevices::get_instance().get_prng());
+
+    return std::make_tuple(result, prob, outstates);
+}
+
 /**
 * \brief Measures the state \a A in the orthonormal basis
 * specified by the unitary matrix \a U
@@ -382,9 +581,7 @@ measure(const Eigen::MatrixBase<Derived>& A,
     for (idx i = 0; i < subsys.size(); ++i)
         subsys_dims[i] = dims[subsys[i]];
 
-    idx D = prod(std::begin(dims), std::end(dims));
     idx Dsubsys = prod(std::begin(subsys_dims), std::end(subsys_dims));
-    idx Dsubsys_bar = D / Dsubsys;
 
     // check the Kraus operators
     if (Ks.size() == 0)
@@ -398,52 +595,14 @@ measure(const Eigen::MatrixBase<Derived>& A,
             throw exception::DimsNotEqual("qpp::measure()");
     // END EXCEPTION CHECKS
 
-    // probabilities
-    std::vector<double> prob(Ks.size());
-    // resulting states
-    std::vector<cmat> outstates(Ks.size(),
-                                cmat::Zero(Dsubsys_bar, Dsubsys_bar));
-
-    //************ density matrix ************//
-    if (internal::check_square_mat(rA)) // square matrix
-    {
-        for (idx i = 0; i < Ks.size(); ++i)
-        {
-            cmat tmp = apply(rA, Ks[i], subsys, dims);
-            tmp = ptrace(tmp, subsys, dims);
-            prob[i] = std::abs(trace(tmp)); // probability
-            if (prob[i] > eps)
-            {
-                // normalized output state
-                // corresponding to measurement result i
-                outstates[i] = tmp / prob[i];
-            }
-        }
-    }
-        //************ ket ************//
-    else if (internal::check_cvector(rA)) // column vector
-    {
-        for (idx i = 0; i < Ks.size(); ++i)
-        {
-            ket tmp = apply(rA, Ks[i], subsys, dims);
-            prob[i] = std::pow(norm(tmp), 2);
-            if (prob[i] > eps)
-            {
-                // normalized output state
-                // corresponding to measurement result i
-                tmp /= std::sqrt(prob[i]);
-                outstates[i] = ptrace(tmp, subsys, dims);
-            }
-        }
-    } else
-        throw exception::MatrixNotSquareNorCvector("qpp::measure()");
-
-    // sample from the probability distribution
-    std::discrete_distribution<idx> dd(std::begin(prob),
-                                       std::end(prob));
-    idx result = dd(RandomDevices::get_instance().get_prng());
+    // the post-measurement states are computed directly from the input
+    // state, see qpp::Measurement
+    Measurement m(rA, Ks, subsys, dims);
+    std::vector<cmat> outstates(Ks.size());
+    for (idx i = 0; i < Ks.size(); ++i)
+        outstates[i] = m.get_state(i);
 
-    return std::make_tuple(result, prob, outstates);
+    return std::make_tuple(m.get_result(), m.get_probs(), outstates);
 }
 
 // std::initializer_list overload, avoids ambiguity for 2-element lists, see
@@ -520,6 +679,71 @@ measure(const Eigen::MatrixBase<Derived>& A,
     return measure(rA, Ks, subsys, dims);
 }
 
+/**
+* \brief  Measures the part \a subsys of
+* the multi-partite state vector or density matrix \a A
+* using the set of sparse Kraus operators \a Ks
+* \see qpp::measure_seq()
+*
+* \note The dimension of all \a Ks must match the dimension of \a subsys.
+* The measurement is destructive, i.e. the measured subsystems are traced away.
+*
+* \param A Eigen expression
+* \param Ks Set of sparse Kraus operators
+* \param subsys Subsystem indexes that are measured
+* \param dims Dimensions of the multi-partite system
+* \return Tuple of: 1. Result of the measurement, 2.
+* Vector of outcome probabilities, and 3. Vector of post-measurement
+* normalized states
+*/
+template<typename Derived>
+std::tuple<idx, std::vector<double>, std::vector<cmat>>
+measure(const Eigen::MatrixBase<Derived>& A,
+        const std::vector<sp_cmat>& Ks,
+        const std::vector<idx>& subsys,
+        const std::vector<idx>& dims)
+{
+    // the Kraus operators only act on the (small) measured subsystems, and
+    // the post-measurement states are computed by qpp::Measurement directly
+    // from the input state, so they are densified
+    std::vector<cmat> dKs(Ks.size());
+    for (idx i = 0; i < Ks.size(); ++i)
+        dKs[i] = Ks[i];
+
+    return measure(A, dKs, subsys, dims);
+}
+
+/**
+* \brief  Measures the part \a subsys of
+* the multi-partite state vector or density matrix \a A
+* using the set of sparse Kraus operators \a Ks
+* \see qpp::measure_seq()
+*
+* \note The dimension of all \a Ks must match the dimension of \a subsys.
+* The measurement is destructive, i.e. the measured subsystems are traced away.
+*
+* \param A Eigen expression
+* \param Ks Set of sparse Kraus operators
+* \param subsys Subsystem indexes that are measured
+* \param d Subsystem dimensions
+* \return Tuple of: 1. Result of the measurement, 2.
+* Vector of outcome probabilities, and 3. Vector of post-measurement
+* normalized states
+*/
+template<typename Derived>
+std::tuple<idx, std::vector<double>, std::vector<cmat>>
+measure(const Eigen::MatrixBase<Derived>& A,
+        const std::vector<sp_cmat>& Ks,
+        const std::vector<idx>& subsys,
+        idx d = 2)
+{
+    std::vector<cmat> dKs(Ks.size());
+    for (idx i = 0; i < Ks.size(); ++i)
+        dKs[i] = Ks[i];
+
+    return measure(A, dKs, subsys, d);
+}
+
 // std::initializer_list overload, avoids ambiguity for 2-element lists, see
 // http://stackoverflow.com
 // /questions/26750039/ambiguity-when-using-initializer-list-as-parameter
@@ -561,7 +785,10 @@ measure(const Eigen::MatrixBase<Derived>& A,
 *
 * \param A Eigen expression
 * \param V Matrix whose columns represent the measurement basis vectors or the
-* bra parts of the rank-1 POVM
+* bra parts of the rank-1 POVM; the probability of the outcome \a i is
+* \f$|\langle v_i|\psi\rangle|^2\f$ for kets and
+* \f$\|v_i\|^2\langle v_i|\rho|v_i\rangle\f$ for density matrices, i.e.
+* the probability of the Kraus operator \f$|v_i\rangle\langle v_i|\f$
 * \param subsys Subsystem indexes that are measured
 * \param dims Dimensions of the multi-partite system
 * \return Tuple of: 1. Result of the measurement, 2.
@@ -611,39 +838,9 @@ measure(const Eigen::MatrixBase<Derived>& A,
     //************ ket ************//
     if (internal::check_cvector(rA))
     {
-        const ket& rpsi = A.derived();
         // check that dims match state vector
         if (!internal::check_dims_match_cvect(dims, rA))
             throw exception::DimsMismatchCvector("qpp::measure()");
-
-        std::vector<double> prob(M); // probabilities
-        std::vector<cmat> outstates(M); // resulting states
-
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
-        for (idx i = 0; i < M; ++i)
-            outstates[i] = ip(static_cast<const ket&>(V.col(i)),
-                              rpsi, subsys, dims);
-
-        for (idx i = 0; i < M; ++i)
-        {
-            double tmp = norm(outstates[i]);
-            prob[i] = tmp * tmp;
-            if (prob[i] > eps)
-            {
-                // normalized output state
-                // corresponding to measurement result m
-                outstates[i] /= tmp;
-            }
-        }
-
-        // sample from the probability distribution
-        std::discrete_distribution<idx> dd(std::begin(prob),
-                                           std::end(prob));
-        idx result = dd(RandomDevices::get_instance().get_prng());
-
-        return std::make_tuple(result, prob, outstates);
     }
         //************ density matrix ************//
     else if (internal::check_square_mat(rA))
@@ -652,14 +849,27 @@ measure(const Eigen::MatrixBase<Derived>& A,
         if (!internal::check_dims_match_mat(dims, rA))
             throw exception::DimsMismatchMatrix("qpp::measure()");
 
+        // the rank-1 POVM is measured via its Kraus operators
+        // v_i v_i^dagger, as the probabilities of non-normalized columns of
+        // V are |v_i|^2 <v_i|rho|v_i>
         std::vector<cmat> Ks(M);
         for (idx i = 0; i < M; ++i)
             Ks[i] = V.col(i) * adjoint(V.col(i));
 
         return measure(rA, Ks, subsys, dims);
     }
-    //************ Exception: not ket nor density matrix ************//
-    throw exception::MatrixNotSquareNorCvector("qpp::measure()");
+        //************ Exception: not ket nor density matrix ************//
+    else
+        throw exception::MatrixNotSquareNorCvector("qpp::measure()");
+
+    // the post-measurement states are computed directly from the input
+    // state, see qpp::Measurement
+    Measurement m(rA, V, subsys, dims);
+    std::vector<cmat> outstates(M);
+    for (idx i = 0; i < M; ++i)
+        outstates[i] = m.get_state(i);
+
+    return std::make_tuple(m.get_result(), m.get_probs(), outstates);
 }
 
 /**
@@ -673,7 +883,10 @@ measure(const Eigen::MatrixBase<Derived>& A,
 *
 * \param A Eigen expression
 * \param V Matrix whose columns represent the measurement basis vectors or the
-* bra parts of the rank-1 POVM
+* bra parts of the rank-1 POVM; the probability of the outcome \a i is
+* \f$|\langle v_i|\psi\rangle|^2\f$ for kets and
+* \f$\|v_i\|^2\langle v_i|\rho|v_i\rangle\f$ for density matrices, i.e.
+* the probability of the Kraus operator \f$|v_i\rangle\langle v_i|\f$
 * \param subsys Subsystem indexes that are measured
 * \param d Subsystem dimensions
 * \return Tuple of: 1. Result of the measurement, 2.
@@ -713,6 +926,11 @@ measure(const Eigen::MatrixBase<Derived>& A,
 * in the computational basis
 * \see qpp::measure()
 *
+* \note The joint outcome is sampled at once from the marginal probabilities
+* of the measured subsystems, and the state is then collapsed directly,
+* without constructing any measurement operator or any of the other
+* post-measurement states
+*
 * \param A Eigen expression
 * \param subsys Subsystem indexes that are measured
 * \param dims Dimensions of the multi-partite system
@@ -727,16 +945,12 @@ measure_seq(const Eigen::MatrixBase<Derived>& A,
             std::vector<idx> subsys,
             std::vector<idx> dims)
 {
-//    typename std::remove_const<
-//            typename Eigen::MatrixBase<Derived>::EvalReturnType
-//    >::type cA = A.derived();
-
-    dyn_mat<typename Derived::Scalar> cA = A.derived();
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
 
     // EXCEPTION CHECKS
 
     // check zero-size
-    if (!internal::check_nonzero_size(cA))
+    if (!internal::check_nonzero_size(rA))
         throw exception::ZeroSize("qpp::measure_seq()");
 
     // check that dimension is valid
@@ -745,15 +959,15 @@ measure_seq(const Eigen::MatrixBase<Derived>& A,
 
 
     // check square matrix or column vector
-    if (internal::check_square_mat(cA))
+    if (internal::check_square_mat(rA))
     {
         // check that dims match rho matrix
-        if (!internal::check_dims_match_mat(dims, cA))
+        if (!internal::check_dims_match_mat(dims, rA))
             throw exception::DimsMismatchMatrix("qpp::measure_seq()");
-    } else if (internal::check_cvector(cA))
+    } else if (internal::check_cvector(rA))
     {
         // check that dims match psi column vector
-        if (!internal::check_dims_match_cvect(dims, cA))
+        if (!internal::check_dims_match_cvect(dims, rA))
             throw exception::DimsMismatchMatrix("qpp::measure_seq()");
     } else
         throw exception::MatrixNotSquareNorCvector("qpp::measure_seq()");
@@ -763,32 +977,54 @@ measure_seq(const Eigen::MatrixBase<Derived>& A,
         throw exception::SubsysMismatchDims("qpp::measure_seq()");
     // END EXCEPTION CHECKS
 
-    std::vector<idx> result;
-    double prob = 1;
+    if (subsys.size() == 0)
+        return std::make_tuple(std::vector<idx>{}, 1., cmat(rA));
 
-    // sort subsys in decreasing order,
-    // the order of measurements does not matter
-    std::sort(std::begin(subsys), std::end(subsys), std::greater<idx> {});
+    // the order of measurements does not matter, so all subsystems are
+    // measured at once; the outcomes are listed in increasing order w.r.t.
+    // subsys
+    std::sort(std::begin(subsys), std::end(subsys));
+    std::vector<idx> subsys_dims(subsys.size());
+    for (idx i = 0; i < subsys.size(); ++i)
+        subsys_dims[i] = dims[subsys[i]];
+
+    // global offsets of the measured (os) and of the remaining (ob)
+    // subsystems, the global index ob[b] + os[j] corresponds to the outcome j
+    std::vector<idx> os = internal::get_subsys_offsets(subsys, dims);
+    std::vector<idx> ob = internal::get_subsys_offsets(
+            complement(subsys, dims.size()), dims);
+    idx Dbar = ob.size();
+
+    bool is_ket = internal::check_cvector(rA);
+    std::vector<double> prob = internal::get_outcome_probs(rA, os, ob);
+
+    // sample from the probability distribution
+    std::discrete_distribution<idx> dd(std::begin(prob), std::end(prob));
+    idx j = dd(RandomDevices::get_instance().get_prng());
 
-    //************ density matrix or column vector ************//
-    while (subsys.size() > 0)
+    std::vector<idx> result(subsys.size());
+    internal::n2multiidx(j, subsys.size(), subsys_dims.data(), result.data());
+
+    // collapse onto the outcome and renormalize
+    cmat state;
+    if (is_ket)
+    {
+        state.resize(Dbar, 1);
+        double sqrt_p = std::sqrt(prob[j]);
+        for (idx b = 0; b < Dbar; ++b)
+            state(b) = rA(ob[b] + os[j]) / sqrt_p;
+    } else
     {
-        auto tmp = measure(
-                cA, Gates::get_instance().Id(dims[subsys[0]]),
-                {subsys[0]}, dims
-        );
-        result.push_back(std::get<0>(tmp));
-        prob *= std::get<1>(tmp)[std::get<0>(tmp)];
-        cA = std::get<2>(tmp)[std::get<0>(tmp)];
-
-        // remove the subsystem
-        dims.erase(std::next(std::begin(dims), subsys[0]));
-        subsys.erase(std::begin(subsys));
+        state.resize(Dbar, Dbar);
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+        for (idx b2 = 0; b2 < Dbar; ++b2)
+            for (idx b1 = 0; b1 < Dbar; ++b1)
+                state(b1, b2) = rA(ob[b1] + os[j], ob[b2] + os[j]) / prob[j];
     }
-    // order result in increasing order with respect to subsys
-    std::reverse(std::begin(result), std::end(result));
 
-    return std::make_tuple(result, prob, cA);
+    return std::make_tuple(result, prob[j], state);
 }
 
 /**
@@ -831,6 +1067,332 @@ measure_seq(const Eigen::MatrixBase<Derived>& A,
     return measure_seq(rA, subsys, dims);
 }
 
+/**
+* \brief Measures the part \a subsys of the multi-partite state vector or
+* density matrix \a state in the computational basis, collapsing \a state
+* in-place
+* \see qpp::measure_seq()
+*
+* The measurement is non-destructive: the amplitudes that do not match the
+* sampled outcome are set to zero and the remaining ones are renormalized, in
+* a single pass over \a state, so that the layout of the multi-partite system
+* and its dimensions are preserved, e.g. for further evolution after a
+* mid-circuit measurement.
+*
+* \param state Eigen matrix or vector, overwritten with the post-measurement
+* normalized state
+* \param subsys Subsystem indexes that are measured
+* \param dims Dimensions of the multi-partite system
+* \return Tuple of: 1. Vector of outcome results of the measurement (ordered
+* in increasing order with respect to \a subsys, as in qpp::measure_seq()),
+* and 2. Outcome probability
+*/
+template<typename Derived>
+std::tuple<std::vector<idx>, double>
+measure_inplace(Eigen::MatrixBase<Derived>& state,
+                std::vector<idx> subsys,
+                const std::vector<idx>& dims)
+{
+    Derived& rstate = state.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::measure_inplace()");
+
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::measure_inplace()");
+
+    // check square matrix or column vector
+    if (internal::check_square_mat(rstate))
+    {
+        // check that dims match rho matrix
+        if (!internal::check_dims_match_mat(dims, rstate))
+            throw exception::DimsMismatchMatrix("qpp::measure_inplace()");
+    } else if (internal::check_cvector(rstate))
+    {
+        // check that dims match psi column vector
+        if (!internal::check_dims_match_cvect(dims, rstate))
+            throw exception::DimsMismatchCvector("qpp::measure_inplace()");
+    } else
+        throw exception::MatrixNotSquareNorCvector("qpp::measure_inplace()");
+
+    // check subsys is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(subsys, dims))
+        throw exception::SubsysMismatchDims("qpp::measure_inplace()");
+    // END EXCEPTION CHECKS
+
+    if (subsys.size() == 0)
+        return std::make_tuple(std::vector<idx>{}, 1.);
+
+    std::sort(std::begin(subsys), std::end(subsys));
+    std::vector<idx> subsys_dims(subsys.size());
+    for (idx i = 0; i < subsys.size(); ++i)
+        subsys_dims[i] = dims[subsys[i]];
+
+    // global offsets of the measured (os) and of the remaining (ob)
+    // subsystems, the global index ob[b] + os[j] corresponds to the outcome j
+    std::vector<idx> os = internal::get_subsys_offsets(subsys, dims);
+    std::vector<idx> ob = internal::get_subsys_offsets(
+            complement(subsys, dims.size()), dims);
+    const idx Dsubsys = os.size();
+    const idx Dbar = ob.size();
+
+    std::vector<double> prob = internal::get_outcome_probs(rstate, os, ob);
+
+    // sample from the probability distribution
+    std::discrete_distribution<idx> dd(std::begin(prob), std::end(prob));
+    idx j = dd(RandomDevices::get_instance().get_prng());
+
+    std::vector<idx> result(subsys.size());
+    internal::n2multiidx(j, subsys.size(), subsys_dims.data(), result.data());
+
+    // collapse onto the outcome and renormalize, every entry is visited once
+    if (internal::check_cvector(rstate))
+    {
+        const double sqrt_p = std::sqrt(prob[j]);
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+        for (idx b = 0; b < Dbar; ++b)
+            for (idx j1 = 0; j1 < Dsubsys; ++j1)
+            {
+                if (j1 == j)
+                    rstate(ob[b] + os[j1]) /= sqrt_p;
+                else
+                    rstate(ob[b] + os[j1]) = 0;
+            }
+    } else
+    {
+        const double p = prob[j];
+#ifdef WITH_OPENMP_
+#pragma omp parallel for collapse(2)
+#endif // WITH_OPENMP_
+        for (idx b2 = 0; b2 < Dbar; ++b2)
+            for (idx j2 = 0; j2 < Dsubsys; ++j2)
+            {
+                const idx c = ob[b2] + os[j2];
+                if (j2 != j)
+                {
+                    rstate.col(c).setZero();
+                    continue;
+                }
+                for (idx b1 = 0; b1 < Dbar; ++b1)
+                    for (idx j1 = 0; j1 < Dsubsys; ++j1)
+                    {
+                        if (j1 == j)
+                            rstate(ob[b1] + os[j1], c) /= p;
+                        else
+                            rstate(ob[b1] + os[j1], c) = 0;
+                    }
+            }
+    }
+
+    return std::make_tuple(result, prob[j]);
+}
+
+/**
+* \brief Measures the part \a subsys of the multi-partite state vector or
+* density matrix \a state in the computational basis, collapsing \a state
+* in-place
+* \see qpp::measure_seq()
+*
+* \param state Eigen matrix or vector, overwritten with the post-measurement
+* normalized state
+* \param subsys Subsystem indexes that are measured
+* \param d Subsystem dimensions
+* \return Tuple of: 1. Vector of outcome results of the measurement (ordered
+* in increasing order with respect to \a subsys, as in qpp::measure_seq()),
+* and 2. Outcome probability
+*/
+template<typename Derived>
+std::tuple<std::vector<idx>, double>
+measure_inplace(Eigen::MatrixBase<Derived>& state,
+                std::vector<idx> subsys,
+                idx d = 2)
+{
+    Derived& rstate = state.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::measure_inplace()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::measure_inplace()");
+    // END EXCEPTION CHECKS
+
+    idx N = internal::get_num_subsys(static_cast<idx>(rstate.rows()), d);
+    std::vector<idx> dims(N, d); // local dimensions vector
+
+    return measure_inplace(rstate, subsys, dims);
+}
+
+/**
+* \brief Samples repeatedly the outcomes of the measurement of the part
+* \a subsys of the multi-partite state vector or density matrix \a A in the
+* computational basis
+* \see qpp::measure_seq()
+*
+* The marginal distribution of the outcomes is computed once, then all
+* samples are drawn from its alias table, in parallel, in blocks of samples
+* with independent generators seeded by the random number generator of
+* qpp::RandomDevices. Hence the result does not depend on the number of
+* threads. The state is not modified.
+*
+* \param num_samples Number of samples
+* \param A Eigen expression
+* \param subsys Subsystem indexes that are measured
+* \param dims Dimensions of the multi-partite system
+* \return Histogram of the outcomes, as a map from the outcomes (ordered in
+* increasing order with respect to \a subsys, as in qpp::measure_seq()) to
+* the number of times they were sampled; outcomes never sampled are omitted
+*/
+template<typename Derived>
+std::map<std::vector<idx>, idx> sample(idx num_samples,
+                                       const Eigen::MatrixBase<Derived>& A,
+                                       std::vector<idx> subsys,
+                                       const std::vector<idx>& dims)
+{
+    const dyn_mat<typename Derived::Scalar>& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero-size
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::sample()");
+
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::sample()");
+
+    // check square matrix or column vector
+    if (internal::check_square_mat(rA))
+    {
+        // check that dims match rho matrix
+        if (!internal::check_dims_match_mat(dims, rA))
+            throw exception::DimsMismatchMatrix("qpp::sample()");
+    } else if (internal::check_cvector(rA))
+    {
+        // check that dims match psi column vector
+        if (!internal::check_dims_match_cvect(dims, rA))
+            throw exception::DimsMismatchMatrix("qpp::sample()");
+    } else
+        throw exception::MatrixNotSquareNorCvector("qpp::sample()");
+
+    // check subsys is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(subsys, dims))
+        throw exception::SubsysMismatchDims("qpp::sample()");
+    // END EXCEPTION CHECKS
+
+    std::sort(std::begin(subsys), std::end(subsys));
+    std::vector<idx> subsys_dims(subsys.size());
+    for (idx i = 0; i < subsys.size(); ++i)
+        subsys_dims[i] = dims[subsys[i]];
+
+    internal::AliasTable table(internal::get_outcome_probs(
+            rA, internal::get_subsys_offsets(subsys, dims),
+            internal::get_subsys_offsets(complement(subsys, dims.size()),
+                                         dims)));
+    const idx Dsubsys = table.size();
+
+    // one generator per block of samples
+    const idx block = 65536;
+    const idx nblocks = (num_samples + block - 1) / block;
+    std::vector<std::mt19937::result_type> seeds(nblocks);
+    for (auto&& seed : seeds)
+        seed = RandomDevices::get_instance().get_prng()();
+
+    std::vector<idx> counts(Dsubsys);
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        std::vector<idx> local_counts(Dsubsys); // thread-local histogram
+
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx k = 0; k < nblocks; ++k)
+        {
+            std::mt19937 gen(seeds[k]);
+            idx len = std::min(block, num_samples - k * block);
+            for (idx i = 0; i < len; ++i)
+                ++local_counts[table(gen)];
+        }
+
+#ifdef WITH_OPENMP_
+#pragma omp critical
+#endif // WITH_OPENMP_
+        {
+            for (idx j = 0; j < Dsubsys; ++j)
+                counts[j] += local_counts[j];
+        }
+    }
+
+    std::map<std::vector<idx>, idx> result;
+    std::vector<idx> outcome(subsys.size());
+    for (idx j = 0; j < Dsubsys; ++j)
+        if (counts[j] != 0)
+        {
+            internal::n2multiidx(j, subsys.size(), subsys_dims.data(),
+                                 outcome.data());
+            result[outcome] = counts[j];
+        }
+
+    return result;
+}
+
+/**
+* \brief Samples repeatedly the outcomes of the measurement of the part
+* \a subsys of the multi-partite state vector or density matrix \a A in the
+* computational basis
+* \see qpp::measure_seq()
+*
+* The marginal distribution of the outcomes is computed once, then all
+* samples are drawn from its alias table, in parallel, in blocks of samples
+* with independent generators seeded by the random number generator of
+* qpp::RandomDevices. Hence the result does not depend on the number of
+* threads. The state is not modified.
+*
+* \param num_samples Number of samples
+* \param A Eigen expression
+* \param subsys Subsystem indexes that are measured
+* \param d Subsystem dimensions
+* \return Histogram of the outcomes, as a map from the outcomes (ordered in
+* increasing order with respect to \a subsys, as in qpp::measure_seq()) to
+* the number of times they were sampled; outcomes never sampled are omitted
+*/
+template<typename Derived>
+std::map<std::vector<idx>, idx> sample(idx num_samples,
+                                       const Eigen::MatrixBase<Derived>& A,
+                                       const std::vector<idx>& subsys,
+                                       idx d = 2)
+{
+    const typename Eigen::MatrixBase<Derived>::EvalReturnType& rA
+            = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::sample()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::sample()");
+    // END EXCEPTION CHECKS
+
+    idx N = internal::get_num_subsys(static_cast<idx>(rA.rows()), d);
+    std::vector<idx> dims(N, d); // local dimensions vector
+
+    return sample(num_samples, rA, subsys, dims);
+}
+
 } /* namespace qpp */
 
 #endif /* INSTRUMENTS_H_ */
@@ -0,0 +1,106 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file internal/classes/alias_table.h
+* \brief Internal alias table for sampling discrete distributions
+*/
+
+#ifndef INTERNAL_CLASSES_ALIAS_TABLE_H_
+#define INTERNAL_CLASSES_ALIAS_TABLE_H_
+
+namespace qpp
+{
+namespace internal
+{
+// Walker's alias table (built with Vose's method) of the discrete
+// distribution proportional to the non-negative weights w, sampled in O(1)
+// with a single uniform random number; outcomes of zero weight are never
+// sampled
+// no error checks, the weights are assumed to be valid, with a positive sum
+class AliasTable
+{
+    std::vector<double> prob_; // probability of keeping the drawn column
+    std::vector<idx> alias_;   // outcome sampled otherwise
+
+public:
+    explicit AliasTable(const std::vector<double>& w) :
+            prob_(w.size()), alias_(w.size())
+    {
+        const idx n = w.size();
+        double sum = std::accumulate(std::begin(w), std::end(w), 0.);
+
+        // scaled weights, with mean 1
+        std::vector<idx> small, large;
+        for (idx i = 0; i < n; ++i)
+        {
+            prob_[i] = w[i] * n / sum;
+            alias_[i] = i;
+            if (prob_[i] < 1)
+                small.push_back(i);
+            else
+                large.push_back(i);
+        }
+
+        // fill each small column up to 1 with a large one
+        while (!small.empty() && !large.empty())
+        {
+            idx s = small.back();
+            small.pop_back();
+            idx l = large.back();
+            alias_[s] = l;
+            prob_[l] -= 1 - prob_[s];
+            if (prob_[l] < 1)
+            {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+
+        // the remaining columns are full, up to rounding errors
+        for (auto&& i : small)
+            prob_[i] = 1;
+        for (auto&& i : large)
+            prob_[i] = 1;
+    }
+
+    // number of outcomes
+    idx size() const noexcept
+    {
+        return prob_.size();
+    }
+
+    // samples an outcome
+    template<typename URNG>
+    idx operator()(URNG& gen) const
+    {
+        const idx n = prob_.size();
+        double u = std::uniform_real_distribution<double>(0, n)(gen);
+        idx i = std::min(static_cast<idx>(u), n - 1);
+
+        return u - i < prob_[i] ? i : alias_[i];
+    }
+};
+
+} /* namespace internal */
+} /* namespace qpp */
+
+#endif /* INTERNAL_CLASSES_ALIAS_TABLE_H_ */
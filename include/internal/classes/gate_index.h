@@ -0,0 +1,230 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file internal/classes/gate_index.h
+* \brief Internal index bookkeeping classes for the gate kernels
+*/
+
+#ifndef INTERNAL_CLASSES_GATE_INDEX_H_
+#define INTERNAL_CLASSES_GATE_INDEX_H_
+
+namespace qpp
+{
+namespace internal
+{
+// index bookkeeping for a gate acting on the subsystems subsys, controlled
+// by the subsystems ctrl (all of the same dimension); the remaining
+// subsystems (the "rest") are enumerated in lexicographical order
+// no error checks, the inputs are assumed to be valid
+class CtrlGateIndex
+{
+public:
+    idx D = 1;     // total dimension
+    idx DA = 1;    // dimension of the gate subsystems
+    idx d = 2;     // dimension of each control (2 when there are no controls)
+    idx Dctrl = 1; // dimension of the control subsystems
+    idx Drest = 1; // dimension of the rest
+    idx ctrl_diag = 0; // offset of the control basis state |11...1>
+    std::vector<idx> offA{}; // offsets of the basis states of the gate part
+
+private:
+    idx nctrl_ = 0;
+    idx nrest_ = 0;
+    idx ctrl_strides_[maxn]{};
+    idx rest_dims_[maxn]{};
+    idx rest_strides_[maxn]{};
+
+public:
+    CtrlGateIndex(const std::vector<idx>& ctrl,
+                  const std::vector<idx>& subsys,
+                  const std::vector<idx>& dims) :
+            nctrl_{ctrl.size()}
+    {
+        idx N = dims.size();
+        idx strides[maxn];
+        for (idx i = N; i-- > 0;)
+        {
+            strides[i] = D;
+            D *= dims[i];
+        }
+
+        if (nctrl_ > 0)
+            d = dims[ctrl[0]];
+        for (idx k = 0; k < nctrl_; ++k)
+        {
+            ctrl_strides_[k] = strides[ctrl[k]];
+            ctrl_diag += strides[ctrl[k]];
+            Dctrl *= d;
+        }
+
+        // offsets of the gate part, in lexicographical order
+        offA = get_subsys_offsets(subsys, dims);
+        DA = offA.size();
+
+        // the rest
+        std::vector<bool> used(N, false);
+        for (auto&& k : ctrl)
+            used[k] = true;
+        for (auto&& k : subsys)
+            used[k] = true;
+        for (idx k = 0; k < N; ++k)
+            if (!used[k])
+            {
+                rest_dims_[nrest_] = dims[k];
+                rest_strides_[nrest_] = strides[k];
+                Drest *= dims[k];
+                ++nrest_;
+            }
+    }
+
+    // global offset of the r-th basis state of the rest
+    idx rest_offset(idx r) const noexcept
+    {
+        idx result = 0;
+        for (idx k = nrest_; k-- > 0;)
+        {
+            result += (r % rest_dims_[k]) * rest_strides_[k];
+            r /= rest_dims_[k];
+        }
+
+        return result;
+    }
+
+    // global offset of the c-th basis state of the controls; sets power to
+    // the common value of the controls if they are all equal, or to 0
+    // otherwise; without controls power is set to 1
+    idx ctrl_offset(idx c, idx& power) const noexcept
+    {
+        if (nctrl_ == 0)
+        {
+            power = 1;
+            return 0;
+        }
+
+        idx result = 0;
+        bool all_equal = true;
+        idx first = c % d; // value of the last control
+        for (idx k = nctrl_; k-- > 0;)
+        {
+            idx digit = c % d;
+            if (digit != first)
+                all_equal = false;
+            result += digit * ctrl_strides_[k];
+            c /= d;
+        }
+        power = all_equal ? first : 0;
+
+        return result;
+    }
+}; /* class CtrlGateIndex */
+
+// bit-mask bookkeeping for a controlled gate acting on a system of N qubits,
+// qubit k corresponds to the bit 2^(N - 1 - k) of the global index
+// no error checks, the inputs are assumed to be valid
+class QubitGateIndex
+{
+public:
+    idx D = 1;         // total dimension
+    idx DA = 1;        // dimension of the gate subsystems
+    idx ctrl_mask = 0; // bits of the control qubits
+    std::vector<idx> offA{}; // bit masks of the basis states of the gate part
+    idx Dfree = 1;     // dimension of the qubits not acted upon
+    idx Dnontarget = 1; // dimension of the qubits that are not targets
+
+private:
+    idx nfixed_ = 0;   // number of control + target qubits
+    idx ntarget_ = 0;  // number of target qubits
+    idx fixed_pos_[maxn]{};  // bit positions of control + target qubits
+    idx target_pos_[maxn]{}; // bit positions of target qubits
+
+    // inserts zero bits at the (sorted, increasing) positions pos
+    static idx insert_zeros_(idx j, const idx* pos, idx n) noexcept
+    {
+        for (idx k = 0; k < n; ++k)
+        {
+            idx low = j & ((static_cast<idx>(1) << pos[k]) - 1);
+            j = ((j >> pos[k]) << (pos[k] + 1)) | low;
+        }
+
+        return j;
+    }
+
+public:
+    QubitGateIndex(const std::vector<idx>& ctrl,
+                   const std::vector<idx>& subsys, idx N) :
+            D{static_cast<idx>(1) << N}, nfixed_{ctrl.size() + subsys.size()},
+            ntarget_{subsys.size()}
+    {
+        for (idx k = 0; k < ctrl.size(); ++k)
+        {
+            ctrl_mask |= static_cast<idx>(1) << (N - 1 - ctrl[k]);
+            fixed_pos_[k] = N - 1 - ctrl[k];
+        }
+        for (idx k = 0; k < subsys.size(); ++k)
+        {
+            fixed_pos_[ctrl.size() + k] = N - 1 - subsys[k];
+            target_pos_[k] = N - 1 - subsys[k];
+        }
+        std::sort(fixed_pos_, fixed_pos_ + nfixed_);
+        std::sort(target_pos_, target_pos_ + ntarget_);
+
+        // offsets of the gate part, in lexicographical order
+        DA = static_cast<idx>(1) << ntarget_;
+        offA.resize(DA);
+        for (idx m = 0; m < DA; ++m)
+        {
+            idx off = 0;
+            for (idx k = 0; k < ntarget_; ++k)
+                if ((m >> (ntarget_ - 1 - k)) & 1)
+                    off |= static_cast<idx>(1) << (N - 1 - subsys[k]);
+            offA[m] = off;
+        }
+
+        Dfree = D >> nfixed_;
+        Dnontarget = D >> ntarget_;
+    }
+
+    // lowest bit position of the control + target qubits, i.e. number of
+    // lowest bits of the global index that are free
+    idx min_fixed_pos() const noexcept
+    {
+        return nfixed_ > 0 ? fixed_pos_[0] : 8 * sizeof(idx);
+    }
+
+    // j-th global index with all control bits set and all target bits
+    // cleared, j < Dfree
+    idx active_base(idx j) const noexcept
+    {
+        return insert_zeros_(j, fixed_pos_, nfixed_) | ctrl_mask;
+    }
+
+    // j-th global index with all target bits cleared, j < Dnontarget
+    idx base(idx j) const noexcept
+    {
+        return insert_zeros_(j, target_pos_, ntarget_);
+    }
+}; /* class QubitGateIndex */
+
+} /* namespace internal */
+} /* namespace qpp */
+
+#endif /* INTERNAL_CLASSES_GATE_INDEX_H_ */
@@ -0,0 +1,90 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file internal/classes/pauli_string.h
+* \brief Internal bit-mask representation of Pauli strings
+*/
+
+#ifndef INTERNAL_CLASSES_PAULI_STRING_H_
+#define INTERNAL_CLASSES_PAULI_STRING_H_
+
+namespace qpp
+{
+namespace internal
+{
+// Pauli string P = P_0 \otimes P_1 \otimes ... \otimes P_{N-1} on N qubits,
+// given as a string of characters I, X, Y and Z, stored as bit masks (qubit k
+// is the bit N - 1 - k) so that P|m> = i^nY (-1)^popcount(m & z) |m ^ x>
+// no error checks, the string is assumed to be valid
+class PauliString
+{
+public:
+    idx x = 0;  // qubits flipped by X or Y
+    idx z = 0;  // qubits with a phase from Z or Y
+    idx nY = 0; // number of Y's
+
+    PauliString() = default;
+
+    explicit PauliString(const std::string& P)
+    {
+        for (auto&& c : P)
+        {
+            x <<= 1;
+            z <<= 1;
+            if (c == 'X' || c == 'Y')
+                x |= 1;
+            if (c == 'Z' || c == 'Y')
+                z |= 1;
+            if (c == 'Y')
+                ++nY;
+        }
+    }
+
+    // true if c is one of I, X, Y and Z
+    static bool is_pauli(char c) noexcept
+    {
+        return c == 'I' || c == 'X' || c == 'Y' || c == 'Z';
+    }
+
+    // global phase i^nY
+    cplx phase() const noexcept
+    {
+        static const cplx powers[4] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+
+        return powers[nY % 4];
+    }
+
+    // (-1)^popcount(m & z)
+    double sign(idx m) const noexcept
+    {
+#if (__GNUC__ || __clang__)
+        return __builtin_parityll(m & z) ? -1 : 1;
+#else
+        return std::bitset<64>(m & z).count() % 2 ? -1 : 1;
+#endif
+    }
+};
+
+} /* namespace internal */
+} /* namespace qpp */
+
+#endif /* INTERNAL_CLASSES_PAULI_STRING_H_ */
@@ -0,0 +1,230 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file internal/classes/tensor_transpose.h
+* \brief Internal cache-blocked out-of-place tensor transpose
+*/
+
+#ifndef INTERNAL_CLASSES_TENSOR_TRANSPOSE_H_
+#define INTERNAL_CLASSES_TENSOR_TRANSPOSE_H_
+
+namespace qpp
+{
+namespace internal
+{
+// out-of-place transpose of a tensor with dimensions dims, stored in the
+// standard lexicographical order (last index runs fastest); the index perm[m]
+// of the input becomes the index m of the output
+// no error checks, the inputs are assumed to be valid
+class TensorTranspose
+{
+    // a group of input indexes that stay adjacent in the output
+    struct Index_
+    {
+        idx dim;
+        idx istride; // stride in the input
+        idx ostride; // stride in the output
+    };
+
+    static constexpr idx tile_ = 16; // tile edge, in elements
+
+    idx D_ = 1;         // total number of elements
+    idx run_ = 1;       // length of the contiguous runs common to in and out
+    bool tiled_ = false; // runs are moved by 2D transposes of two indexes
+    idx ea_ = 1;        // tile edges, in runs
+    idx eb_ = 1;
+    idx na_ = 1;        // dimension of the fastest remaining input index
+    idx isa_ = 0;       // its input stride
+    idx osa_ = 0;       // its output stride
+    idx nb_ = 1;        // dimension of the fastest remaining output index
+    idx isb_ = 0;       // its input stride
+    idx osb_ = 0;       // its output stride
+    // offsets of the remaining indexes, split into two tables (outer and
+    // inner) so that their sizes stay of the order of sqrt(D)
+    std::vector<idx> ihi_{0}, ohi_{0}, ilo_{0}, olo_{0};
+
+    // input/output offsets of all values of the indexes in ix
+    static void expand_(const std::vector<Index_>& ix,
+                        std::vector<idx>& ioff, std::vector<idx>& ooff)
+    {
+        ioff = {0};
+        ooff = {0};
+        for (auto&& x : ix)
+        {
+            std::vector<idx> itmp, otmp;
+            itmp.reserve(ioff.size() * x.dim);
+            otmp.reserve(ooff.size() * x.dim);
+            for (idx k = 0; k < ioff.size(); ++k)
+                for (idx m = 0; m < x.dim; ++m)
+                {
+                    itmp.push_back(ioff[k] + m * x.istride);
+                    otmp.push_back(ooff[k] + m * x.ostride);
+                }
+            ioff = std::move(itmp);
+            ooff = std::move(otmp);
+        }
+    }
+
+public:
+    // identity on a single element
+    TensorTranspose() = default;
+
+    TensorTranspose(const std::vector<idx>& dims,
+                    const std::vector<idx>& perm)
+    {
+        idx N = dims.size();
+        std::vector<idx> istrides(N), ostrides(N);
+        for (idx i = N; i-- > 0;)
+        {
+            istrides[i] = D_;
+            D_ *= dims[i];
+        }
+        for (idx m = N, s = 1; m-- > 0;)
+        {
+            ostrides[perm[m]] = s;
+            s *= dims[perm[m]];
+        }
+
+        // drop trivial indexes and fuse the ones that stay adjacent,
+        // listing the groups in the output order
+        std::vector<Index_> ix;
+        for (idx m = 0; m < N; ++m)
+        {
+            idx k = perm[m];
+            if (dims[k] == 1)
+                continue;
+            if (!ix.empty() && ix.back().istride == istrides[k] * dims[k])
+            {
+                ix.back().dim *= dims[k];
+                ix.back().istride = istrides[k];
+                ix.back().ostride = ostrides[k];
+            }
+            else
+                ix.push_back({dims[k], istrides[k], ostrides[k]});
+        }
+        if (ix.empty())
+            return;
+
+        // contiguous runs
+        if (ix.back().istride == 1)
+        {
+            run_ = ix.back().dim;
+            ix.pop_back();
+        }
+
+        // short runs are moved by cache-blocked 2D transposes of the fastest
+        // remaining input and output indexes
+        if (!ix.empty() && run_ < tile_)
+        {
+            auto a = std::min_element(std::begin(ix), std::end(ix),
+                                      [](const Index_& x, const Index_& y)
+                                      { return x.istride < y.istride; });
+            auto b = std::end(ix) - 1;
+            if (a != b)
+            {
+                tiled_ = true;
+                // tiles of about (tile_ / run_)^2 runs, elongated along a
+                // when b is short
+                idx edge = tile_ / run_;
+                eb_ = std::min(edge, b->dim);
+                ea_ = edge * edge / eb_;
+                na_ = a->dim;
+                isa_ = a->istride;
+                osa_ = a->ostride;
+                nb_ = b->dim;
+                isb_ = b->istride;
+                osb_ = b->ostride;
+                ix.erase(b);
+                ix.erase(a);
+            }
+        }
+
+        // split the remaining indexes into an outer and an inner part
+        idx Drem = D_ / (run_ * na_ * nb_);
+        idx Dhi = 1, nhi = 0;
+        while (nhi < ix.size() && Dhi * Dhi < Drem)
+            Dhi *= ix[nhi++].dim;
+        expand_(std::vector<Index_>(std::begin(ix), std::begin(ix) + nhi),
+                ihi_, ohi_);
+        expand_(std::vector<Index_>(std::begin(ix) + nhi, std::end(ix)),
+                ilo_, olo_);
+    }
+
+    // total number of elements
+    idx size() const noexcept
+    {
+        return D_;
+    }
+
+    // out[permuted index] = in[index]; in and out must not overlap
+    template<typename Scalar>
+    void execute(const Scalar* in, Scalar* out) const
+    {
+        const idx nhi = ihi_.size();
+        const idx nlo = ilo_.size();
+
+        if (!tiled_)
+        {
+#ifdef WITH_OPENMP_
+#pragma omp parallel for collapse(2)
+#endif // WITH_OPENMP_
+            for (idx h = 0; h < nhi; ++h)
+                for (idx l = 0; l < nlo; ++l)
+                    std::copy(in + ihi_[h] + ilo_[l],
+                              in + ihi_[h] + ilo_[l] + run_,
+                              out + ohi_[h] + olo_[l]);
+            return;
+        }
+
+        // 2D transposes of na_ x nb_ slices of runs, in ea_ x eb_ tiles
+        const idx ntb = (nb_ + eb_ - 1) / eb_;
+#ifdef WITH_OPENMP_
+#pragma omp parallel for collapse(3)
+#endif // WITH_OPENMP_
+        for (idx h = 0; h < nhi; ++h)
+            for (idx l = 0; l < nlo; ++l)
+                for (idx tb = 0; tb < ntb; ++tb)
+                {
+                    const Scalar* pin = in + ihi_[h] + ilo_[l];
+                    Scalar* pout = out + ohi_[h] + olo_[l];
+                    idx b0 = tb * eb_;
+                    idx b1 = std::min(b0 + eb_, nb_);
+                    for (idx a0 = 0; a0 < na_; a0 += ea_)
+                    {
+                        idx a1 = std::min(a0 + ea_, na_);
+                        for (idx a = a0; a < a1; ++a)
+                            for (idx b = b0; b < b1; ++b)
+                            {
+                                const Scalar* src = pin + a * isa_ + b * isb_;
+                                Scalar* dest = pout + a * osa_ + b * osb_;
+                                for (idx r = 0; r < run_; ++r)
+                                    dest[r] = src[r];
+                            }
+                    }
+                }
+    }
+};
+
+} /* namespace internal */
+} /* namespace qpp */
+
+#endif /* INTERNAL_CLASSES_TENSOR_TRANSPOSE_H_ */
@@ -0,0 +1,1462 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file internal/kernels.h
+* \brief Internal in-place gate application kernels
+*/
+
+#ifndef INTERNAL_KERNELS_H_
+#define INTERNAL_KERNELS_H_
+
+namespace qpp
+{
+namespace internal
+{
+// powers A^0, A^1, ..., A^(n-1) of the square matrix A, with scalar type
+// Scalar
+template<typename Scalar, typename Derived>
+std::vector<dyn_mat<Scalar>> gate_powers(const Eigen::MatrixBase<Derived>& A,
+                                         idx n)
+{
+    const dyn_mat<Scalar>& rA = A.derived();
+
+    std::vector<dyn_mat<Scalar>> result;
+    result.reserve(n);
+    result.push_back(dyn_mat<Scalar>::Identity(rA.rows(), rA.cols()));
+    for (idx i = 1; i < n; ++i)
+        result.push_back(result.back() * rA);
+
+    return result;
+}
+
+// applies in-place the controlled gate described by ix to the ket psi,
+// Ai[i] is the power of the gate applied when all controls are equal to i
+template<typename Derived>
+void apply_ctrl_ket_inplace(
+        Eigen::MatrixBase<Derived>& psi,
+        const std::vector<dyn_mat<typename Derived::Scalar>>& Ai,
+        const CtrlGateIndex& ix)
+{
+    using Scalar = typename Derived::Scalar;
+    const idx DA = ix.DA;
+    const idx* const offA = ix.offA.data();
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        // thread-local buffers
+        dyn_col_vect<Scalar> in(DA), out(DA);
+
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx r = 0; r < ix.Drest; ++r)
+        {
+            idx rest = ix.rest_offset(r);
+            // A^0 is the identity, so start from 1
+            for (idx i = 1; i < ix.d; ++i)
+            {
+                idx base = rest + i * ix.ctrl_diag;
+                for (idx n = 0; n < DA; ++n)
+                    in(n) = psi(base + offA[n]);
+                out.noalias() = Ai[i] * in;
+                for (idx m = 0; m < DA; ++m)
+                    psi(base + offA[m]) = out(m);
+            }
+        }
+    }
+}
+
+// vectorized kernels apply to complex double kets with contiguous storage
+template<typename Derived>
+bool apply_ctrl_ket_qubits_simd(Eigen::MatrixBase<Derived>& psi,
+                                const dyn_mat<typename Derived::Scalar>& A,
+                                const QubitGateIndex& ix, std::true_type)
+{
+    return apply_ctrl_ket_qubits_simd(psi.derived().data(), A, ix);
+}
+
+template<typename Derived>
+bool apply_ctrl_ket_qubits_simd(Eigen::MatrixBase<Derived>&,
+                                const dyn_mat<typename Derived::Scalar>&,
+                                const QubitGateIndex&, std::false_type)
+{
+    return false;
+}
+
+// applies in-place the controlled gate A described by ix to the qubit ket
+// psi; pair-wise updates for 1-qubit gates, quartet updates for 2-qubit gates
+// (hand-vectorized when possible, see internal/simd.h)
+template<typename Derived>
+void apply_ctrl_ket_qubits_inplace(
+        Eigen::MatrixBase<Derived>& psi,
+        const dyn_mat<typename Derived::Scalar>& A,
+        const QubitGateIndex& ix)
+{
+    using Scalar = typename Derived::Scalar;
+    const idx* const offA = ix.offA.data();
+
+    using simd_compatible = std::integral_constant<bool,
+            std::is_same<Scalar, cplx>::value &&
+            (Derived::Flags & Eigen::DirectAccessBit) &&
+            Derived::InnerStrideAtCompileTime == 1>;
+    if (apply_ctrl_ket_qubits_simd(psi, A, ix, simd_compatible{}))
+        return;
+
+    if (ix.DA == 2) // 1-qubit gate, pair-wise updates
+    {
+        const Scalar a00 = A(0, 0), a01 = A(0, 1);
+        const Scalar a10 = A(1, 0), a11 = A(1, 1);
+        const idx t = offA[1];
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+        for (idx j = 0; j < ix.Dfree; ++j)
+        {
+            idx i0 = ix.active_base(j);
+            idx i1 = i0 | t;
+            Scalar x0 = psi(i0), x1 = psi(i1);
+            psi(i0) = a00 * x0 + a01 * x1;
+            psi(i1) = a10 * x0 + a11 * x1;
+        }
+    } else if (ix.DA == 4) // 2-qubit gate, quartet updates
+    {
+        Scalar a[4][4];
+        for (idx m = 0; m < 4; ++m)
+            for (idx n = 0; n < 4; ++n)
+                a[m][n] = A(m, n);
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+        for (idx j = 0; j < ix.Dfree; ++j)
+        {
+            idx base = ix.active_base(j);
+            Scalar x[4];
+            for (idx n = 0; n < 4; ++n)
+                x[n] = psi(base | offA[n]);
+            for (idx m = 0; m < 4; ++m)
+                psi(base | offA[m]) = a[m][0] * x[0] + a[m][1] * x[1] +
+                                      a[m][2] * x[2] + a[m][3] * x[3];
+        }
+    } else // generic number of target qubits
+    {
+        const idx DA = ix.DA;
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+        {
+            // thread-local buffers
+            dyn_col_vect<Scalar> in(DA), out(DA);
+
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+            for (idx j = 0; j < ix.Dfree; ++j)
+            {
+                idx base = ix.active_base(j);
+                for (idx n = 0; n < DA; ++n)
+                    in(n) = psi(base | offA[n]);
+                out.noalias() = A * in;
+                for (idx m = 0; m < DA; ++m)
+                    psi(base | offA[m]) = out(m);
+            }
+        }
+    }
+}
+
+// bases (global offsets of the first basis state of the gate part) of the
+// blocks acted upon by the controlled gate, with the power of the gate
+// applied to each of them
+inline void active_blocks(const CtrlGateIndex& ix, std::vector<idx>& bases,
+                          std::vector<idx>& powers)
+{
+    bases.clear();
+    powers.clear();
+    bases.reserve(ix.Drest * (ix.d - 1));
+    powers.reserve(ix.Drest * (ix.d - 1));
+    // A^0 is the identity, so start from 1
+    for (idx i = 1; i < ix.d; ++i)
+        for (idx r = 0; r < ix.Drest; ++r)
+        {
+            bases.push_back(ix.rest_offset(r) + i * ix.ctrl_diag);
+            powers.push_back(i);
+        }
+}
+
+inline void active_blocks(const QubitGateIndex& ix, std::vector<idx>& bases,
+                          std::vector<idx>& powers)
+{
+    bases.resize(ix.Dfree);
+    powers.assign(ix.Dfree, 1);
+    for (idx j = 0; j < ix.Dfree; ++j)
+        bases[j] = ix.active_base(j);
+}
+
+// left pass rho -> C rho, column by column, for the controlled gate acting on
+// the blocks with the given bases; in each column c only the blocks that
+// reach the row low[c] or below are computed (all of them if low is empty);
+// the blocks are processed in chunks that share the same power of the gate
+template<typename Derived>
+void apply_ctrl_rho_left(
+        Eigen::MatrixBase<Derived>& rho,
+        const std::vector<dyn_mat<typename Derived::Scalar>>& Ai,
+        const std::vector<idx>& offA, const std::vector<idx>& bases,
+        const std::vector<idx>& powers, const std::vector<idx>& low)
+{
+    using Scalar = typename Derived::Scalar;
+    const idx D = static_cast<idx>(rho.rows());
+    const idx DA = offA.size();
+    const idx nblocks = bases.size();
+    const idx chunk = 256; // blocks processed at once
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        // thread-local buffers
+        dyn_mat<Scalar> X(chunk, DA), Y(chunk, DA);
+        std::vector<idx> rows(chunk);
+
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx c = 0; c < D; ++c)
+        {
+            const idx row0 = low.empty() ? 0 : low[c];
+            for (idx g = 0; g < nblocks;)
+            {
+                // next chunk of blocks, with the same power of the gate
+                const idx p = powers[g];
+                idx len = 0;
+                for (; g < nblocks && powers[g] == p && len < chunk; ++g)
+                    if (bases[g] + offA[DA - 1] >= row0)
+                        rows[len++] = bases[g];
+                if (len == 0)
+                    continue;
+
+                for (idx n = 0; n < DA; ++n)
+                    for (idx k = 0; k < len; ++k)
+                        X(k, n) = rho(rows[k] + offA[n], c);
+                // new row m = sum_n A(m, n) * (old row n)
+                for (idx m = 0; m < DA; ++m)
+                {
+                    Y.col(m).head(len) = Ai[p](m, 0) * X.col(0).head(len);
+                    for (idx n = 1; n < DA; ++n)
+                        Y.col(m).head(len) += Ai[p](m, n) * X.col(n).head(len);
+                }
+                for (idx m = 0; m < DA; ++m)
+                    for (idx k = 0; k < len; ++k)
+                        rho(rows[k] + offA[m], c) = Y(k, m);
+            }
+        }
+    }
+}
+
+// right pass rho -> rho C^dagger, which combines whole columns, for the
+// controlled gate acting on the blocks with the given bases; only the rows
+// from the base of each block on are computed if lower is true
+template<typename Derived>
+void apply_ctrl_rho_right(
+        Eigen::MatrixBase<Derived>& rho,
+        const std::vector<dyn_mat<typename Derived::Scalar>>& Ai,
+        const std::vector<idx>& offA, const std::vector<idx>& bases,
+        const std::vector<idx>& powers, bool lower)
+{
+    using Scalar = typename Derived::Scalar;
+    const idx D = static_cast<idx>(rho.rows());
+    const idx DA = offA.size();
+    const idx chunk = 256; // rows processed at once
+
+    std::vector<dyn_mat<Scalar>> Aidag(Ai.size());
+    for (idx i = 1; i < Ai.size(); ++i)
+        Aidag[i] = Ai[i].adjoint();
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        // thread-local buffer
+        dyn_mat<Scalar> Y(chunk, DA);
+
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx g = 0; g < bases.size(); ++g)
+        {
+            const dyn_mat<Scalar>& Adag = Aidag[powers[g]];
+            const idx base = bases[g];
+            for (idx r0 = lower ? base : 0; r0 < D; r0 += chunk)
+            {
+                idx len = std::min(chunk, D - r0);
+                // new column m = sum_n (old column n) * Adag(n, m)
+                for (idx m = 0; m < DA; ++m)
+                {
+                    Y.col(m).head(len) = Adag(0, m) *
+                            rho.col(base + offA[0]).segment(r0, len);
+                    for (idx n = 1; n < DA; ++n)
+                        Y.col(m).head(len) += Adag(n, m) *
+                                rho.col(base + offA[n]).segment(r0, len);
+                }
+                for (idx m = 0; m < DA; ++m)
+                    rho.col(base + offA[m]).segment(r0, len) =
+                            Y.col(m).head(len);
+            }
+        }
+    }
+}
+
+// overwrites the strictly upper triangle of the square matrix A with the
+// adjoint of its strictly lower triangle, tile by tile
+template<typename Derived>
+void mirror_lower(Eigen::MatrixBase<Derived>& A)
+{
+    const idx D = static_cast<idx>(A.rows());
+    const idx tile = 32;
+    const idx ntiles = (D + tile - 1) / tile;
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for schedule(dynamic)
+#endif // WITH_OPENMP_
+    for (idx tj = 0; tj < ntiles; ++tj)
+        for (idx i0 = tj * tile; i0 < D; i0 += tile)
+        {
+            idx j0 = tj * tile;
+            idx j1 = std::min(j0 + tile, D);
+            idx i1 = std::min(i0 + tile, D);
+            for (idx j = j0; j < j1; ++j)
+                for (idx i = std::max(i0, j + 1); i < i1; ++i)
+                    A(j, i) = Eigen::numext::conj(A(i, j));
+        }
+}
+
+// applies in-place the controlled 1-qubit gate A described by ix to the qubit
+// density matrix rho, i.e. rho -> C rho C^dagger, in a single sweep over its
+// 2 x 2 blocks; for such small gates the two-pass kernel below is memory
+// bound, so a single sweep is faster, Hermitian input or not
+template<typename Derived>
+void apply_ctrl_rho_qubit_inplace(
+        Eigen::MatrixBase<Derived>& rho,
+        const dyn_mat<typename Derived::Scalar>& A,
+        const QubitGateIndex& ix)
+{
+    using Scalar = typename Derived::Scalar;
+    const idx t = ix.offA[1];
+    const idx cmask = ix.ctrl_mask;
+    const dyn_mat<Scalar> Adag = A.adjoint();
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx j2 = 0; j2 < ix.Dnontarget; ++j2)
+    {
+        idx col = ix.base(j2);
+        bool ctrl_col = (col & cmask) == cmask;
+        for (idx j1 = 0; j1 < ix.Dnontarget; ++j1)
+        {
+            idx row = ix.base(j1);
+            bool ctrl_row = (row & cmask) == cmask;
+            if (!ctrl_row && !ctrl_col) // identity on both sides
+                continue;
+
+            Scalar b00 = rho(row, col);
+            Scalar b01 = rho(row, col | t);
+            Scalar b10 = rho(row | t, col);
+            Scalar b11 = rho(row | t, col | t);
+            if (ctrl_row)
+            {
+                Scalar c00 = A(0, 0) * b00 + A(0, 1) * b10;
+                Scalar c01 = A(0, 0) * b01 + A(0, 1) * b11;
+                Scalar c10 = A(1, 0) * b00 + A(1, 1) * b10;
+                Scalar c11 = A(1, 0) * b01 + A(1, 1) * b11;
+                b00 = c00, b01 = c01, b10 = c10, b11 = c11;
+            }
+            if (ctrl_col)
+            {
+                Scalar c00 = b00 * Adag(0, 0) + b01 * Adag(1, 0);
+                Scalar c01 = b00 * Adag(0, 1) + b01 * Adag(1, 1);
+                Scalar c10 = b10 * Adag(0, 0) + b11 * Adag(1, 0);
+                Scalar c11 = b10 * Adag(0, 1) + b11 * Adag(1, 1);
+                b00 = c00, b01 = c01, b10 = c10, b11 = c11;
+            }
+            rho(row, col) = b00;
+            rho(row, col | t) = b01;
+            rho(row | t, col) = b10;
+            rho(row | t, col | t) = b11;
+        }
+    }
+}
+
+// applies in-place the controlled gate described by ix to the density
+// matrix rho, i.e. rho -> C rho C^dagger, where C is the controlled gate, as
+// a left pass over the columns followed by a right pass over the rows, in
+// O(D^2 * DA) operations; Ai[i] is the power of the gate applied when all
+// controls are equal to i
+// when rho is Hermitian so is the result, hence only its lower triangle is
+// computed (low[c] is the index c with the gate part set to 0), then mirrored
+template<typename Derived, typename GateIndex>
+void apply_ctrl_rho_inplace(
+        Eigen::MatrixBase<Derived>& rho,
+        const std::vector<dyn_mat<typename Derived::Scalar>>& Ai,
+        const GateIndex& ix, const std::vector<idx>& low)
+{
+    std::vector<idx> bases, powers;
+    active_blocks(ix, bases, powers);
+
+    if (check_hermitian(rho))
+    {
+        apply_ctrl_rho_left(rho, Ai, ix.offA, bases, powers, low);
+        apply_ctrl_rho_right(rho, Ai, ix.offA, bases, powers, true);
+        mirror_lower(rho);
+    } else
+    {
+        apply_ctrl_rho_left(rho, Ai, ix.offA, bases, powers, {});
+        apply_ctrl_rho_right(rho, Ai, ix.offA, bases, powers, false);
+    }
+}
+
+// applies in-place the channel with superoperator matrix S (in the convention
+// of qpp::kraus2super(), i.e. acting on row-major vectorizations of DA x DA
+// matrices) to every DA x DA block of rho, the block (r, c) having rows
+// ob[r] + offA and columns ob[c] + offA; the blocks of a column of blocks are
+// processed in chunks, as a single matrix product of the gathered blocks
+// with S^T
+template<typename Derived>
+void apply_super_rho_inplace(
+        Eigen::MatrixBase<Derived>& rho,
+        const dyn_mat<typename Derived::Scalar>& S,
+        const std::vector<idx>& offA, const std::vector<idx>& ob)
+{
+    using Scalar = typename Derived::Scalar;
+    const idx DA = offA.size();
+    const idx Dbar = ob.size();
+    const idx chunk = 64; // blocks processed at once
+    const dyn_mat<Scalar> St = S.transpose();
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        // thread-local buffers, one gathered block per row
+        dyn_mat<Scalar> X(chunk, DA * DA), Y(chunk, DA * DA);
+
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx c = 0; c < Dbar; ++c)
+            for (idx r0 = 0; r0 < Dbar; r0 += chunk)
+            {
+                idx len = std::min(chunk, Dbar - r0);
+                for (idx n2 = 0; n2 < DA; ++n2)
+                {
+                    idx col = ob[c] + offA[n2];
+                    for (idx n1 = 0; n1 < DA; ++n1)
+                        for (idx k = 0; k < len; ++k)
+                            X(k, n1 * DA + n2) = rho(ob[r0 + k] + offA[n1],
+                                                     col);
+                }
+                Y.topRows(len).noalias() = X.topRows(len) * St;
+                for (idx m2 = 0; m2 < DA; ++m2)
+                {
+                    idx col = ob[c] + offA[m2];
+                    for (idx m1 = 0; m1 < DA; ++m1)
+                        for (idx k = 0; k < len; ++k)
+                            rho(ob[r0 + k] + offA[m1], col) =
+                                    Y(k, m1 * DA + m2);
+                }
+            }
+    }
+}
+
+// applies in-place the channel with (dense or sparse) Kraus operators Ks to
+// every DA x DA block B of rho, B -> sum_K K B K^dagger, the block (r, c)
+// having rows ob[r] + offA and columns ob[c] + offA; the blocks of a column of
+// blocks are processed in chunks, stacked in thread-local buffers, in
+// O(Ks.size() * D^2 * DA) operations and without any D x D temporary
+template<typename Derived, typename KMat>
+void apply_kraus_rho_inplace(Eigen::MatrixBase<Derived>& rho,
+                             const std::vector<KMat>& Ks,
+                             const std::vector<idx>& offA,
+                             const std::vector<idx>& ob)
+{
+    using Scalar = typename Derived::Scalar;
+    const idx DA = offA.size();
+    const idx Dbar = ob.size();
+    // blocks processed at once, about 256 rows of stacked blocks
+    const idx chunk = std::max(static_cast<idx>(1), 256 / DA);
+
+    std::vector<KMat> Kads;
+    Kads.reserve(Ks.size());
+    for (auto&& K : Ks)
+        Kads.emplace_back(K.adjoint());
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        // thread-local buffers, the gathered blocks are stacked vertically
+        dyn_mat<Scalar> X(chunk * DA, DA), Y(chunk * DA, DA),
+                Z(chunk * DA, DA);
+
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx c = 0; c < Dbar; ++c)
+            for (idx r0 = 0; r0 < Dbar; r0 += chunk)
+            {
+                idx len = std::min(chunk, Dbar - r0);
+                idx rows = len * DA;
+                for (idx n2 = 0; n2 < DA; ++n2)
+                {
+                    idx col = ob[c] + offA[n2];
+                    for (idx k = 0; k < len; ++k)
+                        for (idx n1 = 0; n1 < DA; ++n1)
+                            X(k * DA + n1, n2) = rho(ob[r0 + k] + offA[n1],
+                                                     col);
+                }
+                Y.topRows(rows).setZero();
+                for (idx i = 0; i < Ks.size(); ++i)
+                {
+                    // B K^dagger for the stacked blocks, then K (B K^dagger)
+                    Z.topRows(rows).noalias() = X.topRows(rows) * Kads[i];
+                    for (idx k = 0; k < len; ++k)
+                        Y.middleRows(k * DA, DA).noalias() +=
+                                Ks[i] * Z.middleRows(k * DA, DA);
+                }
+                for (idx m2 = 0; m2 < DA; ++m2)
+                {
+                    idx col = ob[c] + offA[m2];
+                    for (idx k = 0; k < len; ++k)
+                        for (idx m1 = 0; m1 < DA; ++m1)
+                            rho(ob[r0 + k] + offA[m1], col) =
+                                    Y(k * DA + m1, m2);
+                }
+            }
+    }
+}
+
+// Tr(P A) for each of the Pauli strings Ps, which must all have the same flip
+// mask x, where A is a qubit density matrix or A = psi psi^dagger for a qubit
+// ket psi, in a single read-only pass over A; the matrix elements <m ^ x|A|m>
+// are gathered in chunks that stay in cache while all the strings are summed
+// over them, and the chunks are summed in a fixed order, hence the result does
+// not depend on the number of threads
+template<typename Derived>
+std::vector<cplx> pauli_expvals(const Eigen::MatrixBase<Derived>& A,
+                                const std::vector<PauliString>& Ps)
+{
+    const idx D = static_cast<idx>(A.rows());
+    const idx n = Ps.size();
+    const idx x = Ps[0].x;
+    const bool is_ket = check_cvector(A);
+    const idx chunk = 4096;
+    const idx nchunks = (D + chunk - 1) / chunk;
+    std::vector<cplx> partial(nchunks * n);
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        std::vector<cplx> v(chunk); // thread-local buffer
+
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx c = 0; c < nchunks; ++c)
+        {
+            const idx m0 = c * chunk;
+            const idx len = std::min(chunk, D - m0);
+            for (idx k = 0; k < len; ++k)
+            {
+                idx m = m0 + k;
+                if (is_ket)
+                {
+                    // conj(a) * b, avoids the slow checked complex product
+                    cplx a = A(m ^ x), b = A(m);
+                    v[k] = cplx(a.real() * b.real() + a.imag() * b.imag(),
+                                a.real() * b.imag() - a.imag() * b.real());
+                } else
+                    v[k] = A(m, m ^ x);
+            }
+            for (idx t = 0; t < n; ++t)
+            {
+                cplx sum = 0;
+                for (idx k = 0; k < len; ++k)
+                    sum += Ps[t].sign(m0 + k) * v[k];
+                partial[c * n + t] = sum;
+            }
+        }
+    }
+
+    std::vector<cplx> result(n);
+    for (idx c = 0; c < nchunks; ++c)
+        for (idx t = 0; t < n; ++t)
+            result[t] += partial[c * n + t];
+    for (idx t = 0; t < n; ++t)
+        result[t] *= Ps[t].phase();
+
+    return result;
+}
+
+// result += sum_t w[t] P_t psi for the Pauli strings Ps, which must all have
+// the same flip mask x, i.e. result(m ^ x) += f(m) psi(m) with
+// f(m) = sum_t w[t] i^nY_t (-1)^popcount(m & z_t), in a single pass over psi
+// and result
+template<typename Derived>
+void add_pauli_terms(const Eigen::MatrixBase<Derived>& psi,
+                     const std::vector<PauliString>& Ps,
+                     const std::vector<cplx>& w, ket& result)
+{
+    const idx D = static_cast<idx>(psi.rows());
+    const idx n = Ps.size();
+    const idx x = Ps[0].x;
+    std::vector<cplx> wp(n); // weights including the phases
+    for (idx t = 0; t < n; ++t)
+        wp[t] = w[t] * Ps[t].phase();
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx r = 0; r < D; ++r)
+    {
+        const idx m = r ^ x;
+        cplx f = 0;
+        for (idx t = 0; t < n; ++t)
+            f += Ps[t].sign(m) * wp[t];
+        // f * psi(m), avoids the slow checked complex product
+        cplx a = psi(m);
+        result(r) += cplx(f.real() * a.real() - f.imag() * a.imag(),
+                          f.real() * a.imag() + f.imag() * a.real());
+    }
+}
+
+// applies in-place the controlled diagonal gate described by ix to the ket
+// psi, Ai[i] is the power of the gate applied when all controls are equal to
+// i; only the amplitudes whose phase is not 1 are touched
+template<typename Derived>
+void apply_ctrl_ket_diag_inplace(
+        Eigen::MatrixBase<Derived>& psi,
+        const std::vector<dyn_mat<typename Derived::Scalar>>& Ai,
+        const CtrlGateIndex& ix)
+{
+    using Scalar = typename Derived::Scalar;
+
+    // offsets and phases of the non-trivial diagonal elements, per power
+    std::vector<std::vector<std::pair<idx, Scalar>>> ph(ix.d);
+    for (idx i = 1; i < ix.d; ++i)
+        for (idx n = 0; n < ix.DA; ++n)
+            if (Ai[i](n, n) != Scalar(1))
+                ph[i].emplace_back(i * ix.ctrl_diag + ix.offA[n],
+                                   Ai[i](n, n));
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx r = 0; r < ix.Drest; ++r)
+    {
+        idx rest = ix.rest_offset(r);
+        // A^0 is the identity, so start from 1
+        for (idx i = 1; i < ix.d; ++i)
+            for (auto&& elem : ph[i])
+                psi(rest + elem.first) *= elem.second;
+    }
+}
+
+template<typename Derived>
+void apply_ctrl_ket_diag_inplace(
+        Eigen::MatrixBase<Derived>& psi,
+        const std::vector<dyn_mat<typename Derived::Scalar>>& Ai,
+        const QubitGateIndex& ix)
+{
+    using Scalar = typename Derived::Scalar;
+
+    // bit masks and phases of the non-trivial diagonal elements
+    std::vector<std::pair<idx, Scalar>> ph;
+    for (idx m = 0; m < ix.DA; ++m)
+        if (Ai[1](m, m) != Scalar(1))
+            ph.emplace_back(ix.offA[m], Ai[1](m, m));
+
+    // no control nor target qubits, the 1 x 1 gate is a global phase
+    if (ix.Dfree == ix.D)
+    {
+        for (auto&& elem : ph)
+            psi *= elem.second;
+        return;
+    }
+
+    // the qubits below the lowest control or target are free, hence the
+    // amplitudes come in contiguous runs
+    const idx p = ix.min_fixed_pos();
+    const idx run = static_cast<idx>(1) << p;
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx j = 0; j < (ix.Dfree >> p); ++j)
+    {
+        idx base = ix.active_base(j << p);
+        for (auto&& elem : ph)
+            psi.block(base | elem.first, 0, run, 1) *= elem.second;
+    }
+}
+
+// rho -> P rho P^dagger in-place, for the diagonal matrix P = diag(p), in a
+// single pass over rho
+template<typename Derived>
+void apply_diag_rho_inplace(
+        Eigen::MatrixBase<Derived>& rho,
+        const dyn_col_vect<typename Derived::Scalar>& p)
+{
+    const idx D = static_cast<idx>(rho.rows());
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx c = 0; c < D; ++c)
+        rho.col(c) = Eigen::numext::conj(p(c)) * p.cwiseProduct(rho.col(c));
+}
+
+// multiplies in-place every amplitude psi(i) of the ket psi by the product,
+// over the factors f, of phases[f](m_f), where m_f is the index of the basis
+// state i restricted to the subsystems subsys[f] (sorted), in a single pass
+// over psi; the subsystems up to the last one acted upon are split into high
+// and low ones, the latter spanning at most 1024 basis states, and the local
+// indexes m_f, which are sums of a high part and a low part, are precomputed
+// for all the low basis states, so that each block of amplitudes sharing the
+// same high part is multiplied by a table of phases computed once per block
+template<typename Derived>
+void apply_phases_ket_inplace(
+        Eigen::MatrixBase<Derived>& psi, const std::vector<idx>& dims,
+        const std::vector<std::vector<idx>>& subsys,
+        const std::vector<dyn_col_vect<typename Derived::Scalar>>& phases)
+{
+    using Scalar = typename Derived::Scalar;
+    const idx nf = subsys.size();
+    if (nf == 0)
+        return;
+
+    // the leading subsystems, up to the last one acted upon; the amplitudes
+    // of the trailing ones come in runs that share the same phase
+    idx nlead = 0;
+    for (auto&& s : subsys)
+        nlead = std::max(nlead, s.back() + 1);
+    idx run = 1;
+    for (idx k = nlead; k < dims.size(); ++k)
+        run *= dims[k];
+
+    // high subsystems [0, h), low subsystems [h, nlead)
+    idx h = nlead - 1;
+    idx Dlo = dims[h];
+    while (h > 0 && Dlo * dims[h - 1] <= 1024)
+        Dlo *= dims[--h];
+    const idx Dhi = static_cast<idx>(psi.rows()) / (Dlo * run);
+
+    // 0: high subsystems only, 1: low subsystems only, 2: both
+    std::vector<idx> kind(nf);
+    for (idx f = 0; f < nf; ++f)
+        kind[f] = subsys[f].front() >= h ? 1 : (subsys[f].back() < h ? 0 : 2);
+
+    // low parts of the local indexes, and product of the low factors
+    std::vector<std::vector<idx>> lo_part(nf);
+    dyn_col_vect<Scalar> lo_table = dyn_col_vect<Scalar>::Ones(Dlo);
+    for (idx f = 0; f < nf; ++f)
+        if (kind[f] == 2)
+            lo_part[f].resize(Dlo);
+    idx midx[maxn];
+    for (idx l = 0; l < Dlo; ++l)
+    {
+        n2multiidx(l, nlead - h, dims.data() + h, midx + h);
+        for (idx f = 0; f < nf; ++f)
+        {
+            if (kind[f] == 0)
+                continue;
+            idx m = 0, stride = 1;
+            for (idx j = subsys[f].size(); j-- > 0;)
+            {
+                idx k = subsys[f][j];
+                if (k >= h)
+                    m += midx[k] * stride;
+                stride *= dims[k];
+            }
+            if (kind[f] == 1)
+                lo_table(l) *= phases[f](m);
+            else
+                lo_part[f][l] = m;
+        }
+    }
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        dyn_col_vect<Scalar> v(Dlo); // thread-local buffer
+        idx hidx[maxn];
+
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx hi = 0; hi < Dhi; ++hi)
+        {
+            n2multiidx(hi, h, dims.data(), hidx);
+            Scalar c = 1;
+            v = lo_table;
+            for (idx f = 0; f < nf; ++f)
+            {
+                if (kind[f] == 1)
+                    continue;
+                // high part of the local index
+                idx m = 0, stride = 1;
+                for (idx j = subsys[f].size(); j-- > 0;)
+                {
+                    idx k = subsys[f][j];
+                    if (k < h)
+                        m += hidx[k] * stride;
+                    stride *= dims[k];
+                }
+                if (kind[f] == 0)
+                    c *= phases[f](m);
+                else
+                    for (idx l = 0; l < Dlo; ++l)
+                        v(l) *= phases[f](m + lo_part[f][l]);
+            }
+            if (c != Scalar(1))
+                v *= c;
+
+            const idx base = hi * Dlo * run;
+            if (run == 1)
+                psi.block(base, 0, Dlo, 1).array() *= v.array();
+            else
+                for (idx l = 0; l < Dlo; ++l)
+                    psi.block(base + l * run, 0, run, 1) *= v(l);
+        }
+    }
+}
+
+// applies in-place the controlled diagonal gate to the ket or density matrix
+// state, Ai[i] is the power of the gate applied when all controls are equal
+// to i; density matrices are multiplied on both sides by the diagonal of the
+// controlled gate
+template<typename Derived>
+void apply_ctrl_diag_inplace(
+        Eigen::MatrixBase<Derived>& state,
+        const std::vector<dyn_mat<typename Derived::Scalar>>& Ai,
+        const std::vector<idx>& ctrl,
+        const std::vector<idx>& subsys,
+        const std::vector<idx>& dims)
+{
+    using Scalar = typename Derived::Scalar;
+
+    if (!check_cvector(state))
+    {
+        dyn_col_vect<Scalar> p = dyn_col_vect<Scalar>::Ones(state.rows());
+        apply_ctrl_diag_inplace(p, Ai, ctrl, subsys, dims);
+        apply_diag_rho_inplace(state, p);
+        return;
+    }
+
+    if (check_eq_dims(dims, 2)) // qubits only
+        apply_ctrl_ket_diag_inplace(state, Ai,
+                                    QubitGateIndex(ctrl, subsys, dims.size()));
+    else
+        apply_ctrl_ket_diag_inplace(state, Ai,
+                                    CtrlGateIndex(ctrl, subsys, dims));
+}
+
+// cycles of the permutation perm, each cycle listing m, perm[m],
+// perm[perm[m]], ...; the fixed points m with phases[m] = 1 are omitted
+template<typename Scalar>
+std::vector<std::vector<idx>> monomial_cycles(const std::vector<idx>& perm,
+                                              const std::vector<Scalar>& phases)
+{
+    std::vector<std::vector<idx>> result;
+    std::vector<bool> visited(perm.size(), false);
+    for (idx m = 0; m < perm.size(); ++m)
+    {
+        if (visited[m] || (perm[m] == m && phases[m] == Scalar(1)))
+            continue;
+        std::vector<idx> cycle;
+        for (idx k = m; !visited[k]; k = perm[k])
+        {
+            visited[k] = true;
+            cycle.push_back(k);
+        }
+        result.push_back(std::move(cycle));
+    }
+
+    return result;
+}
+
+// permutation and phases of the monomial matrix A,
+// A|m> = phases[m] |perm[m]>
+template<typename Scalar>
+void monomial_decompose(const dyn_mat<Scalar>& A, std::vector<idx>& perm,
+                        std::vector<Scalar>& phases)
+{
+    const idx D = static_cast<idx>(A.rows());
+    perm.resize(D);
+    phases.resize(D);
+    for (idx m = 0; m < D; ++m)
+        for (idx i = 0; i < D; ++i)
+            if (A(i, m) != Scalar(0))
+            {
+                perm[m] = i;
+                phases[m] = A(i, m);
+            }
+}
+
+// applies in-place the monomial gate with the given cycles and phases to the
+// amplitudes psi(base + off[m]), psi(base + off[perm[m]]) <- phases[m] *
+// psi(base + off[m]), by following the cycles with a single carried value
+template<typename Derived>
+void apply_monomial_block(Eigen::MatrixBase<Derived>& psi, idx base,
+                          const std::vector<idx>& off,
+                          const std::vector<std::vector<idx>>& cycles,
+                          const std::vector<typename Derived::Scalar>& phases)
+{
+    using Scalar = typename Derived::Scalar;
+
+    for (auto&& cycle : cycles)
+    {
+        const idx len = cycle.size();
+        Scalar x = psi(base + off[cycle[0]]);
+        for (idx t = 0; t < len; ++t)
+        {
+            idx next = base + off[cycle[t + 1 < len ? t + 1 : 0]];
+            Scalar y = psi(next);
+            psi(next) = phases[cycle[t]] * x;
+            x = y;
+        }
+    }
+}
+
+// blocks of amplitudes acted upon by the controlled gate described by ix,
+// block b has the global offset block_base(ix, b, power) and is acted upon
+// by the gate to the power power
+inline idx num_blocks(const CtrlGateIndex& ix) noexcept
+{
+    return ix.Drest * (ix.d - 1);
+}
+
+inline idx block_base(const CtrlGateIndex& ix, idx b, idx& power) noexcept
+{
+    power = 1 + b % (ix.d - 1);
+    return ix.rest_offset(b / (ix.d - 1)) + power * ix.ctrl_diag;
+}
+
+inline idx num_blocks(const QubitGateIndex& ix) noexcept
+{
+    return ix.Dfree;
+}
+
+inline idx block_base(const QubitGateIndex& ix, idx b, idx& power) noexcept
+{
+    power = 1;
+    return ix.active_base(b);
+}
+
+// applies in-place the controlled monomial gate described by ix to the ket
+// psi, cycles[i] and phases[i] describe the power of the gate applied when
+// all controls are equal to i; the amplitudes are only moved around
+template<typename Derived, typename GateIndex>
+void apply_monomial_ket_inplace(
+        Eigen::MatrixBase<Derived>& psi,
+        const std::vector<std::vector<std::vector<idx>>>& cycles,
+        const std::vector<std::vector<typename Derived::Scalar>>& phases,
+        const GateIndex& ix)
+{
+    const idx nblocks = num_blocks(ix);
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx b = 0; b < nblocks; ++b)
+    {
+        idx power;
+        idx base = block_base(ix, b, power);
+        apply_monomial_block(psi, base, ix.offA, cycles[power],
+                             phases[power]);
+    }
+}
+
+// applies in-place the controlled monomial gate described by ix to the
+// density matrix rho, i.e. rho -> C rho C^dagger, as a permutation of the
+// entries of each column (rho -> C rho) followed by a permutation of whole
+// columns (rho -> rho C^dagger), so that all moves are along columns
+template<typename Derived, typename GateIndex>
+void apply_monomial_rho_inplace(
+        Eigen::MatrixBase<Derived>& rho,
+        const std::vector<std::vector<std::vector<idx>>>& cycles,
+        const std::vector<std::vector<typename Derived::Scalar>>& phases,
+        const GateIndex& ix)
+{
+    using Scalar = typename Derived::Scalar;
+
+    const idx D = static_cast<idx>(rho.rows());
+    const idx nblocks = num_blocks(ix);
+
+    // rho -> C rho
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx c = 0; c < D; ++c)
+    {
+        auto col = rho.col(c);
+        for (idx b = 0; b < nblocks; ++b)
+        {
+            idx power;
+            idx base = block_base(ix, b, power);
+            apply_monomial_block(col, base, ix.offA, cycles[power],
+                                 phases[power]);
+        }
+    }
+
+    // rho -> rho C^dagger, column base + off[perm[m]] <- conj(phases[m]) *
+    // column base + off[m]
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        dyn_col_vect<Scalar> x(D), y(D);
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx b = 0; b < nblocks; ++b)
+        {
+            idx power;
+            idx base = block_base(ix, b, power);
+            for (auto&& cycle : cycles[power])
+            {
+                const idx len = cycle.size();
+                x = rho.col(base + ix.offA[cycle[0]]);
+                for (idx t = 0; t < len; ++t)
+                {
+                    idx next = base + ix.offA[cycle[t + 1 < len ? t + 1 : 0]];
+                    y = rho.col(next);
+                    rho.col(next) =
+                            Eigen::numext::conj(phases[power][cycle[t]]) * x;
+                    x.swap(y);
+                }
+            }
+        }
+    }
+}
+
+// applies in-place the controlled monomial gate to the ket or density matrix
+// state, cycles[i] and phases[i] describe the power of the gate applied when
+// all controls are equal to i
+template<typename Derived>
+void apply_monomial_inplace(
+        Eigen::MatrixBase<Derived>& state,
+        const std::vector<std::vector<std::vector<idx>>>& cycles,
+        const std::vector<std::vector<typename Derived::Scalar>>& phases,
+        const std::vector<idx>& ctrl,
+        const std::vector<idx>& subsys,
+        const std::vector<idx>& dims)
+{
+    if (check_eq_dims(dims, 2)) // qubits only
+    {
+        QubitGateIndex ix(ctrl, subsys, dims.size());
+        if (check_cvector(state))
+            apply_monomial_ket_inplace(state, cycles, phases, ix);
+        else
+            apply_monomial_rho_inplace(state, cycles, phases, ix);
+    } else
+    {
+        CtrlGateIndex ix(ctrl, subsys, dims);
+        if (check_cvector(state))
+            apply_monomial_ket_inplace(state, cycles, phases, ix);
+        else
+            apply_monomial_rho_inplace(state, cycles, phases, ix);
+    }
+}
+
+// applies in-place the controlled monomial gate to the ket or density matrix
+// state, Ai[i] is the power of the gate applied when all controls are equal
+// to i
+template<typename Derived>
+void apply_ctrl_monomial_inplace(
+        Eigen::MatrixBase<Derived>& state,
+        const std::vector<dyn_mat<typename Derived::Scalar>>& Ai,
+        const std::vector<idx>& ctrl,
+        const std::vector<idx>& subsys,
+        const std::vector<idx>& dims)
+{
+    using Scalar = typename Derived::Scalar;
+
+    std::vector<std::vector<std::vector<idx>>> cycles(Ai.size());
+    std::vector<std::vector<Scalar>> phases(Ai.size());
+    std::vector<idx> perm;
+    // A^0 is the identity, so start from 1
+    for (idx i = 1; i < Ai.size(); ++i)
+    {
+        monomial_decompose(Ai[i], perm, phases[i]);
+        cycles[i] = monomial_cycles(perm, phases[i]);
+    }
+
+    apply_monomial_inplace(state, cycles, phases, ctrl, subsys, dims);
+}
+
+// applies in-place the controlled gate to the ket or density matrix state,
+// Ai[i] is the power of the gate applied when all controls are equal to i;
+// diagonal and monomial gates use the phase and permutation kernels, and
+// systems made only of qubits use the bit-mask kernels
+// no error checks, the inputs are assumed to be valid
+template<typename Derived>
+void apply_ctrl_inplace(
+        Eigen::MatrixBase<Derived>& state,
+        const std::vector<dyn_mat<typename Derived::Scalar>>& Ai,
+        const std::vector<idx>& ctrl,
+        const std::vector<idx>& subsys,
+        const std::vector<idx>& dims)
+{
+    // diagonal gates (e.g. Z, S, T, CZ) only rescale the amplitudes
+    if (check_diagonal(Ai[1]))
+    {
+        apply_ctrl_diag_inplace(state, Ai, ctrl, subsys, dims);
+        return;
+    }
+
+    // monomial gates (e.g. CNOT, SWAP, TOF, FRED) only move the amplitudes;
+    // the dedicated (vectorized) kernels are faster for 1- and 2-qubit gates
+    // acting on kets and for 1-qubit gates acting on density matrices
+    bool small_qubit_gate =
+            check_eq_dims(dims, 2) &&
+            subsys.size() <= (check_cvector(state) ? 2u : 1u);
+    if (!small_qubit_gate && check_monomial(Ai[1]))
+    {
+        apply_ctrl_monomial_inplace(state, Ai, ctrl, subsys, dims);
+        return;
+    }
+
+    //************ ket ************//
+    if (check_cvector(state))
+    {
+        if (check_eq_dims(dims, 2)) // qubits only
+            apply_ctrl_ket_qubits_inplace(state, Ai[1],
+                                          QubitGateIndex(ctrl, subsys,
+                                                         dims.size()));
+        else
+            apply_ctrl_ket_inplace(state, Ai,
+                                   CtrlGateIndex(ctrl, subsys, dims));
+        return;
+    }
+
+    //************ density matrix ************//
+    if (check_eq_dims(dims, 2) && subsys.size() == 1) // 1-qubit gate
+    {
+        apply_ctrl_rho_qubit_inplace(state, Ai[1],
+                                     QubitGateIndex(ctrl, subsys,
+                                                    dims.size()));
+        return;
+    }
+
+    // low[c] is the index c with the gate part set to 0
+    std::vector<idx> subsys_bar;
+    for (idx i = 0; i < dims.size(); ++i)
+        if (std::find(std::begin(subsys), std::end(subsys), i) ==
+            std::end(subsys))
+            subsys_bar.push_back(i);
+    std::vector<idx> ob = get_subsys_offsets(subsys_bar, dims);
+    std::vector<idx> os = get_subsys_offsets(subsys, dims);
+    std::vector<idx> low(static_cast<idx>(state.rows()));
+    for (auto&& b : ob)
+        for (auto&& s : os)
+            low[b + s] = b;
+
+    if (check_eq_dims(dims, 2)) // qubits only
+        apply_ctrl_rho_inplace(state, Ai,
+                               QubitGateIndex(ctrl, subsys, dims.size()), low);
+    else
+        apply_ctrl_rho_inplace(state, Ai, CtrlGateIndex(ctrl, subsys, dims),
+                               low);
+}
+
+// sparse gates are stored row-major, so that their products with dense
+// vectors are gathers (and are parallelized by Eigen)
+template<typename Scalar>
+using sp_gate = Eigen::SparseMatrix<Scalar, Eigen::RowMajor>;
+
+// table of powers A^i of the sparse gate A, i = 0, ..., n - 1
+template<typename Scalar, typename Derived>
+std::vector<sp_gate<Scalar>>
+sparse_gate_powers(const Eigen::SparseMatrixBase<Derived>& A, idx n)
+{
+    std::vector<sp_gate<Scalar>> result;
+    result.reserve(n);
+    sp_gate<Scalar> Id(A.rows(), A.cols());
+    Id.setIdentity();
+    result.push_back(std::move(Id));
+    for (idx i = 1; i < n; ++i)
+    {
+        sp_gate<Scalar> next = result.back() * A.derived();
+        result.push_back(std::move(next));
+    }
+
+    return result;
+}
+
+// applies in-place the sparse gate A to the amplitudes psi(base + off[m]),
+// gathered in the buffer in and scattered back from the buffer out, in
+// O(nnz(A)) operations
+template<typename Derived, typename Scalar>
+void apply_sparse_block(Eigen::MatrixBase<Derived>& psi, idx base,
+                        const std::vector<idx>& off,
+                        const sp_gate<Scalar>& A,
+                        dyn_col_vect<Scalar>& in, dyn_col_vect<Scalar>& out)
+{
+    const idx DA = off.size();
+    for (idx m = 0; m < DA; ++m)
+        in(m) = psi(base + off[m]);
+    out.noalias() = A * in;
+    for (idx m = 0; m < DA; ++m)
+        psi(base + off[m]) = out(m);
+}
+
+// applies in-place the controlled sparse gate described by ix to the ket psi,
+// Ai[i] is the power of the gate applied when all controls are equal to i
+template<typename Derived, typename GateIndex>
+void apply_sparse_ket_inplace(
+        Eigen::MatrixBase<Derived>& psi,
+        const std::vector<sp_gate<typename Derived::Scalar>>& Ai,
+        const GateIndex& ix)
+{
+    using Scalar = typename Derived::Scalar;
+
+    const idx nblocks = num_blocks(ix);
+
+    // a gate on the whole system, the (parallel) sparse product of Eigen
+    if (nblocks == 1)
+    {
+        dyn_col_vect<Scalar> in(ix.DA), out(ix.DA);
+        idx power;
+        idx base = block_base(ix, 0, power);
+        apply_sparse_block(psi, base, ix.offA, Ai[power], in, out);
+        return;
+    }
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        dyn_col_vect<Scalar> in(ix.DA), out(ix.DA);
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx b = 0; b < nblocks; ++b)
+        {
+            idx power;
+            idx base = block_base(ix, b, power);
+            apply_sparse_block(psi, base, ix.offA, Ai[power], in, out);
+        }
+    }
+}
+
+// applies in-place the controlled sparse gate described by ix to the density
+// matrix rho, i.e. rho -> C rho C^dagger, as rho -> C rho column by column,
+// followed by rho -> rho C^dagger on strips of rows, each block of columns
+// of a strip being gathered, multiplied by the adjoint of the gate and
+// scattered back
+template<typename Derived, typename GateIndex>
+void apply_sparse_rho_inplace(
+        Eigen::MatrixBase<Derived>& rho,
+        const std::vector<sp_gate<typename Derived::Scalar>>& Ai,
+        const GateIndex& ix)
+{
+    using Scalar = typename Derived::Scalar;
+
+    const idx D = static_cast<idx>(rho.rows());
+    const idx DA = ix.DA;
+    const idx nblocks = num_blocks(ix);
+
+    // rho -> C rho
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        dyn_col_vect<Scalar> in(DA), out(DA);
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx c = 0; c < D; ++c)
+        {
+            auto col = rho.col(c);
+            for (idx b = 0; b < nblocks; ++b)
+            {
+                idx power;
+                idx base = block_base(ix, b, power);
+                apply_sparse_block(col, base, ix.offA, Ai[power], in, out);
+            }
+        }
+    }
+
+    // rho -> rho C^dagger, on strips of R rows
+    const idx R = 16;
+    const idx nstrips = (D + R - 1) / R;
+#ifdef WITH_OPENMP_
+#pragma omp parallel
+#endif // WITH_OPENMP_
+    {
+        dyn_mat<Scalar> in(R, DA), out(R, DA);
+#ifdef WITH_OPENMP_
+#pragma omp for
+#endif // WITH_OPENMP_
+        for (idx s = 0; s < nstrips; ++s)
+        {
+            const idx r0 = s * R;
+            const idx nr = std::min(R, D - r0);
+            for (idx b = 0; b < nblocks; ++b)
+            {
+                idx power;
+                idx base = block_base(ix, b, power);
+                for (idx m = 0; m < DA; ++m)
+                    in.col(m).head(nr) = rho.col(base + ix.offA[m])
+                            .segment(r0, nr);
+                out.noalias() = in * Ai[power].adjoint();
+                for (idx m = 0; m < DA; ++m)
+                    rho.col(base + ix.offA[m]).segment(r0, nr) =
+                            out.col(m).head(nr);
+            }
+        }
+    }
+}
+
+// applies in-place the controlled sparse gate to the ket or density matrix
+// state, Ai[i] is the power of the gate applied when all controls are equal
+// to i; the gate is applied block by block in O(nnz) operations per block,
+// and is never densified
+// no error checks, the inputs are assumed to be valid
+template<typename Derived>
+void apply_ctrl_sparse_inplace(
+        Eigen::MatrixBase<Derived>& state,
+        const std::vector<sp_gate<typename Derived::Scalar>>& Ai,
+        const std::vector<idx>& ctrl,
+        const std::vector<idx>& subsys,
+        const std::vector<idx>& dims)
+{
+    if (check_eq_dims(dims, 2)) // qubits only
+    {
+        QubitGateIndex ix(ctrl, subsys, dims.size());
+        if (check_cvector(state))
+            apply_sparse_ket_inplace(state, Ai, ix);
+        else
+            apply_sparse_rho_inplace(state, Ai, ix);
+    } else
+    {
+        CtrlGateIndex ix(ctrl, subsys, dims);
+        if (check_cvector(state))
+            apply_sparse_ket_inplace(state, Ai, ix);
+        else
+            apply_sparse_rho_inplace(state, Ai, ix);
+    }
+}
+
+// applies in-place the 1 x 1 gate A acting on no subsystems (a global phase)
+// to the ket or density matrix state
+// no error checks, the inputs are assumed to be valid
+template<typename Derived1, typename Derived2>
+void apply_phase_inplace(Eigen::MatrixBase<Derived1>& state,
+                         const Eigen::EigenBase<Derived2>& A)
+{
+    using Scalar = typename Derived1::Scalar;
+
+    const Scalar phase = dyn_mat<Scalar>(A.derived())(0, 0);
+    if (check_cvector(state))
+        state *= phase;
+    else
+        state *= phase * std::conj(phase);
+}
+
+// applies in-place the controlled gate A to the ket or density matrix state,
+// d is the dimension of the control subsystems; dense gates (and any other
+// Eigen expression) are evaluated once and use the dense kernels
+// no error checks, the inputs are assumed to be valid
+template<typename Derived1, typename Derived2>
+void apply_ctrl_gate_inplace(Eigen::MatrixBase<Derived1>& state,
+                             const Eigen::EigenBase<Derived2>& A, idx d,
+                             const std::vector<idx>& ctrl,
+                             const std::vector<idx>& subsys,
+                             const std::vector<idx>& dims)
+{
+    using Scalar = typename Derived1::Scalar;
+
+    const dyn_mat<Scalar>& rA = A.derived();
+    // table of powers A^i, A^i is applied when all controls are equal to i
+    std::vector<dyn_mat<Scalar>> Ai =
+            gate_powers<Scalar>(rA, std::max(d, static_cast<idx>(2)));
+
+    apply_ctrl_inplace(state, Ai, ctrl, subsys, dims);
+}
+
+// applies in-place the controlled gate A to the ket or density matrix state,
+// d is the dimension of the control subsystems; sparse gates use the sparse
+// kernels
+// no error checks, the inputs are assumed to be valid
+template<typename Derived1, typename Derived2>
+void apply_ctrl_gate_inplace(Eigen::MatrixBase<Derived1>& state,
+                             const Eigen::SparseMatrixBase<Derived2>& A,
+                             idx d, const std::vector<idx>& ctrl,
+                             const std::vector<idx>& subsys,
+                             const std::vector<idx>& dims)
+{
+    using Scalar = typename Derived1::Scalar;
+
+    // table of powers A^i, A^i is applied when all controls are equal to i
+    std::vector<sp_gate<Scalar>> Ai = sparse_gate_powers<Scalar>(
+            A, std::max(d, static_cast<idx>(2)));
+
+    apply_ctrl_sparse_inplace(state, Ai, ctrl, subsys, dims);
+}
+
+// matrix of the controlled gate described by ix, Ai[i] is the power of the
+// gate applied when all controls are equal to i; the identity is written
+// first, then each block acted upon is overwritten by its power of the gate,
+// in O(D^2 + D * DA) operations (the blocks are disjoint)
+template<typename Scalar>
+dyn_mat<Scalar> ctrl_gate_to_dense(const std::vector<dyn_mat<Scalar>>& Ai,
+                                   const CtrlGateIndex& ix)
+{
+    dyn_mat<Scalar> result = dyn_mat<Scalar>::Identity(ix.D, ix.D);
+    const idx nblocks = num_blocks(ix);
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx b = 0; b < nblocks; ++b)
+    {
+        idx power;
+        idx base = block_base(ix, b, power);
+        for (idx j = 0; j < ix.DA; ++j)
+            for (idx i = 0; i < ix.DA; ++i)
+                result(base + ix.offA[i], base + ix.offA[j]) =
+                        Ai[power](i, j);
+    }
+
+    return result;
+}
+
+} /* namespace internal */
+} /* namespace qpp */
+
+#endif /* INTERNAL_KERNELS_H_ */
@@ -0,0 +1,224 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file internal/krylov.h
+* \brief Internal Krylov subspace action of the matrix exponential
+*/
+
+#ifndef INTERNAL_KRYLOV_H_
+#define INTERNAL_KRYLOV_H_
+
+namespace qpp
+{
+namespace internal
+{
+// exponential of the small dense square matrix H, by the diagonal Pade
+// approximant of degree p with scaling and squaring
+inline cmat expm_pade(const cmat& H, idx p = 6)
+{
+    const idx n = static_cast<idx>(H.rows());
+    const cmat I = cmat::Identity(n, n);
+
+    // Pade coefficients
+    std::vector<double> c(p + 1);
+    c[0] = 1;
+    for (idx k = 1; k <= p; ++k)
+        c[k] = c[k - 1] * static_cast<double>(p + 1 - k) /
+               static_cast<double>(k * (2 * p + 1 - k));
+
+    // scale so that the infinity norm is at most 1/2
+    double nrm = H.cwiseAbs().rowwise().sum().maxCoeff();
+    idx s = 0;
+    if (nrm > 0.5)
+        s = static_cast<idx>(std::max(0., std::floor(std::log2(nrm)) + 2));
+    cmat A = H / std::pow(2., static_cast<double>(s));
+
+    // Horner evaluation of the even and odd parts
+    cmat A2 = A * A;
+    cmat Q = c[p] * I;
+    cmat P = c[p - 1] * I;
+    bool odd = true;
+    for (idx k = p - 1; k > 0; --k)
+    {
+        if (odd)
+            Q = Q * A2 + c[k - 1] * I;
+        else
+            P = P * A2 + c[k - 1] * I;
+        odd = !odd;
+    }
+    cmat E;
+    if (odd)
+    {
+        Q = Q * A;
+        Q -= P;
+        E = -(I + 2. * Q.partialPivLu().solve(P));
+    } else
+    {
+        P = P * A;
+        Q -= P;
+        E = I + 2. * Q.partialPivLu().solve(P);
+    }
+
+    // undo the scaling by repeated squaring
+    for (idx k = 0; k < s; ++k)
+        E = E * E;
+
+    return E;
+}
+
+// exp(t A) v for the operator A given by the callable op, op(w) = A w, by
+// Krylov (Arnoldi) projections of dimension at most m with the adaptive time
+// stepping and the local error estimates of Expokit's expv (R. B. Sidje, ACM
+// Trans. Math. Softw. 24, 130 (1998)), up to the absolute tolerance tol per
+// unit time; anorm is (an estimate of) the infinity norm of A, which only
+// sets the first time step
+// no error checks, the inputs are assumed to be valid; throws if tol is
+// below the rounding errors or if a step is rejected too many times
+template<typename Op>
+ket krylov_expv(const Op& op, const ket& v, cplx t, double tol, double anorm,
+                idx m = 30)
+{
+    const idx D = static_cast<idx>(v.rows());
+    const double t_out = std::abs(t);
+    const double beta0 = v.norm();
+    if (t_out == 0 || beta0 == 0)
+        return v;
+
+    // as in Expokit, the tolerance cannot be below the rounding errors
+    if (tol < std::numeric_limits<double>::epsilon() * beta0)
+        throw exception::CustomException(
+                "qpp::expmv()", "Requested tolerance is too high!");
+
+    // exp(t A) = exp(|t| phase A), the time runs along |t|
+    const cplx phase = t / t_out;
+    auto apply = [&](const ket& w) -> ket
+    { return phase * ket(op(w)); };
+
+    m = std::min(m, D);
+    if (anorm <= 0)
+        anorm = 1;
+    const double btol = tol * anorm; // happy breakdown threshold
+    const double gamma = 0.9;        // step size safety factors
+    const double delta = 1.2;
+    // rounds a step to 2 significant digits
+    auto round_step = [](double step)
+    {
+        double s = std::pow(10., std::floor(std::log10(step)) - 1);
+        return std::ceil(step / s) * s;
+    };
+
+    double beta = beta0;
+    double fact = std::pow((m + 1) / std::exp(1.), m + 1) *
+                  std::sqrt(2 * pi * (m + 1));
+    double t_new = round_step((1 / anorm) *
+                              std::pow((fact * tol) / (4 * beta * anorm),
+                                       1. / m));
+    double t_now = 0;
+    ket w = v;
+    cmat V(D, m + 1);
+
+    while (t_now < t_out)
+    {
+        double t_step = std::min(t_out - t_now, t_new);
+
+        // Arnoldi process, modified Gram-Schmidt
+        cmat H = cmat::Zero(m + 2, m + 2);
+        V.col(0) = w / beta;
+        idx mb = m;        // dimension of the Krylov subspace
+        bool breakdown = false;
+        double avnorm = 0;
+        for (idx j = 0; j < m; ++j)
+        {
+            ket p = apply(V.col(j));
+            for (idx i = 0; i <= j; ++i)
+            {
+                H(i, j) = V.col(i).dot(p);
+                p -= H(i, j) * V.col(i);
+            }
+            double s = p.norm();
+            if (s < btol) // invariant subspace, the projection is exact
+            {
+                breakdown = true;
+                mb = j + 1;
+                t_step = t_out - t_now;
+                break;
+            }
+            H(j + 1, j) = s;
+            V.col(j + 1) = p / s;
+        }
+        if (!breakdown)
+        {
+            H(m + 1, m) = 1;
+            avnorm = apply(V.col(m)).norm();
+        }
+
+        // exponential of the projection, with step size control
+        cmat F;
+        double err_loc = btol;
+        double xm = 1. / m;
+        for (idx ireject = 0; ; ++ireject)
+        {
+            idx mx = breakdown ? mb : m + 2;
+            F = expm_pade(t_step * H.topLeftCorner(mx, mx));
+            if (breakdown)
+                break;
+
+            // local error estimate
+            double phi1 = std::abs(beta * F(m, 0));
+            double phi2 = std::abs(beta * F(m + 1, 0) * avnorm);
+            xm = 1. / m;
+            if (phi1 > 10 * phi2)
+                err_loc = phi2;
+            else if (phi1 > phi2)
+                err_loc = (phi1 * phi2) / (phi1 - phi2);
+            else
+            {
+                err_loc = phi1;
+                xm = m > 1 ? 1. / (m - 1) : 1.;
+            }
+            if (err_loc <= delta * t_step * tol)
+                break;
+            // as in Expokit, give up after 10 rejected steps
+            if (ireject >= 10)
+                throw exception::CustomException(
+                        "qpp::expmv()", "Requested tolerance is too high!");
+            t_step = round_step(gamma * t_step *
+                                std::pow(t_step * tol / err_loc, xm));
+        }
+
+        // w = beta V exp(t_step H) e_1
+        idx mx = breakdown ? mb : m + 1;
+        w = V.leftCols(mx) * (beta * F.col(0).head(mx));
+        beta = w.norm();
+        t_now += t_step;
+        t_new = round_step(gamma * t_step *
+                           std::pow(t_step * tol / std::max(err_loc, 1e-300),
+                                    xm));
+    }
+
+    return w;
+}
+
+} /* namespace internal */
+} /* namespace qpp */
+
+#endif /* INTERNAL_KRYLOV_H_ */
@@ -0,0 +1,155 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file internal/randomized_svd.h
+* \brief Internal truncated SVD by randomized range finding
+*/
+
+#ifndef INTERNAL_RANDOMIZED_SVD_H_
+#define INTERNAL_RANDOMIZED_SVD_H_
+
+namespace qpp
+{
+namespace internal
+{
+// orthonormal basis of the column space of the tall matrix Y, of the same
+// size as Y
+inline cmat orth(const cmat& Y)
+{
+    Eigen::HouseholderQR<cmat> qr(Y);
+
+    return qr.householderQ() * cmat::Identity(Y.rows(), Y.cols());
+}
+
+// leading singular triplets of M, M ~ U diag(s) V^dagger, with the singular
+// values s_i > tol and at most rank of them (rank = 0 means no cap), by
+// randomized range finding with oversampling (N. Halko, P. G. Martinsson,
+// J. A. Tropp, SIAM Rev. 53, 217 (2011)); the sketch size is doubled until
+// the singular values drop below tol or the cap is reached. Power
+// iterations refine the sketch until the residuals |M v_i - s_i u_i| of the
+// kept triplets drop below res_tol times the largest singular value, which
+// is fast for spectra that decay after the kept values; when that takes
+// more operations than a full SVD would, e.g. for flat spectra, the full
+// SVD is computed instead, with the singular vectors only if compute_uv is
+// true (otherwise U and V are returned empty)
+// always returns at least one singular value
+// no error checks, the inputs are assumed to be valid
+inline std::tuple<cmat, dyn_col_vect<double>, cmat>
+randomized_svd(const cmat& M, idx rank, double tol, std::mt19937& gen,
+               bool compute_uv = true, double res_tol = 1e-10,
+               idx oversampling = 10)
+{
+    const idx m = static_cast<idx>(M.rows());
+    const idx n = static_cast<idx>(M.cols());
+    const idx mn = std::min(m, n);
+    if (rank == 0 || rank > mn)
+        rank = mn;
+
+    // number of leading singular values > tol, at most the cap
+    auto count_kept = [rank, tol](const dyn_col_vect<double>& s) -> idx
+    {
+        idx result = 0;
+        idx max = std::min(rank, static_cast<idx>(s.rows()));
+        while (result < max && s(result) > tol)
+            ++result;
+        return std::max(result, static_cast<idx>(1));
+    };
+
+    std::normal_distribution<> nd;
+    idx l = std::min(std::min(rank, static_cast<idx>(16)) + oversampling, mn);
+    // an iteration on a sketch of size l costs about 4 l / mn of a full
+    // SVD (two passes over M with a thin, memory bound, matrix product),
+    // the iterations are stopped once their total cost exceeds about half
+    // of it
+    idx spent = 0;
+    while (8 * spent < mn)
+    {
+        // complex Gaussian test matrix
+        cmat Omega(n, l);
+        for (idx j = 0; j < l; ++j)
+            for (idx i = 0; i < n; ++i)
+                Omega(i, j) = cplx{nd(gen), nd(gen)};
+
+        // range finder, the projection B = Q^dagger M is decomposed exactly
+        // and Q is refined by power iterations, re-orthonormalized each
+        // time; each iteration costs two passes over M
+        cmat Q = orth(M * Omega);
+        while (8 * spent < mn)
+        {
+            spent += l;
+            cmat B = Q.adjoint() * M;
+            Eigen::JacobiSVD<cmat> sv(B, Eigen::ComputeThinU |
+                                         Eigen::ComputeThinV);
+            const dyn_col_vect<double>& s = sv.singularValues();
+            idx kept = count_kept(s);
+
+            // unless the tail below tol was found within the oversampled
+            // sketch, or the cap was reached with enough oversampling, the
+            // sketch is enlarged right away, as the estimates s_i only
+            // increase with the iterations
+            if (!((kept < rank && kept + oversampling <= l) ||
+                  (kept == rank && l >= rank + oversampling)))
+                break;
+
+            // next power iteration, M Z with Z spanning the row space of B,
+            // which also contains the right singular vectors of B
+            cmat U = Q * sv.matrixU().leftCols(kept);
+            cmat V = sv.matrixV().leftCols(kept);
+            cmat Z = orth(B.adjoint());
+            cmat Y = M * Z;
+
+            // residuals M v_i - s_i u_i of the kept triplets
+            cmat R = Y * (Z.adjoint() * V) -
+                     U * s.head(kept).cast<cplx>().asDiagonal();
+            if (R.colwise().norm().maxCoeff() <= res_tol * s(0))
+                return std::make_tuple(U, dyn_col_vect<double>(s.head(kept)),
+                                       V);
+
+            Q = orth(Y);
+        }
+
+        if (l == mn)
+            break;
+        l = std::min(2 * l, mn);
+    }
+
+    // full SVD
+    if (!compute_uv)
+    {
+        SVD<cmat> sv(M);
+        return std::make_tuple(cmat{}, dyn_col_vect<double>(
+                sv.singularValues().head(count_kept(sv.singularValues()))),
+                               cmat{});
+    }
+    SVD<cmat> sv(M, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    const dyn_col_vect<double>& s = sv.singularValues();
+    idx kept = count_kept(s);
+
+    return std::make_tuple(cmat(sv.matrixU().leftCols(kept)),
+                           dyn_col_vect<double>(s.head(kept)),
+                           cmat(sv.matrixV().leftCols(kept)));
+}
+
+} /* namespace internal */
+} /* namespace qpp */
+
+#endif /* INTERNAL_RANDOMIZED_SVD_H_ */
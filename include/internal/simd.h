@@ -0,0 +1,199 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* \file internal/simd.h
+* \brief Internal hand-vectorized (AVX2/AVX-512) qubit gate kernels
+*
+* The kernels are compiled for their instruction set via function target
+* attributes and selected at runtime by CPU feature detection, so the rest
+* of the library does not need to be compiled with -mavx2/-mavx512f.
+* Available only for GNU gcc/Clang on x86/x86-64; define NO_SIMD_ to
+* disable them and always use the portable kernels.
+*/
+
+#ifndef INTERNAL_SIMD_H_
+#define INTERNAL_SIMD_H_
+
+#if !defined(NO_SIMD_) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define QPP_SIMD_X86_
+#include <immintrin.h>
+#endif // !NO_SIMD_ && (__GNUC__ || __clang__) && (__x86_64__ || __i386__)
+
+namespace qpp
+{
+namespace internal
+{
+#ifdef QPP_SIMD_X86_
+
+// runtime CPU feature detection, evaluated only once
+inline bool cpu_has_avx2_fma() noexcept
+{
+    static const bool result = __builtin_cpu_supports("avx2") &&
+                               __builtin_cpu_supports("fma");
+    return result;
+}
+
+inline bool cpu_has_avx512f() noexcept
+{
+    static const bool result = __builtin_cpu_supports("avx512f");
+    return result;
+}
+
+// complex product (ar + i ai) * x, x holds 2 interleaved complex numbers
+__attribute__((target("avx2,fma")))
+inline __m256d cmul_avx2(__m256d ar, __m256d ai, __m256d x) noexcept
+{
+    __m256d xs = _mm256_shuffle_pd(x, x, 0x5); // swap real/imaginary parts
+    return _mm256_fmaddsub_pd(ar, x, _mm256_mul_pd(ai, xs));
+}
+
+// complex product (ar + i ai) * x, x holds 4 interleaved complex numbers
+__attribute__((target("avx512f")))
+inline __m512d cmul_avx512(__m512d ar, __m512d ai, __m512d x) noexcept
+{
+    __m512d xs = _mm512_shuffle_pd(x, x, 0x55); // swap real/imaginary parts
+    return _mm512_fmaddsub_pd(ar, x, _mm512_mul_pd(ai, xs));
+}
+
+// applies the DA x DA gate a (row-major, DA = 2 or 4) to the qubit ket psi,
+// processing 2 consecutive blocks at a time; the lowest bit of the global
+// index must not be a control or target bit
+__attribute__((target("avx2,fma")))
+inline void apply_ctrl_ket_qubits_avx2(cplx* psi, const cplx* a,
+                                       const QubitGateIndex& ix)
+{
+    const idx DA = ix.DA;
+    __m256d ar[16], ai[16];
+    for (idx k = 0; k < DA * DA; ++k)
+    {
+        ar[k] = _mm256_set1_pd(a[k].real());
+        ai[k] = _mm256_set1_pd(a[k].imag());
+    }
+    idx offA[4];
+    for (idx m = 0; m < DA; ++m)
+        offA[m] = ix.offA[m];
+    double* p = reinterpret_cast<double*>(psi);
+    const idx nblocks = ix.Dfree / 2;
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx j = 0; j < nblocks; ++j)
+    {
+        idx base = ix.active_base(2 * j);
+        __m256d x[4];
+        for (idx n = 0; n < DA; ++n)
+            x[n] = _mm256_loadu_pd(p + 2 * (base | offA[n]));
+        for (idx m = 0; m < DA; ++m)
+        {
+            __m256d y = cmul_avx2(ar[m * DA], ai[m * DA], x[0]);
+            for (idx n = 1; n < DA; ++n)
+                y = _mm256_add_pd(y, cmul_avx2(ar[m * DA + n],
+                                               ai[m * DA + n], x[n]));
+            _mm256_storeu_pd(p + 2 * (base | offA[m]), y);
+        }
+    }
+}
+
+// applies the DA x DA gate a (row-major, DA = 2 or 4) to the qubit ket psi,
+// processing 4 consecutive blocks at a time; the 2 lowest bits of the global
+// index must not be control or target bits
+__attribute__((target("avx512f")))
+inline void apply_ctrl_ket_qubits_avx512(cplx* psi, const cplx* a,
+                                         const QubitGateIndex& ix)
+{
+    const idx DA = ix.DA;
+    __m512d ar[16], ai[16];
+    for (idx k = 0; k < DA * DA; ++k)
+    {
+        ar[k] = _mm512_set1_pd(a[k].real());
+        ai[k] = _mm512_set1_pd(a[k].imag());
+    }
+    idx offA[4];
+    for (idx m = 0; m < DA; ++m)
+        offA[m] = ix.offA[m];
+    double* p = reinterpret_cast<double*>(psi);
+    const idx nblocks = ix.Dfree / 4;
+
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx j = 0; j < nblocks; ++j)
+    {
+        idx base = ix.active_base(4 * j);
+        __m512d x[4];
+        for (idx n = 0; n < DA; ++n)
+            x[n] = _mm512_loadu_pd(p + 2 * (base | offA[n]));
+        for (idx m = 0; m < DA; ++m)
+        {
+            __m512d y = cmul_avx512(ar[m * DA], ai[m * DA], x[0]);
+            for (idx n = 1; n < DA; ++n)
+                y = _mm512_add_pd(y, cmul_avx512(ar[m * DA + n],
+                                                 ai[m * DA + n], x[n]));
+            _mm512_storeu_pd(p + 2 * (base | offA[m]), y);
+        }
+    }
+}
+
+#endif // QPP_SIMD_X86_
+
+// applies the dense 1- or 2-qubit gate A to the qubit ket psi (contiguous
+// storage) using the widest available vector instructions; returns false,
+// without touching psi, if no vectorized kernel applies
+inline bool apply_ctrl_ket_qubits_simd(cplx* psi, const cmat& A,
+                                       const QubitGateIndex& ix)
+{
+#ifdef QPP_SIMD_X86_
+    if (ix.DA != 2 && ix.DA != 4)
+        return false;
+
+    cplx a[16]; // row-major copy of the gate
+    for (idx m = 0; m < ix.DA; ++m)
+        for (idx n = 0; n < ix.DA; ++n)
+            a[m * ix.DA + n] = A(m, n);
+
+    // number of lowest bits of the global index that are free
+    idx nlow = ix.min_fixed_pos();
+    if (nlow >= 2 && cpu_has_avx512f())
+    {
+        apply_ctrl_ket_qubits_avx512(psi, a, ix);
+        return true;
+    }
+    if (nlow >= 1 && cpu_has_avx2_fma())
+    {
+        apply_ctrl_ket_qubits_avx2(psi, a, ix);
+        return true;
+    }
+#else
+    (void) psi;
+    (void) A;
+    (void) ix;
+#endif // QPP_SIMD_X86_
+
+    return false;
+}
+
+} /* namespace internal */
+} /* namespace qpp */
+
+#endif /* INTERNAL_SIMD_H_ */
@@ -96,13 +96,117 @@ noexcept
 #pragma GCC diagnostic pop
 #endif
 
-// check square matrix
+// check square matrix (dense or sparse)
 template<typename Derived>
-bool check_square_mat(const Eigen::MatrixBase<Derived>& A)
+bool check_square_mat(const Eigen::EigenBase<Derived>& A)
 {
     return A.rows() == A.cols();
 }
 
+// check whether input is a Hermitian matrix, up to qpp::eps relative to its
+// largest entry, so that matrices with tiny entries are not all Hermitian;
+// the two triangles are compared tile by tile, for cache efficiency
+template<typename Derived>
+bool check_hermitian(const Eigen::MatrixBase<Derived>& A)
+{
+    if (A.rows() != A.cols())
+        return false;
+    if (A.size() == 0)
+        return true;
+
+    const idx D = static_cast<idx>(A.rows());
+    const double tol = eps * static_cast<double>(A.cwiseAbs().maxCoeff());
+    const idx tile = 32;
+    for (idx j0 = 0; j0 < D; j0 += tile)
+        for (idx i0 = j0; i0 < D; i0 += tile)
+        {
+            idx j1 = std::min(j0 + tile, D);
+            idx i1 = std::min(i0 + tile, D);
+            for (idx j = j0; j < j1; ++j)
+                for (idx i = std::max(i0, j); i < i1; ++i)
+                    if (std::norm(A(i, j) - Eigen::numext::conj(A(j, i))) >
+                        tol * tol)
+                        return false;
+        }
+
+    return true;
+}
+
+// check whether input is a square matrix with all off-diagonal elements
+// exactly zero
+template<typename Derived>
+bool check_diagonal(const Eigen::MatrixBase<Derived>& A)
+{
+    if (A.rows() != A.cols())
+        return false;
+
+    const idx D = static_cast<idx>(A.rows());
+    for (idx j = 0; j < D; ++j)
+        for (idx i = 0; i < D; ++i)
+            if (i != j && A(i, j) != typename Derived::Scalar(0))
+                return false;
+
+    return true;
+}
+
+// check whether input is a square monomial matrix, i.e. with exactly one
+// non-zero element in each row and in each column (a permutation matrix up
+// to phases)
+template<typename Derived>
+bool check_monomial(const Eigen::MatrixBase<Derived>& A)
+{
+    if (A.rows() != A.cols())
+        return false;
+
+    const idx D = static_cast<idx>(A.rows());
+    std::vector<bool> row_used(D, false);
+    for (idx j = 0; j < D; ++j)
+    {
+        idx count = 0;
+        for (idx i = 0; i < D; ++i)
+            if (A(i, j) != typename Derived::Scalar(0))
+            {
+                if (row_used[i] || ++count > 1)
+                    return false;
+                row_used[i] = true;
+            }
+        if (count == 0)
+            return false;
+    }
+
+    return true;
+}
+
+// SVD of dense matrices; the divide and conquer BDCSVD of Eigen >= 3.3 is
+// much faster than the Jacobi SVD on large matrices, and switches by itself
+// to the Jacobi SVD on small ones
+#if EIGEN_VERSION_AT_LEAST(3, 3, 0)
+template<typename MatrixType>
+using SVD = Eigen::BDCSVD<MatrixType>;
+#else
+template<typename MatrixType>
+using SVD = Eigen::JacobiSVD<MatrixType>;
+#endif
+
+// singular values of the square matrix A, in decreasing order; when A is
+// Hermitian they are the absolute values of its eigenvalues, computed by the
+// self-adjoint eigensolver, which is much faster than the SVD
+template<typename Derived>
+dyn_col_vect<double> square_svals(const Eigen::MatrixBase<Derived>& A)
+{
+    const cmat cA = A.template cast<cplx>();
+    if (!check_hermitian(cA))
+        return SVD<cmat>(cA).singularValues();
+
+    dyn_col_vect<double> result =
+            Eigen::SelfAdjointEigenSolver<cmat>(cA, Eigen::EigenvaluesOnly)
+                    .eigenvalues().cwiseAbs();
+    std::sort(result.data(), result.data() + result.size(),
+              std::greater<double>());
+
+    return result;
+}
+
 // check whether input is a vector or not
 template<typename Derived>
 bool check_vector(const Eigen::MatrixBase<Derived>& A)
@@ -153,10 +257,10 @@ inline bool check_dims(const std::vector<idx>& dims)
 }
 
 // check that valid dims match the dimensions
-// of valid (non-zero sized) square matrix
+// of valid (non-zero sized) square matrix (dense or sparse)
 template<typename Derived>
 bool check_dims_match_mat(const std::vector<idx>& dims,
-                          const Eigen::MatrixBase<Derived>& A)
+                          const Eigen::EigenBase<Derived>& A)
 {
 // error checks only in DEBUG version
 #ifndef NDEBUG
@@ -280,11 +384,16 @@ inline bool check_perm(const std::vector<idx>& perm)
     if (perm.size() == 0)
         return false;
 
-    std::vector<idx> ordered(perm.size());
-    std::iota(std::begin(ordered), std::end(ordered), 0);
+    // linear time, perm may be as large as a whole register
+    std::vector<bool> seen(perm.size(), false);
+    for (auto&& p : perm)
+    {
+        if (p >= perm.size() || seen[p])
+            return false;
+        seen[p] = true;
+    }
 
-    return std::is_permutation(std::begin(ordered), std::end(ordered),
-                               std::begin(perm));
+    return true;
 }
 
 // Kronecker product of 2 matrices, preserve return type
@@ -414,6 +523,67 @@ inline idx get_dim_subsys(idx sz, idx N)
     return static_cast<idx>(std::llround(std::pow(sz, 1. / N)));
 }
 
+// returns the offsets (w.r.t. the global index of a system with local
+// dimensions dims) of the basis states of the subsystems subsys, listed in
+// the standard lexicographical order of subsys
+inline std::vector<idx> get_subsys_offsets(const std::vector<idx>& subsys,
+                                           const std::vector<idx>& dims)
+{
+    idx N = dims.size();
+    std::vector<idx> strides(N);
+    idx D = 1;
+    for (idx i = N; i-- > 0;)
+    {
+        strides[i] = D;
+        D *= dims[i];
+    }
+
+    std::vector<idx> result{0};
+    for (idx k = 0; k < subsys.size(); ++k)
+    {
+        std::vector<idx> tmp;
+        tmp.reserve(result.size() * dims[subsys[k]]);
+        for (auto&& off : result)
+            for (idx m = 0; m < dims[subsys[k]]; ++m)
+                tmp.push_back(off + m * strides[subsys[k]]);
+        result = std::move(tmp);
+    }
+
+    return result;
+}
+
+// probabilities of the computational basis outcomes of the measured
+// subsystems (offsets os, see get_subsys_offsets()) of the ket or density
+// matrix A, the remaining subsystems having offsets ob; the global index
+// ob[b] + os[j] corresponds to the outcome j
+template<typename Derived>
+std::vector<double> get_outcome_probs(const Eigen::MatrixBase<Derived>& A,
+                                      const std::vector<idx>& os,
+                                      const std::vector<idx>& ob)
+{
+    const idx Dsubsys = os.size();
+    const idx Dbar = ob.size();
+    const bool is_ket = check_cvector(A);
+
+    std::vector<double> result(Dsubsys);
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx j = 0; j < Dsubsys; ++j)
+    {
+        double p = 0;
+        if (is_ket)
+            for (idx b = 0; b < Dbar; ++b)
+                p += std::norm(A(ob[b] + os[j]));
+        else
+            for (idx b = 0; b < Dbar; ++b)
+                p += std::real(A(ob[b] + os[j], ob[b] + os[j]));
+        result[j] = p;
+    }
+
+    return result;
+}
+
 // implementation details for pretty formatting
 struct Display_Impl_
 {
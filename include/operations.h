@@ -35,12 +35,15 @@ namespace qpp
 * of the multi-partite state vector or density matrix \a state
 * \see qpp::Gates::CTRL()
 *
+* A sparse gate (e.g. qpp::sp_cmat) is never densified, it is applied to
+* each block of amplitudes it acts upon in O(nnz) operations.
+*
 * \note The dimension of the gate \a A must match
 * the dimension of \a subsys.
 * Also, all control subsystems in \a ctrl must have the same dimension.
 *
 * \param state Eigen expression
-* \param A Eigen expression
+* \param A Eigen expression, dense or sparse
 * \param ctrl Control subsystem indexes
 * \param subsys Subsystem indexes where the gate \a A is applied
 * \param dims Dimensions of the multi-partite system
@@ -49,14 +52,14 @@ namespace qpp
 template<typename Derived1, typename Derived2>
 dyn_mat<typename Derived1::Scalar> applyCTRL(
         const Eigen::MatrixBase<Derived1>& state,
-        const Eigen::MatrixBase<Derived2>& A,
+        const Eigen::EigenBase<Derived2>& A,
         const std::vector<idx>& ctrl,
         const std::vector<idx>& subsys,
         const std::vector<idx>& dims)
 {
     const typename Eigen::MatrixBase<Derived1>::EvalReturnType& rstate
             = state.derived();
-    const dyn_mat<typename Derived2::Scalar>& rA = A.derived();
+    const Derived2& rA = A.derived();
 
     // EXCEPTION CHECKS
 
@@ -91,12 +94,20 @@ dyn_mat<typename Derived1::Scalar> applyCTRL(
     if (!internal::check_subsys_match_dims(subsys, dims))
         throw exception::SubsysMismatchDims("qpp::applyCTRL()");
 
-    // check that gate matches the dimensions of the subsys
-    std::vector<idx> subsys_dims(subsys.size());
-    for (idx i = 0; i < subsys.size(); ++i)
-        subsys_dims[i] = dims[subsys[i]];
-    if (!internal::check_dims_match_mat(subsys_dims, rA))
-        throw exception::MatrixMismatchSubsys("qpp::applyCTRL()");
+    // check that gate matches the dimensions of the subsys, a gate acting
+    // on no subsystems must be 1 x 1
+    if (subsys.empty())
+    {
+        if (static_cast<idx>(rA.rows()) != 1)
+            throw exception::MatrixMismatchSubsys("qpp::applyCTRL()");
+    } else
+    {
+        std::vector<idx> subsys_dims(subsys.size());
+        for (idx i = 0; i < subsys.size(); ++i)
+            subsys_dims[i] = dims[subsys[i]];
+        if (!internal::check_dims_match_mat(subsys_dims, rA))
+            throw exception::MatrixMismatchSubsys("qpp::applyCTRL()");
+    }
 
     std::vector<idx> ctrlgate = ctrl; // ctrl + gate subsystem vector
     ctrlgate.insert(std::end(ctrlgate), std::begin(subsys), std::end(subsys));
@@ -108,231 +119,7 @@ dyn_mat<typename Derived1::Scalar> applyCTRL(
         throw exception::SubsysMismatchDims("qpp::applyCTRL()");
     // END EXCEPTION CHECKS
 
-    // construct the table of A^i and (A^dagger)^i
-    std::vector<dyn_mat<typename Derived1::Scalar>> Ai;
-    std::vector<dyn_mat<typename Derived1::Scalar>> Aidagger;
-    for (idx i = 0; i < std::max(d, static_cast<idx>(2)); ++i)
-    {
-        Ai.push_back(powm(rA, i));
-        Aidagger.push_back(powm(adjoint(rA), i));
-    }
-
     idx D = static_cast<idx>(rstate.rows()); // total dimension
-    idx N = dims.size();                // total number of subsystems
-    idx ctrlsize = ctrl.size();         // number of ctrl subsystem
-    idx ctrlgatesize = ctrlgate.size(); // number of ctrl+gate subsystems
-    idx subsyssize = subsys.size();     // number of subsystems of the target
-    // dimension of ctrl subsystem
-    idx Dctrl = static_cast<idx>(std::llround(std::pow(d, ctrlsize)));
-    idx DA = static_cast<idx>(rA.rows()); // dimension of gate subsystem
-
-    idx Cdims[maxn];         // local dimensions
-    idx CdimsA[maxn];        // local dimensions
-    idx CdimsCTRL[maxn];     // local dimensions
-    idx CdimsCTRLA_bar[maxn]; // local dimensions
-
-    // compute the complementary subsystem of ctrlgate w.r.t. dims
-    std::vector<idx> ctrlgate_bar = complement(ctrlgate, N);
-    // number of subsystems that are complementary to the ctrl+gate
-    idx ctrlgate_barsize = ctrlgate_bar.size();
-
-    idx DCTRLA_bar = 1; // dimension of the rest
-    for (idx i = 0; i < ctrlgate_barsize; ++i)
-        DCTRLA_bar *= dims[ctrlgate_bar[i]];
-
-    for (idx k = 0; k < N; ++k)
-        Cdims[k] = dims[k];
-    for (idx k = 0; k < subsyssize; ++k)
-        CdimsA[k] = dims[subsys[k]];
-    for (idx k = 0; k < ctrlsize; ++k)
-        CdimsCTRL[k] = d;
-    for (idx k = 0; k < ctrlgate_barsize; ++k)
-        CdimsCTRLA_bar[k] = dims[ctrlgate_bar[k]];
-
-    // worker, computes the coefficient and the index for the ket case
-    // used in #pragma omp parallel for collapse
-    auto coeff_idx_ket = [&](idx i_, idx m_, idx r_) noexcept
-            -> std::pair<typename Derived1::Scalar, idx>
-    {
-        idx indx = 0;
-        typename Derived1::Scalar coeff = 0;
-
-        idx Cmidx[maxn];         // the total multi-index
-        idx CmidxA[maxn];        // the gate part multi-index
-        idx CmidxCTRLA_bar[maxn]; // the rest multi-index
-
-        // compute the index
-
-        // set the CTRL part
-        for (idx k = 0; k < ctrlsize; ++k)
-        {
-            Cmidx[ctrl[k]] = i_;
-        }
-
-        // set the rest
-        internal::n2multiidx(r_, N - ctrlgatesize,
-                             CdimsCTRLA_bar, CmidxCTRLA_bar);
-        for (idx k = 0; k < N - ctrlgatesize; ++k)
-        {
-            Cmidx[ctrlgate_bar[k]] = CmidxCTRLA_bar[k];
-        }
-
-        // set the A part
-        internal::n2multiidx(m_, subsyssize, CdimsA, CmidxA);
-        for (idx k = 0; k < subsyssize; ++k)
-        {
-            Cmidx[subsys[k]] = CmidxA[k];
-        }
-
-        // we now got the total index
-        indx = internal::multiidx2n(Cmidx, N, Cdims);
-
-        // compute the coefficient
-        for (idx n_ = 0; n_ < DA; ++n_)
-        {
-            internal::n2multiidx(n_, subsyssize, CdimsA, CmidxA);
-            for (idx k = 0; k < subsyssize; ++k)
-            {
-                Cmidx[subsys[k]] = CmidxA[k];
-            }
-            coeff += Ai[i_](m_, n_) *
-                     rstate(internal::multiidx2n(Cmidx, N, Cdims));
-        }
-
-        return std::make_pair(coeff, indx);
-    }; /* end coeff_idx_ket */
-
-    // worker, computes the coefficient and the index
-    // for the density matrix case
-    // used in #pragma omp parallel for collapse
-    auto coeff_idx_rho = [&](idx i1_, idx m1_,
-                             idx r1_, idx i2_, idx m2_, idx r2_) noexcept
-            -> std::tuple<typename Derived1::Scalar, idx, idx>
-    {
-        idx idxrow = 0;
-        idx idxcol = 0;
-        typename Derived1::Scalar coeff = 0, lhs = 1, rhs = 1;
-
-        idx Cmidxrow[maxn];         // the total row multi-index
-        idx Cmidxcol[maxn];         // the total col multi-index
-        idx CmidxArow[maxn];        // the gate part row multi-index
-        idx CmidxAcol[maxn];        // the gate part col multi-index
-        idx CmidxCTRLrow[maxn];     // the control row multi-index
-        idx CmidxCTRLcol[maxn];     // the control col multi-index
-        idx CmidxCTRLA_barrow[maxn]; // the rest row multi-index
-        idx CmidxCTRLA_barcol[maxn]; // the rest col multi-index
-
-        // compute the ket/bra indexes
-
-        // set the CTRL part
-        internal::n2multiidx(i1_, ctrlsize,
-                             CdimsCTRL, CmidxCTRLrow);
-        internal::n2multiidx(i2_, ctrlsize,
-                             CdimsCTRL, CmidxCTRLcol);
-
-        for (idx k = 0; k < ctrlsize; ++k)
-        {
-            Cmidxrow[ctrl[k]] = CmidxCTRLrow[k];
-            Cmidxcol[ctrl[k]] = CmidxCTRLcol[k];
-        }
-
-        // set the rest
-        internal::n2multiidx(r1_, N - ctrlgatesize,
-                             CdimsCTRLA_bar, CmidxCTRLA_barrow);
-        internal::n2multiidx(r2_, N - ctrlgatesize,
-                             CdimsCTRLA_bar, CmidxCTRLA_barcol);
-        for (idx k = 0; k < N - ctrlgatesize; ++k)
-        {
-            Cmidxrow[ctrlgate_bar[k]] = CmidxCTRLA_barrow[k];
-            Cmidxcol[ctrlgate_bar[k]] = CmidxCTRLA_barcol[k];
-        }
-
-        // set the A part
-        internal::n2multiidx(m1_, subsyssize, CdimsA, CmidxArow);
-        internal::n2multiidx(m2_, subsyssize, CdimsA, CmidxAcol);
-        for (idx k = 0; k < subsys.size(); ++k)
-        {
-            Cmidxrow[subsys[k]] = CmidxArow[k];
-            Cmidxcol[subsys[k]] = CmidxAcol[k];
-        }
-
-        // we now got the total row/col indexes
-        idxrow = internal::multiidx2n(Cmidxrow, N, Cdims);
-        idxcol = internal::multiidx2n(Cmidxcol, N, Cdims);
-
-        // check whether all CTRL row and col multi indexes are equal
-        bool all_ctrl_rows_equal = true;
-        bool all_ctrl_cols_equal = true;
-
-        idx first_ctrl_row, first_ctrl_col;
-        if (ctrlsize > 0)
-        {
-            first_ctrl_row = CmidxCTRLrow[0];
-            first_ctrl_col = CmidxCTRLcol[0];
-        } else
-        {
-            first_ctrl_row = first_ctrl_col = 1;
-        }
-
-        for (idx k = 1; k < ctrlsize; ++k)
-        {
-            if (CmidxCTRLrow[k] != first_ctrl_row)
-            {
-                all_ctrl_rows_equal = false;
-                break;
-            }
-        }
-        for (idx k = 1; k < ctrlsize; ++k)
-        {
-            if (CmidxCTRLcol[k] != first_ctrl_col)
-            {
-                all_ctrl_cols_equal = false;
-                break;
-            }
-        }
-
-        // at least one control activated, compute the coefficient
-        for (idx n1_ = 0; n1_ < DA; ++n1_)
-        {
-            internal::n2multiidx(n1_, subsyssize, CdimsA, CmidxArow);
-            for (idx k = 0; k < subsyssize; ++k)
-            {
-                Cmidxrow[subsys[k]] = CmidxArow[k];
-            }
-            idx idxrowtmp = internal::multiidx2n(Cmidxrow, N, Cdims);
-
-            if (all_ctrl_rows_equal)
-            {
-                lhs = Ai[first_ctrl_row](m1_, n1_);
-            } else
-            {
-                lhs = (m1_ == n1_) ? 1 : 0; // identity matrix
-            }
-
-            for (idx n2_ = 0; n2_ < DA; ++n2_)
-            {
-                internal::n2multiidx(n2_, subsyssize, CdimsA, CmidxAcol);
-                for (idx k = 0; k < subsyssize; ++k)
-                {
-                    Cmidxcol[subsys[k]] = CmidxAcol[k];
-                }
-
-                if (all_ctrl_cols_equal)
-                {
-                    rhs = Aidagger[first_ctrl_col](n2_, m2_);
-                } else
-                {
-                    rhs = (n2_ == m2_) ? 1 : 0; // identity matrix
-                }
-
-                idx idxcoltmp = internal::multiidx2n(Cmidxcol, N, Cdims);
-
-                coeff += lhs * rstate(idxrowtmp, idxcoltmp) * rhs;
-            }
-        }
-
-        return std::make_tuple(coeff, idxrow, idxcol);
-    }; /* end coeff_idx_rho */
 
     //************ ket ************//
     if (internal::check_cvector(rstate)) // we have a ket
@@ -340,28 +127,13 @@ dyn_mat<typename Derived1::Scalar> applyCTRL(
         // check that dims match state vector
         if (!internal::check_dims_match_cvect(dims, rstate))
             throw exception::DimsMismatchCvector("qpp::applyCTRL()");
-        if (D == 1)
-            return rstate;
 
         dyn_mat<typename Derived1::Scalar> result = rstate;
-
-#ifdef WITH_OPENMP_
-#pragma omp parallel for collapse(2)
-#endif // WITH_OPENMP_
-        for (idx m = 0; m < DA; ++m)
-            for (idx r = 0; r < DCTRLA_bar; ++r)
-            {
-                if (ctrlsize == 0) // no control
-                {
-                    result(coeff_idx_ket(1, m, r).second) =
-                            coeff_idx_ket(1, m, r).first;
-                } else
-                    for (idx i = 0; i < d; ++i)
-                    {
-                        result(coeff_idx_ket(i, m, r).second) =
-                                coeff_idx_ket(i, m, r).first;
-                    }
-            }
+        if (ctrl.empty() && subsys.empty()) // global phase
+            internal::apply_phase_inplace(result, rA);
+        else if (D != 1)
+            internal::apply_ctrl_gate_inplace(result, rA, d, ctrl, subsys,
+                                              dims);
 
         return result;
     }
@@ -372,38 +144,12 @@ dyn_mat<typename Derived1::Scalar> applyCTRL(
         if (!internal::check_dims_match_mat(dims, rstate))
             throw exception::DimsMismatchMatrix("qpp::applyCTRL()");
 
-        if (D == 1)
-            return rstate;
-
         dyn_mat<typename Derived1::Scalar> result = rstate;
-
-#ifdef WITH_OPENMP_
-#pragma omp parallel for collapse(4)
-#endif // WITH_OPENMP_
-        for (idx m1 = 0; m1 < DA; ++m1)
-            for (idx r1 = 0; r1 < DCTRLA_bar; ++r1)
-                for (idx m2 = 0; m2 < DA; ++m2)
-                    for (idx r2 = 0; r2 < DCTRLA_bar; ++r2)
-                        if (ctrlsize == 0) // no control
-                        {
-                            auto coeff_idxes = coeff_idx_rho(1, m1, r1,
-                                                             1, m2, r2);
-                            result(std::get<1>(coeff_idxes),
-                                   std::get<2>(coeff_idxes)) =
-                                    std::get<0>(coeff_idxes);
-                        } else
-                        {
-                            for (idx i1 = 0; i1 < Dctrl; ++i1)
-                                for (idx i2 = 0; i2 < Dctrl; ++i2)
-                                {
-                                    auto coeff_idxes = coeff_idx_rho(
-                                            i1, m1, r1,
-                                            i2, m2, r2);
-                                    result(std::get<1>(coeff_idxes),
-                                           std::get<2>(coeff_idxes)) =
-                                            std::get<0>(coeff_idxes);
-                                }
-                        }
+        if (ctrl.empty() && subsys.empty()) // global phase
+            internal::apply_phase_inplace(result, rA);
+        else if (D != 1)
+            internal::apply_ctrl_gate_inplace(result, rA, d, ctrl, subsys,
+                                              dims);
 
         return result;
     }
@@ -421,7 +167,7 @@ dyn_mat<typename Derived1::Scalar> applyCTRL(
 * the dimension of \a subsys
 *
 * \param state Eigen expression
-* \param A Eigen expression
+* \param A Eigen expression, dense or sparse
 * \param ctrl Control subsystem indexes
 * \param subsys Subsystem indexes where the gate \a A is applied
 * \param d Subsystem dimensions
@@ -430,14 +176,14 @@ dyn_mat<typename Derived1::Scalar> applyCTRL(
 template<typename Derived1, typename Derived2>
 dyn_mat<typename Derived1::Scalar> applyCTRL(
         const Eigen::MatrixBase<Derived1>& state,
-        const Eigen::MatrixBase<Derived2>& A,
+        const Eigen::EigenBase<Derived2>& A,
         const std::vector<idx>& ctrl,
         const std::vector<idx>& subsys,
         idx d = 2)
 {
     const typename Eigen::MatrixBase<Derived1>::EvalReturnType& rstate
             = state.derived();
-    const dyn_mat<typename Derived1::Scalar>& rA = A.derived();
+    const Derived2& rA = A.derived();
 
     // EXCEPTION CHECKS
 
@@ -460,11 +206,14 @@ dyn_mat<typename Derived1::Scalar> applyCTRL(
 * \brief Applies the gate \a A to the part \a subsys
 * of the multi-partite state vector or density matrix \a state
 *
+* A sparse gate (e.g. qpp::sp_cmat) is never densified, it is applied to
+* each block of amplitudes it acts upon in O(nnz) operations.
+*
 * \note The dimension of the gate \a A must match
 * the dimension of \a subsys
 *
 * \param state Eigen expression
-* \param A Eigen expression
+* \param A Eigen expression, dense or sparse
 * \param subsys Subsystem indexes where the gate \a A is applied
 * \param dims Dimensions of the multi-partite system
 * \return Gate \a A applied to the part \a subsys of \a state
@@ -472,13 +221,13 @@ dyn_mat<typename Derived1::Scalar> applyCTRL(
 template<typename Derived1, typename Derived2>
 dyn_mat<typename Derived1::Scalar> apply(
         const Eigen::MatrixBase<Derived1>& state,
-        const Eigen::MatrixBase<Derived2>& A,
+        const Eigen::EigenBase<Derived2>& A,
         const std::vector<idx>& subsys,
         const std::vector<idx>& dims)
 {
     const typename Eigen::MatrixBase<Derived1>::EvalReturnType& rstate
             = state.derived();
-    const dyn_mat<typename Derived2::Scalar>& rA = A.derived();
+    const Derived2& rA = A.derived();
 
     // EXCEPTION CHECKS
 
@@ -507,12 +256,20 @@ dyn_mat<typename Derived1::Scalar> apply(
     if (!internal::check_subsys_match_dims(subsys, dims))
         throw exception::SubsysMismatchDims("qpp::apply()");
 
-    // check that gate matches the dimensions of the subsys
-    std::vector<idx> subsys_dims(subsys.size());
-    for (idx i = 0; i < subsys.size(); ++i)
-        subsys_dims[i] = dims[subsys[i]];
-    if (!internal::check_dims_match_mat(subsys_dims, rA))
-        throw exception::MatrixMismatchSubsys("qpp::apply()");
+    // check that gate matches the dimensions of the subsys, a gate acting
+    // on no subsystems must be 1 x 1
+    if (subsys.empty())
+    {
+        if (static_cast<idx>(rA.rows()) != 1)
+            throw exception::MatrixMismatchSubsys("qpp::apply()");
+    } else
+    {
+        std::vector<idx> subsys_dims(subsys.size());
+        for (idx i = 0; i < subsys.size(); ++i)
+            subsys_dims[i] = dims[subsys[i]];
+        if (!internal::check_dims_match_mat(subsys_dims, rA))
+            throw exception::MatrixMismatchSubsys("qpp::apply()");
+    }
     // END EXCEPTION CHECKS
 
     //************ ket ************//
@@ -547,7 +304,7 @@ dyn_mat<typename Derived1::Scalar> apply(
 * the dimension of \a subsys
 *
 * \param state Eigen expression
-* \param A Eigen expression
+* \param A Eigen expression, dense or sparse
 * \param subsys Subsystem indexes where the gate \a A is applied
 * \param d Subsystem dimensions
 * \return Gate \a A applied to the part \a subsys of \a state
@@ -555,13 +312,13 @@ dyn_mat<typename Derived1::Scalar> apply(
 template<typename Derived1, typename Derived2>
 dyn_mat<typename Derived1::Scalar> apply(
         const Eigen::MatrixBase<Derived1>& state,
-        const Eigen::MatrixBase<Derived2>& A,
+        const Eigen::EigenBase<Derived2>& A,
         const std::vector<idx>& subsys,
         idx d = 2)
 {
     const typename Eigen::MatrixBase<Derived1>::EvalReturnType& rstate
             = state.derived();
-    const dyn_mat<typename Derived1::Scalar>& rA = A.derived();
+    const Derived2& rA = A.derived();
 
     // EXCEPTION CHECKS
 
@@ -580,6 +337,282 @@ dyn_mat<typename Derived1::Scalar> apply(
     return apply(rstate, rA, subsys, dims);
 }
 
+/**
+* \brief In-place version of qpp::applyCTRL(), applies the controlled-gate
+* \a A to the part \a subsys of the multi-partite state vector or density
+* matrix \a state, overwriting \a state with the result
+* \see qpp::applyCTRL(), qpp::Gates::CTRL()
+*
+* Only the amplitudes touched by the gate are updated, and no copy of
+* \a state is made.
+*
+* \note The dimension of the gate \a A must match
+* the dimension of \a subsys.
+* Also, all control subsystems in \a ctrl must have the same dimension.
+*
+* \param state Eigen matrix or vector, overwritten with the result
+* \param A Eigen expression, dense or sparse
+* \param ctrl Control subsystem indexes
+* \param subsys Subsystem indexes where the gate \a A is applied
+* \param dims Dimensions of the multi-partite system
+*/
+template<typename Derived1, typename Derived2>
+void applyCTRL_inplace(
+        Eigen::MatrixBase<Derived1>& state,
+        const Eigen::EigenBase<Derived2>& A,
+        const std::vector<idx>& ctrl,
+        const std::vector<idx>& subsys,
+        const std::vector<idx>& dims)
+{
+    Derived1& rstate = state.derived();
+    const Derived2& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check types
+    if (!std::is_same<typename Derived1::Scalar,
+            typename Derived2::Scalar>::value)
+        throw exception::TypeMismatch("qpp::applyCTRL_inplace()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::applyCTRL_inplace()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::applyCTRL_inplace()");
+
+    // check square matrix for the gate
+    if (!internal::check_square_mat(rA))
+        throw exception::MatrixNotSquare("qpp::applyCTRL_inplace()");
+
+    // check that all control subsystems have the same dimension
+    idx d = ctrl.size() > 0 ? dims[ctrl[0]] : 1;
+    for (idx i = 1; i < ctrl.size(); ++i)
+        if (dims[ctrl[i]] != d)
+            throw exception::DimsNotEqual("qpp::applyCTRL_inplace()");
+
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::applyCTRL_inplace()");
+
+    // check subsys is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(subsys, dims))
+        throw exception::SubsysMismatchDims("qpp::applyCTRL_inplace()");
+
+    // check that gate matches the dimensions of the subsys, a gate acting
+    // on no subsystems must be 1 x 1
+    if (subsys.empty())
+    {
+        if (static_cast<idx>(rA.rows()) != 1)
+            throw exception::MatrixMismatchSubsys("qpp::applyCTRL_inplace()");
+    } else
+    {
+        std::vector<idx> subsys_dims(subsys.size());
+        for (idx i = 0; i < subsys.size(); ++i)
+            subsys_dims[i] = dims[subsys[i]];
+        if (!internal::check_dims_match_mat(subsys_dims, rA))
+            throw exception::MatrixMismatchSubsys("qpp::applyCTRL_inplace()");
+    }
+
+    std::vector<idx> ctrlgate = ctrl; // ctrl + gate subsystem vector
+    ctrlgate.insert(std::end(ctrlgate), std::begin(subsys), std::end(subsys));
+    std::sort(std::begin(ctrlgate), std::end(ctrlgate));
+
+    // check that ctrl + gate subsystem is valid
+    // with respect to local dimensions
+    if (!internal::check_subsys_match_dims(ctrlgate, dims))
+        throw exception::SubsysMismatchDims("qpp::applyCTRL_inplace()");
+
+    // check that state is a ket or a density matrix matching dims
+    if (internal::check_cvector(rstate))
+    {
+        if (!internal::check_dims_match_cvect(dims, rstate))
+            throw exception::DimsMismatchCvector("qpp::applyCTRL_inplace()");
+    } else if (internal::check_square_mat(rstate))
+    {
+        if (!internal::check_dims_match_mat(dims, rstate))
+            throw exception::DimsMismatchMatrix("qpp::applyCTRL_inplace()");
+    } else
+        throw exception::MatrixNotSquareNorCvector(
+                "qpp::applyCTRL_inplace()");
+    // END EXCEPTION CHECKS
+
+    if (ctrl.empty() && subsys.empty()) // global phase
+        internal::apply_phase_inplace(rstate, rA);
+    else if (rstate.rows() != 1)
+        internal::apply_ctrl_gate_inplace(rstate, rA, d, ctrl, subsys, dims);
+}
+
+/**
+* \brief In-place version of qpp::applyCTRL(), applies the controlled-gate
+* \a A to the part \a subsys of the multi-partite state vector or density
+* matrix \a state, overwriting \a state with the result
+* \see qpp::applyCTRL(), qpp::Gates::CTRL()
+*
+* \note The dimension of the gate \a A must match
+* the dimension of \a subsys
+*
+* \param state Eigen matrix or vector, overwritten with the result
+* \param A Eigen expression, dense or sparse
+* \param ctrl Control subsystem indexes
+* \param subsys Subsystem indexes where the gate \a A is applied
+* \param d Subsystem dimensions
+*/
+template<typename Derived1, typename Derived2>
+void applyCTRL_inplace(
+        Eigen::MatrixBase<Derived1>& state,
+        const Eigen::EigenBase<Derived2>& A,
+        const std::vector<idx>& ctrl,
+        const std::vector<idx>& subsys,
+        idx d = 2)
+{
+    Derived1& rstate = state.derived();
+    const Derived2& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::applyCTRL_inplace()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::applyCTRL_inplace()");
+    // END EXCEPTION CHECKS
+
+    idx N = internal::get_num_subsys(static_cast<idx>(rstate.rows()), d);
+    std::vector<idx> dims(N, d); // local dimensions vector
+
+    applyCTRL_inplace(rstate, rA, ctrl, subsys, dims);
+}
+
+/**
+* \brief In-place version of qpp::apply(), applies the gate \a A to the part
+* \a subsys of the multi-partite state vector or density matrix \a state,
+* overwriting \a state with the result
+* \see qpp::apply()
+*
+* Only the amplitudes touched by the gate are updated, and no copy of
+* \a state is made.
+*
+* \note The dimension of the gate \a A must match
+* the dimension of \a subsys
+*
+* \param state Eigen matrix or vector, overwritten with the result
+* \param A Eigen expression, dense or sparse
+* \param subsys Subsystem indexes where the gate \a A is applied
+* \param dims Dimensions of the multi-partite system
+*/
+template<typename Derived1, typename Derived2>
+void apply_inplace(
+        Eigen::MatrixBase<Derived1>& state,
+        const Eigen::EigenBase<Derived2>& A,
+        const std::vector<idx>& subsys,
+        const std::vector<idx>& dims)
+{
+    Derived1& rstate = state.derived();
+    const Derived2& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check types
+    if (!std::is_same<typename Derived1::Scalar,
+            typename Derived2::Scalar>::value)
+        throw exception::TypeMismatch("qpp::apply_inplace()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::apply_inplace()");
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::apply_inplace()");
+
+    // check square matrix for the gate
+    if (!internal::check_square_mat(rA))
+        throw exception::MatrixNotSquare("qpp::apply_inplace()");
+
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::apply_inplace()");
+
+    // check subsys is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(subsys, dims))
+        throw exception::SubsysMismatchDims("qpp::apply_inplace()");
+
+    // check that gate matches the dimensions of the subsys, a gate acting
+    // on no subsystems must be 1 x 1
+    if (subsys.empty())
+    {
+        if (static_cast<idx>(rA.rows()) != 1)
+            throw exception::MatrixMismatchSubsys("qpp::apply_inplace()");
+    } else
+    {
+        std::vector<idx> subsys_dims(subsys.size());
+        for (idx i = 0; i < subsys.size(); ++i)
+            subsys_dims[i] = dims[subsys[i]];
+        if (!internal::check_dims_match_mat(subsys_dims, rA))
+            throw exception::MatrixMismatchSubsys("qpp::apply_inplace()");
+    }
+
+    // check that state is a ket or a density matrix matching dims
+    if (internal::check_cvector(rstate))
+    {
+        if (!internal::check_dims_match_cvect(dims, rstate))
+            throw exception::DimsMismatchCvector("qpp::apply_inplace()");
+    } else if (internal::check_square_mat(rstate))
+    {
+        if (!internal::check_dims_match_mat(dims, rstate))
+            throw exception::DimsMismatchMatrix("qpp::apply_inplace()");
+    } else
+        throw exception::MatrixNotSquareNorCvector("qpp::apply_inplace()");
+    // END EXCEPTION CHECKS
+
+    applyCTRL_inplace(rstate, rA, {}, subsys, dims);
+}
+
+/**
+* \brief In-place version of qpp::apply(), applies the gate \a A to the part
+* \a subsys of the multi-partite state vector or density matrix \a state,
+* overwriting \a state with the result
+* \see qpp::apply()
+*
+* \note The dimension of the gate \a A must match
+* the dimension of \a subsys
+*
+* \param state Eigen matrix or vector, overwritten with the result
+* \param A Eigen expression, dense or sparse
+* \param subsys Subsystem indexes where the gate \a A is applied
+* \param d Subsystem dimensions
+*/
+template<typename Derived1, typename Derived2>
+void apply_inplace(
+        Eigen::MatrixBase<Derived1>& state,
+        const Eigen::EigenBase<Derived2>& A,
+        const std::vector<idx>& subsys,
+        idx d = 2)
+{
+    Derived1& rstate = state.derived();
+    const Derived2& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero size
+    if (!internal::check_nonzero_size(rstate))
+        throw exception::ZeroSize("qpp::apply_inplace()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::apply_inplace()");
+    // END EXCEPTION CHECKS
+
+    idx N = internal::get_num_subsys(static_cast<idx>(rstate.rows()), d);
+    std::vector<idx> dims(N, d); // local dimensions vector
+
+    apply_inplace(rstate, rA, subsys, dims);
+}
+
 /**
 * \brief Applies the channel specified by the set of Kraus operators \a Ks
 * to the density matrix \a A
@@ -612,18 +645,15 @@ cmat apply(const Eigen::MatrixBase<Derived>& A,
     // END EXCEPTION CHECKS
 
     cmat result = cmat::Zero(rA.rows(), rA.rows());
+    cmat tmp(rA.rows(), rA.rows());
 
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
+    // the matrix products are themselves parallelized (and blocked) by Eigen,
+    // so the Kraus operators are accumulated one at a time, with no
+    // temporaries other than tmp
     for (idx i = 0; i < Ks.size(); ++i)
     {
-#ifdef WITH_OPENMP_
-#pragma omp critical
-#endif // WITH_OPENMP_
-        {
-            result += Ks[i] * rA * adjoint(Ks[i]);
-        }
+        tmp.noalias() = Ks[i] * rA;
+        result.noalias() += tmp * adjoint(Ks[i]);
     }
 
     return result;
@@ -685,10 +715,29 @@ cmat apply(const Eigen::MatrixBase<Derived>& A,
             throw exception::DimsNotEqual("qpp::apply()");
     // END EXCEPTION CHECKS
 
-    cmat result = cmat::Zero(rA.rows(), rA.rows());
+    idx DA = static_cast<idx>(Ks[0].rows());
 
-    for (idx i = 0; i < Ks.size(); ++i)
-        result += apply(rA, Ks[i], subsys, dims);
+    std::vector<idx> offA = internal::get_subsys_offsets(subsys, dims);
+    std::vector<idx> ob = internal::get_subsys_offsets(
+            complement(subsys, dims.size()), dims);
+    cmat result = rA;
+
+    // few Kraus operators on a large subsystem, sum K B K^dagger over the
+    // Kraus operators for every block B, in a single pass over the result
+    if (DA > 2 * Ks.size())
+    {
+        internal::apply_kraus_rho_inplace(result, Ks, offA, ob);
+
+        return result;
+    }
+
+    // otherwise apply the superoperator of the channel (see
+    // qpp::kraus2super()), block by block, in a single pass over the result
+    cmat S = cmat::Zero(DA * DA, DA * DA);
+    for (auto&& K : Ks)
+        S += kron(K, conjugate(K));
+
+    internal::apply_super_rho_inplace(result, S, offA, ob);
 
     return result;
 }
@@ -728,6 +777,153 @@ cmat apply(const Eigen::MatrixBase<Derived>& A,
     return apply(rA, Ks, subsys, dims);
 }
 
+/**
+* \brief Applies the channel specified by the set of sparse Kraus operators
+* \a Ks to the density matrix \a A
+*
+* \param A Eigen expression
+* \param Ks Set of sparse Kraus operators
+* \return Output density matrix after the action of the channel
+*/
+template<typename Derived>
+cmat apply(const Eigen::MatrixBase<Derived>& A,
+           const std::vector<sp_cmat>& Ks)
+{
+    const cmat& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::apply()");
+    if (!internal::check_square_mat(rA))
+        throw exception::MatrixNotSquare("qpp::apply()");
+    if (Ks.size() == 0)
+        throw exception::ZeroSize("qpp::apply()");
+    if (!internal::check_square_mat(Ks[0]))
+        throw exception::MatrixNotSquare("qpp::apply()");
+    if (Ks[0].rows() != rA.rows())
+        throw exception::DimsMismatchMatrix("qpp::apply()");
+    for (auto&& it : Ks)
+        if (it.rows() != Ks[0].rows() || it.cols() != Ks[0].rows())
+            throw exception::DimsNotEqual("qpp::apply()");
+    // END EXCEPTION CHECKS
+
+    cmat result = cmat::Zero(rA.rows(), rA.rows());
+    cmat tmp(rA.rows(), rA.rows());
+
+    // sparse-dense products, O(nnz(K) * D) operations each
+    for (auto&& K : Ks)
+    {
+        tmp.noalias() = K * rA;
+        result.noalias() += tmp * K.adjoint();
+    }
+
+    return result;
+}
+
+/**
+* \brief Applies the channel specified by the set of sparse Kraus operators
+* \a Ks to the part \a subsys of the multi-partite density matrix \a A
+*
+* The Kraus operators are applied block by block, in sparse-dense products,
+* without being densified.
+*
+* \param A Eigen expression
+* \param Ks Set of sparse Kraus operators
+* \param subsys Subsystem indexes where the Kraus operators \a Ks are applied
+* \param dims Dimensions of the multi-partite system
+* \return Output density matrix after the action of the channel
+*/
+template<typename Derived>
+cmat apply(const Eigen::MatrixBase<Derived>& A,
+           const std::vector<sp_cmat>& Ks,
+           const std::vector<idx>& subsys,
+           const std::vector<idx>& dims)
+{
+    const cmat& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::apply()");
+
+    // check square matrix for the A
+    if (!internal::check_square_mat(rA))
+        throw exception::MatrixNotSquare("qpp::apply()");
+
+    // check that dimension is valid
+    if (!internal::check_dims(dims))
+        throw exception::DimsInvalid("qpp::apply()");
+
+    // check that dims match A matrix
+    if (!internal::check_dims_match_mat(dims, rA))
+        throw exception::DimsMismatchMatrix("qpp::apply()");
+
+    // check subsys is valid w.r.t. dims
+    if (!internal::check_subsys_match_dims(subsys, dims))
+        throw exception::SubsysMismatchDims("qpp::apply()");
+
+    std::vector<idx> subsys_dims(subsys.size());
+    for (idx i = 0; i < subsys.size(); ++i)
+        subsys_dims[i] = dims[subsys[i]];
+
+    // check the Kraus operators
+    if (Ks.size() == 0)
+        throw exception::ZeroSize("qpp::apply()");
+    if (!internal::check_square_mat(Ks[0]))
+        throw exception::MatrixNotSquare("qpp::apply()");
+    if (!internal::check_dims_match_mat(subsys_dims, Ks[0]))
+        throw exception::MatrixMismatchSubsys("qpp::apply()");
+    for (auto&& it : Ks)
+        if (it.rows() != Ks[0].rows() || it.cols() != Ks[0].rows())
+            throw exception::DimsNotEqual("qpp::apply()");
+    // END EXCEPTION CHECKS
+
+    cmat result = rA;
+    internal::apply_kraus_rho_inplace(
+            result, Ks, internal::get_subsys_offsets(subsys, dims),
+            internal::get_subsys_offsets(complement(subsys, dims.size()),
+                                         dims));
+
+    return result;
+}
+
+/**
+* \brief Applies the channel specified by the set of sparse Kraus operators
+* \a Ks to the part \a subsys of the multi-partite density matrix \a A
+*
+* \param A Eigen expression
+* \param Ks Set of sparse Kraus operators
+* \param subsys Subsystem indexes where the Kraus operators \a Ks are applied
+* \param d Subsystem dimensions
+* \return Output density matrix after the action of the channel
+*/
+template<typename Derived>
+cmat apply(const Eigen::MatrixBase<Derived>& A,
+           const std::vector<sp_cmat>& Ks,
+           const std::vector<idx>& subsys,
+           idx d = 2)
+{
+    const cmat& rA = A.derived();
+
+    // EXCEPTION CHECKS
+
+    // check zero sizes
+    if (!internal::check_nonzero_size(rA))
+        throw exception::ZeroSize("qpp::apply()");
+
+    // check valid dims
+    if (d < 2)
+        throw exception::DimsInvalid("qpp::apply()");
+    // END EXCEPTION CHECKS
+
+    idx N = internal::get_num_subsys(static_cast<idx>(rA.rows()), d);
+    std::vector<idx> dims(N, d); // local dimensions vector
+
+    return apply(rA, Ks, subsys, dims);
+}
+
 /**
 * \brief Superoperator matrix
 *
@@ -756,44 +952,25 @@ inline cmat kraus2super(const std::vector<cmat>& Ks)
 
     idx D = static_cast<idx>(Ks[0].rows());
 
+    // result(ab, mn) = <a|E(|m><n|)|b>, i.e.
+    // result = sum_i kron(Ks[i], conjugate(Ks[i])), computed block by block
+    std::vector<cmat> Ksbar(Ks.size());
+    for (idx i = 0; i < Ks.size(); ++i)
+        Ksbar[i] = conjugate(Ks[i]);
+
     cmat result(D * D, D * D);
-    cmat MN = cmat::Zero(D, D);
-    bra A = bra::Zero(D);
-    ket B = ket::Zero(D);
-    cmat EMN = cmat::Zero(D, D);
 
 #ifdef WITH_OPENMP_
 #pragma omp parallel for collapse(2)
 #endif // WITH_OPENMP_
     for (idx m = 0; m < D; ++m)
     {
-        for (idx n = 0; n < D; ++n)
+        for (idx a = 0; a < D; ++a)
         {
-#ifdef WITH_OPENMP_
-#pragma omp critical
-#endif // WITH_OPENMP_
-            {
-                // compute E(|m><n|)
-                MN(m, n) = 1;
-                for (idx i = 0; i < Ks.size(); ++i)
-                    EMN += Ks[i] * MN * adjoint(Ks[i]);
-                MN(m, n) = 0;
-
-                for (idx a = 0; a < D; ++a)
-                {
-                    A(a) = 1;
-                    for (idx b = 0; b < D; ++b)
-                    {
-                        // compute result(ab,mn)=<a|E(|m><n)|b>
-                        B(b) = 1;
-                        result(a * D + b, m * D + n) =
-                                static_cast<cmat>(A * EMN * B).value();
-                        B(b) = 0;
-                    }
-                    A(a) = 0;
-                }
-                EMN = cmat::Zero(D, D);
-            }
+            auto block = result.block(a * D, m * D, D, D);
+            block = Ks[0](a, m) * Ksbar[0];
+            for (idx i = 1; i < Ks.size(); ++i)
+                block += Ks[i](a, m) * Ksbar[i];
         }
     }
 
@@ -832,29 +1009,15 @@ inline cmat kraus2choi(const std::vector<cmat>& Ks)
 
     idx D = static_cast<idx>(Ks[0].rows());
 
-    // construct the D x D \sum |jj> vector
-    // (un-normalized maximally entangled state)
-    cmat MES = cmat::Zero(D * D, 1);
-    for (idx a = 0; a < D; ++a)
-        MES(a * D + a) = 1;
-
-    cmat Omega = MES * adjoint(MES);
-
-    cmat result = cmat::Zero(D * D, D * D);
-
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
+    // result = sum_i |K_i>><<K_i|, where |K_i>> = (I x K_i) sum_j |jj> is the
+    // column-major vectorization of K_i, computed as a single product
+    // M * adjoint(M), with the |K_i>> as columns of M
+    cmat M(D * D, Ks.size());
     for (idx i = 0; i < Ks.size(); ++i)
-    {
-#ifdef WITH_OPENMP_
-#pragma omp critical
-#endif // WITH_OPENMP_
-        {
-            result += kron(cmat::Identity(D, D), Ks[i]) * Omega
-                      * adjoint(kron(cmat::Identity(D, D), Ks[i]));
-        }
-    }
+        M.col(i) = Eigen::Map<const ket>(Ks[i].data(), D * D);
+
+    cmat result(D * D, D * D);
+    result.noalias() = M * adjoint(M);
 
     return result;
 }
@@ -923,14 +1086,10 @@ inline cmat choi2super(const cmat& A)
 
     cmat result(D * D, D * D);
 
-#ifdef WITH_OPENMP_
-#pragma omp parallel for collapse(4)
-#endif // WITH_OPENMP_
-    for (idx a = 0; a < D; ++a)
-        for (idx b = 0; b < D; ++b)
-            for (idx m = 0; m < D; ++m)
-                for (idx n = 0; n < D; ++n)
-                    result(a * D + b, m * D + n) = A(m * D + a, n * D + b);
+    // result(a * D + b, m * D + n) = A(m * D + a, n * D + b), as a tensor
+    // transpose of the column-major storage
+    internal::TensorTranspose(std::vector<idx>(4, D), {2, 0, 3, 1})
+            .execute(A.data(), result.data());
 
     return result;
 }
@@ -958,14 +1117,10 @@ inline cmat super2choi(const cmat& A)
 
     cmat result(D * D, D * D);
 
-#ifdef WITH_OPENMP_
-#pragma omp parallel for collapse(4)
-#endif // WITH_OPENMP_
-    for (idx a = 0; a < D; ++a)
-        for (idx b = 0; b < D; ++b)
-            for (idx m = 0; m < D; ++m)
-                for (idx n = 0; n < D; ++n)
-                    result(m * D + a, n * D + b) = A(a * D + b, m * D + n);
+    // result(m * D + a, n * D + b) = A(a * D + b, m * D + n), as a tensor
+    // transpose of the column-major storage
+    internal::TensorTranspose(std::vector<idx>(4, D), {1, 3, 0, 2})
+            .execute(A.data(), result.data());
 
     return result;
 }
@@ -1260,112 +1415,12 @@ dyn_mat<typename Derived::Scalar> ptrace(const Eigen::MatrixBase<Derived>& A,
         throw exception::SubsysMismatchDims("qpp::ptrace()");
     // END EXCEPTION CHECKS
 
-    idx D = static_cast<idx>(rA.rows());
-    idx N = dims.size();
-    idx Nsubsys = subsys.size();
-    idx Nsubsys_bar = N - Nsubsys;
-    idx Dsubsys = 1;
-    for (idx i = 0; i < Nsubsys; ++i)
-        Dsubsys *= dims[subsys[i]];
-    idx Dsubsys_bar = D / Dsubsys;
-
-    idx Cdims[maxn];
-    idx Csubsys[maxn];
-    idx Cdimssubsys[maxn];
-    idx Csubsys_bar[maxn];
-    idx Cdimssubsys_bar[maxn];
-
-    idx Cmidxcolsubsys_bar[maxn];
-
-    std::vector<idx> subsys_bar = complement(subsys, N);
-    std::copy(std::begin(subsys_bar), std::end(subsys_bar),
-              std::begin(Csubsys_bar));
-
-    for (idx i = 0; i < N; ++i)
-    {
-        Cdims[i] = dims[i];
-    }
-    for (idx i = 0; i < Nsubsys; ++i)
-    {
-        Csubsys[i] = subsys[i];
-        Cdimssubsys[i] = dims[subsys[i]];
-    }
-    for (idx i = 0; i < Nsubsys_bar; ++i)
-    {
-        Cdimssubsys_bar[i] = dims[subsys_bar[i]];
-    }
-
-    dyn_mat<typename Derived::Scalar> result =
-            dyn_mat<typename Derived::Scalar>(Dsubsys_bar, Dsubsys_bar);
-
     //************ ket ************//
     if (internal::check_cvector(rA)) // we have a ket
     {
         // check that dims match the dimension of A
         if (!internal::check_dims_match_cvect(dims, rA))
             throw exception::DimsMismatchCvector("qpp::ptrace()");
-
-        if (subsys.size() == dims.size())
-        {
-            result(0, 0) = (adjoint(rA) * rA).value();
-            return result;
-        }
-
-        if (subsys.size() == 0)
-            return rA * adjoint(rA);
-
-        auto worker = [&](idx i) noexcept -> typename Derived::Scalar
-        {
-            // use static allocation for speed!
-
-            idx Cmidxrow[maxn];
-            idx Cmidxcol[maxn];
-            idx Cmidxrowsubsys_bar[maxn];
-            idx Cmidxsubsys[maxn];
-
-            /* get the row multi-indexes of the complement */
-            internal::n2multiidx(i, Nsubsys_bar,
-                                 Cdimssubsys_bar, Cmidxrowsubsys_bar);
-            /* write them in the global row/col multi-indexes */
-            for (idx k = 0; k < Nsubsys_bar; ++k)
-            {
-                Cmidxrow[Csubsys_bar[k]] = Cmidxrowsubsys_bar[k];
-                Cmidxcol[Csubsys_bar[k]] = Cmidxcolsubsys_bar[k];
-            }
-            typename Derived::Scalar sm = 0;
-            for (idx a = 0; a < Dsubsys; ++a)
-            {
-                // get the multi-index over which we do the summation
-                internal::n2multiidx(a, Nsubsys, Cdimssubsys, Cmidxsubsys);
-                // write it into the global row/col multi-indexes
-                for (idx k = 0; k < Nsubsys; ++k)
-                    Cmidxrow[Csubsys[k]] = Cmidxcol[Csubsys[k]]
-                            = Cmidxsubsys[k];
-
-                // now do the sum
-                sm += rA(internal::multiidx2n(Cmidxrow, N, Cdims)) *
-                      std::conj(rA(internal::multiidx2n(Cmidxcol, N,
-                                                        Cdims)));
-            }
-
-            return sm;
-        }; /* end worker */
-
-        for (idx j = 0; j < Dsubsys_bar; ++j) // column major order for speed
-        {
-            // compute the column multi-indexes of the complement
-            internal::n2multiidx(j, Nsubsys_bar,
-                                 Cdimssubsys_bar, Cmidxcolsubsys_bar);
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
-            for (idx i = 0; i < Dsubsys_bar; ++i)
-            {
-                result(i, j) = worker(i);
-            }
-        }
-
-        return result;
     }
         //************ density matrix ************//
     else if (internal::check_square_mat(rA)) // we have a density operator
@@ -1373,71 +1428,12 @@ dyn_mat<typename Derived::Scalar> ptrace(const Eigen::MatrixBase<Derived>& A,
         // check that dims match the dimension of A
         if (!internal::check_dims_match_mat(dims, rA))
             throw exception::DimsMismatchMatrix("qpp::ptrace()");
-
-        if (subsys.size() == dims.size())
-        {
-            result(0, 0) = rA.trace();
-            return result;
-        }
-
-        if (subsys.size() == 0)
-            return rA;
-
-        auto worker = [&](idx i) noexcept -> typename Derived::Scalar
-        {
-            // use static allocation for speed!
-
-            idx Cmidxrow[maxn];
-            idx Cmidxcol[maxn];
-            idx Cmidxrowsubsys_bar[maxn];
-            idx Cmidxsubsys[maxn];
-
-            /* get the row/col multi-indexes of the complement */
-            internal::n2multiidx(i, Nsubsys_bar,
-                                 Cdimssubsys_bar, Cmidxrowsubsys_bar);
-            /* write them in the global row/col multi-indexes */
-            for (idx k = 0; k < Nsubsys_bar; ++k)
-            {
-                Cmidxrow[Csubsys_bar[k]] = Cmidxrowsubsys_bar[k];
-                Cmidxcol[Csubsys_bar[k]] = Cmidxcolsubsys_bar[k];
-            }
-            typename Derived::Scalar sm = 0;
-            for (idx a = 0; a < Dsubsys; ++a)
-            {
-                // get the multi-index over which we do the summation
-                internal::n2multiidx(a, Nsubsys, Cdimssubsys, Cmidxsubsys);
-                // write it into the global row/col multi-indexes
-                for (idx k = 0; k < Nsubsys; ++k)
-                    Cmidxrow[Csubsys[k]] = Cmidxcol[Csubsys[k]]
-                            = Cmidxsubsys[k];
-
-                // now do the sum
-                sm += rA(internal::multiidx2n(Cmidxrow, N, Cdims),
-                         internal::multiidx2n(Cmidxcol, N, Cdims));
-            }
-
-            return sm;
-        }; /* end worker */
-
-        for (idx j = 0; j < Dsubsys_bar; ++j) // column major order for speed
-        {
-            // compute the column multi-indexes of the complement
-            internal::n2multiidx(j, Nsubsys_bar,
-                                 Cdimssubsys_bar, Cmidxcolsubsys_bar);
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
-            for (idx i = 0; i < Dsubsys_bar; ++i)
-            {
-                result(i, j) = worker(i);
-            }
-        }
-
-        return result;
     }
         //************ Exception: not ket nor density matrix ************//
     else
         throw exception::MatrixNotSquareNorCvector("qpp::ptrace()");
+
+    return PtracePlan(subsys, dims).execute(rA);
 }
 
 /**
@@ -1514,68 +1510,12 @@ dyn_mat<typename Derived::Scalar> ptranspose(
         throw exception::SubsysMismatchDims("qpp::ptranspose()");
     // END EXCEPTION CHECKS
 
-    idx D = static_cast<idx>(rA.rows());
-    idx N = dims.size();
-    idx Nsubsys = subsys.size();
-    idx Cdims[maxn];
-    idx Cmidxcol[maxn];
-    idx Csubsys[maxn];
-
-    // copy dims in Cdims and subsys in Csubsys
-    for (idx i = 0; i < N; ++i)
-        Cdims[i] = dims[i];
-    for (idx i = 0; i < Nsubsys; ++i)
-        Csubsys[i] = subsys[i];
-
-    dyn_mat<typename Derived::Scalar> result(D, D);
-
     //************ ket ************//
     if (internal::check_cvector(rA)) // we have a ket
     {
         // check that dims match the dimension of A
         if (!internal::check_dims_match_cvect(dims, rA))
             throw exception::DimsMismatchCvector("qpp::ptranspose()");
-
-        if (subsys.size() == dims.size())
-            return (rA * adjoint(rA)).transpose();
-
-        if (subsys.size() == 0)
-            return rA * adjoint(rA);
-
-        auto worker = [&](idx i) noexcept -> typename Derived::Scalar
-        {
-            // use static allocation for speed!
-            idx midxcoltmp[maxn];
-            idx midxrow[maxn];
-
-            for (idx k = 0; k < N; ++k)
-                midxcoltmp[k] = Cmidxcol[k];
-
-            /* compute the row multi-index */
-            internal::n2multiidx(i, N, Cdims, midxrow);
-
-            for (idx k = 0; k < Nsubsys; ++k)
-                std::swap(midxcoltmp[Csubsys[k]], midxrow[Csubsys[k]]);
-
-            /* writes the result */
-            return rA(internal::multiidx2n(midxrow, N, Cdims)) *
-                   std::conj(rA(internal::multiidx2n(midxcoltmp, N,
-                                                     Cdims)));
-        }; /* end worker */
-
-        for (idx j = 0; j < D; ++j)
-        {
-            // compute the column multi-index
-            internal::n2multiidx(j, N, Cdims, Cmidxcol);
-
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
-            for (idx i = 0; i < D; ++i)
-                result(i, j) = worker(i);
-        }
-
-        return result;
     }
         //************ density matrix ************//
     else if (internal::check_square_mat(rA)) // we have a density operator
@@ -1583,50 +1523,12 @@ dyn_mat<typename Derived::Scalar> ptranspose(
         // check that dims match the dimension of A
         if (!internal::check_dims_match_mat(dims, rA))
             throw exception::DimsMismatchMatrix("qpp::ptranspose()");
-
-        if (subsys.size() == dims.size())
-            return rA.transpose();
-
-        if (subsys.size() == 0)
-            return rA;
-
-        auto worker = [&](idx i) noexcept -> typename Derived::Scalar
-        {
-            // use static allocation for speed!
-            idx midxcoltmp[maxn];
-            idx midxrow[maxn];
-
-            for (idx k = 0; k < N; ++k)
-                midxcoltmp[k] = Cmidxcol[k];
-
-            /* compute the row multi-index */
-            internal::n2multiidx(i, N, Cdims, midxrow);
-
-            for (idx k = 0; k < Nsubsys; ++k)
-                std::swap(midxcoltmp[Csubsys[k]], midxrow[Csubsys[k]]);
-
-            /* writes the result */
-            return rA(internal::multiidx2n(midxrow, N, Cdims),
-                      internal::multiidx2n(midxcoltmp, N, Cdims));
-        }; /* end worker */
-
-        for (idx j = 0; j < D; ++j)
-        {
-            // compute the column multi-index
-            internal::n2multiidx(j, N, Cdims, Cmidxcol);
-
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
-            for (idx i = 0; i < D; ++i)
-                result(i, j) = worker(i);
-        }
-
-        return result;
     }
         //************ Exception: not ket nor density matrix ************//
     else
         throw exception::MatrixNotSquareNorCvector("qpp::ptranspose()");
+
+    return PtransposePlan(subsys, dims).execute(rA);
 }
 
 /**
@@ -1706,113 +1608,25 @@ dyn_mat<typename Derived::Scalar> syspermute(
         throw exception::PermMismatchDims("qpp::syspermute()");
     // END EXCEPTION CHECKS
 
-    idx D = static_cast<idx>(rA.rows());
-    idx N = dims.size();
-
-    dyn_mat<typename Derived::Scalar> result;
-
     //************ ket ************//
-    if (internal::check_cvector(rA)) // we have a column vector
+    if (internal::check_cvector(rA)) // we have a ket
     {
-        idx Cdims[maxn];
-        idx Cperm[maxn];
-
-        // check that dims match the dimension of rA
+        // check that dims match the dimension of A
         if (!internal::check_dims_match_cvect(dims, rA))
             throw exception::DimsMismatchCvector("qpp::syspermute()");
-
-        // copy dims in Cdims and perm in Cperm
-        for (idx i = 0; i < N; ++i)
-        {
-            Cdims[i] = dims[i];
-            Cperm[i] = perm[i];
-        }
-        result.resize(D, 1);
-
-        auto worker = [&Cdims, &Cperm, N](idx i) noexcept -> idx
-        {
-            // use static allocation for speed,
-            // double the size for matrices reshaped as vectors
-            idx midx[maxn];
-            idx midxtmp[maxn];
-            idx permdims[maxn];
-
-            /* compute the multi-index */
-            internal::n2multiidx(i, N, Cdims, midx);
-
-            for (idx k = 0; k < N; ++k)
-            {
-                permdims[k] = Cdims[Cperm[k]]; // permuted dimensions
-                midxtmp[k] = midx[Cperm[k]];// permuted multi-indexes
-            }
-
-            return internal::multiidx2n(midxtmp, N, permdims);
-        }; /* end worker */
-
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
-        for (idx i = 0; i < D; ++i)
-            result(worker(i)) = rA(i);
-
-        return result;
     }
         //************ density matrix ************//
     else if (internal::check_square_mat(rA)) // we have a density operator
     {
-        idx Cdims[2 * maxn];
-        idx Cperm[2 * maxn];
-
-        // check that dims match the dimension of rA
+        // check that dims match the dimension of A
         if (!internal::check_dims_match_mat(dims, rA))
             throw exception::DimsMismatchMatrix("qpp::syspermute()");
-
-        // copy dims in Cdims and perm in Cperm
-        for (idx i = 0; i < N; ++i)
-        {
-            Cdims[i] = dims[i];
-            Cdims[i + N] = dims[i];
-            Cperm[i] = perm[i];
-            Cperm[i + N] = perm[i] + N;
-        }
-        result.resize(D * D, 1);
-        // map A to a column vector
-        dyn_mat<typename Derived::Scalar> vectA =
-                Eigen::Map<dyn_mat<typename Derived::Scalar >>(
-                        const_cast<typename Derived::Scalar*>(rA.data()),
-                        D * D, 1);
-
-        auto worker = [&Cdims, &Cperm, N](idx i) noexcept -> idx
-        {
-            // use static allocation for speed,
-            // double the size for matrices reshaped as vectors
-            idx midx[2 * maxn];
-            idx midxtmp[2 * maxn];
-            idx permdims[2 * maxn];
-
-            /* compute the multi-index */
-            internal::n2multiidx(i, 2 * N, Cdims, midx);
-
-            for (idx k = 0; k < 2 * N; ++k)
-            {
-                permdims[k] = Cdims[Cperm[k]]; // permuted dimensions
-                midxtmp[k] = midx[Cperm[k]];// permuted multi-indexes
-            }
-
-            return internal::multiidx2n(midxtmp, 2 * N, permdims);
-        }; /* end worker */
-
-#ifdef WITH_OPENMP_
-#pragma omp parallel for
-#endif // WITH_OPENMP_
-        for (idx i = 0; i < D * D; ++i)
-            result(worker(i)) = rA(i);
-
-        return reshape(result, D, D);
     }
         //************ Exception: not ket nor density matrix ************//
     else
         throw exception::MatrixNotSquareNorCvector("qpp::syspermute()");
+
+    return SyspermutePlan(perm, dims).execute(rA);
 }
 
 /**
@@ -43,6 +43,7 @@
 
 // standard C++ library headers
 #include <algorithm>
+#include <bitset>
 #include <cassert>
 #include <chrono>
 #include <cmath>
@@ -56,6 +57,7 @@
 #include <iomanip>
 #include <iterator>
 #include <limits>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <ostream>
@@ -70,6 +72,7 @@
 
 // Eigen headers
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 #include <Eigen/SVD>
 
 // Quantum++ headers
@@ -81,6 +84,14 @@
 #include "traits.h"
 #include "classes/idisplay.h"
 #include "internal/util.h"
+#include "internal/classes/gate_index.h"
+#include "internal/classes/tensor_transpose.h"
+#include "internal/classes/alias_table.h"
+#include "internal/classes/pauli_string.h"
+#include "internal/simd.h"
+#include "internal/kernels.h"
+#include "internal/krylov.h"
+#include "internal/randomized_svd.h"
 #include "internal/classes/iomanip.h"
 #include "input_output.h"
 
@@ -89,15 +100,24 @@
 #include "classes/init.h"
 #include "functions.h"
 #include "classes/codes.h"
+#include "classes/ctrl_gate.h"
 #include "classes/gates.h"
 #include "classes/states.h"
 #include "classes/random_devices.h"
+#include "classes/plans.h"
+#include "classes/measurement.h"
+#include "classes/spectrum.h"
 
 // do not change the order in this group, inter-dependencies
 #include "statistics.h"
 #include "operations.h"
 #include "entropies.h"
 #include "entanglement.h"
+#include "classes/channel.h"
+#include "classes/pauli_sum.h"
+#include "classes/diagonal_gate.h"
+#include "classes/monomial_gate.h"
+#include "classes/kron_operator.h"
 
 // the ones below can be in any order, no inter-dependencies
 #include "random.h"
@@ -64,6 +64,11 @@ using cmat = Eigen::MatrixXcd;
 */
 using dmat = Eigen::MatrixXd;
 
+/**
+* \brief Complex (double precision) Eigen sparse matrix
+*/
+using sp_cmat = Eigen::SparseMatrix<cplx>;
+
 /**
 * \brief Dynamic Eigen matrix over the field specified by \a Scalar
 *
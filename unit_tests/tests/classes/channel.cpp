@@ -0,0 +1,120 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "qpp.h"
+
+using namespace qpp;
+
+// Unit testing "classes/channel.h"
+
+
+/******************************************************************************/
+/// BEGIN template<typename Derived> cmat qpp::Channel::apply(
+///       const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<idx>& subsys,
+///       const std::vector<idx>& dims) const
+TEST(qpp_Channel_apply, AllTests)
+{
+    // the same channel applied to different subsystems, compare with the
+    // Kraus operators applied one by one
+    std::vector<idx> dims{2, 3, 2, 3};
+    std::vector<cmat> Ks = randkraus(3, 3);
+    Channel channel(Ks);
+    cmat rho = randrho(36);
+    for (idx q : std::vector<idx>{1, 3})
+    {
+        cmat result = cmat::Zero(36, 36);
+        for (auto&& K : Ks)
+            result += apply(rho, K, {q}, dims);
+        EXPECT_NEAR(0, norm(channel.apply(rho, {q}, dims) - result), 1e-7);
+    }
+
+    // channel on two subsystems, in reversed order
+    Ks = randkraus(2, 6);
+    Channel channel2(Ks);
+    EXPECT_NEAR(0, norm(channel2.apply(rho, {3, 0}, dims) -
+                        apply(rho, Ks, {3, 0}, dims)), 1e-7);
+
+    // the whole system
+    Ks = randkraus(4, 3);
+    Channel channel3(Ks);
+    cmat sigma = randrho(3);
+    EXPECT_NEAR(0, norm(channel3.apply(sigma) - apply(sigma, Ks)), 1e-7);
+
+    // dimension mismatch
+    EXPECT_THROW(channel.apply(rho, {0}, dims),
+                 exception::MatrixMismatchSubsys);
+    EXPECT_THROW(channel.apply(randrho(8), {0}, dims),
+                 exception::DimsMismatchMatrix);
+    EXPECT_THROW(channel3.apply(rho), exception::DimsMismatchMatrix);
+    EXPECT_THROW(Channel(std::vector<cmat>{}), exception::ZeroSize);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> cmat qpp::Channel::apply(
+///       const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<idx>& subsys, idx d = 2) const
+TEST(qpp_Channel_apply_qubits, AllTests)
+{
+    // depolarizing channel on every qubit, the maximally mixed state is a
+    // fixed point
+    double p = 0.25;
+    Channel dep({std::sqrt(1 - 3 * p / 4) * gt.Id2, std::sqrt(p / 4) * gt.X,
+                 std::sqrt(p / 4) * gt.Y, std::sqrt(p / 4) * gt.Z});
+    cmat rho = gt.Id(16) / 16;
+    for (idx q = 0; q < 4; ++q)
+        EXPECT_NEAR(0, norm(dep.apply(rho, {q}) - rho), 1e-7);
+
+    // product state, the channel acts only on its qubit
+    cmat A = randrho(2), B = randrho(2), C = randrho(2);
+    EXPECT_NEAR(0, norm(dep.apply(kron(A, B, C), {1}) -
+                        kron(A, (1 - p) * B + p * gt.Id2 / 2, C)), 1e-7);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> void qpp::Channel::apply_inplace(
+///       Eigen::MatrixBase<Derived>& A,
+///       const std::vector<idx>& subsys,
+///       const std::vector<idx>& dims) const
+TEST(qpp_Channel_apply_inplace, AllTests)
+{
+    // noisy layer, must agree with qpp::apply()
+    std::vector<cmat> Ks = randkraus(4, 2);
+    Channel channel(Ks);
+    cmat rho = randrho(32);
+    cmat result = rho;
+    for (idx q = 0; q < 5; ++q)
+    {
+        channel.apply_inplace(rho, {q});
+        result = apply(result, Ks, {q});
+    }
+    EXPECT_NEAR(0, norm(rho - result), 1e-7);
+    EXPECT_NEAR(1, std::abs(trace(rho)), 1e-7);
+
+    // qutrits
+    std::vector<idx> dims{3, 3, 3};
+    Ks = randkraus(5, 9);
+    Channel channel2(Ks);
+    rho = randrho(27);
+    result = apply(rho, Ks, {2, 0}, dims);
+    channel2.apply_inplace(rho, {2, 0}, dims);
+    EXPECT_NEAR(0, norm(rho - result), 1e-7);
+}
+/******************************************************************************/
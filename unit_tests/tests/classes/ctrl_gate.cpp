@@ -0,0 +1,134 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "qpp.h"
+
+using namespace qpp;
+
+// Unit testing "classes/ctrl_gate.h"
+
+/******************************************************************************/
+/// BEGIN cmat qpp::CtrlGate::to_dense() const
+TEST(qpp_CtrlGate_to_dense, AllTests)
+{
+    // controlled 2-qubit gate, against the matrix built element by element
+    std::vector<idx> dims{2, 2, 2, 2, 2};
+    cmat U = randU(4);
+    CtrlGate C(U, {0, 3}, {4, 1}, dims);
+    cmat expected = cmat::Zero(32, 32);
+    for (idx m = 0; m < 32; ++m)
+    {
+        std::vector<idx> midx = n2multiidx(m, dims);
+        if (midx[0] == 1 && midx[3] == 1)
+        {
+            idx a = midx[4] * 2 + midx[1];
+            for (idx b = 0; b < 4; ++b)
+            {
+                std::vector<idx> out = midx;
+                out[4] = b / 2;
+                out[1] = b % 2;
+                expected(multiidx2n(out, dims), m) = U(b, a);
+            }
+        } else
+            expected(m, m) = 1;
+    }
+    EXPECT_NEAR(0, norm(C.to_dense() - expected), 1e-7);
+    EXPECT_NEAR(0, norm(gt.CTRL(U, {0, 3}, {4, 1}, 5) - expected), 1e-7);
+    EXPECT_EQ(32u, C.get_D());
+
+    // qutrits, the gate to the power of the common value of the controls
+    dims = {3, 3, 3};
+    cmat V = randU(3);
+    expected = cmat::Zero(27, 27);
+    for (idx m = 0; m < 27; ++m)
+    {
+        std::vector<idx> midx = n2multiidx(m, dims);
+        cmat P = powm(V, midx[2]);
+        for (idx b = 0; b < 3; ++b)
+        {
+            std::vector<idx> out = midx;
+            out[0] = b;
+            expected(multiidx2n(out, dims), m) = P(b, midx[0]);
+        }
+    }
+    EXPECT_NEAR(0, norm(gt.CTRL_op(V, {2}, {0}, 3, 3).to_dense() - expected),
+                1e-7);
+
+    // no controls, the same as qpp::Gates::expandout()
+    EXPECT_NEAR(0, norm(gt.expandout_op(gt.Xd(3), 1, {2, 3, 2}).to_dense() -
+                        kron(gt.Id2, gt.Xd(3), gt.Id2)), 1e-7);
+    EXPECT_NEAR(0, norm(gt.expandout_op(gt.H, 2, 4).to_dense() -
+                        gt.expandout(gt.H, 2, 4)), 1e-7);
+
+    // exceptions
+    EXPECT_THROW(CtrlGate(U, {0}, {1}, {2, 2, 2}),
+                 exception::MatrixMismatchSubsys);
+    EXPECT_THROW(CtrlGate(gt.X, {0, 1}, {2}, {2, 3, 2}),
+                 exception::DimsNotEqual);
+    EXPECT_THROW(CtrlGate(gt.X, {0}, {0}, {2, 2}),
+                 exception::SubsysMismatchDims);
+    EXPECT_THROW(gt.expandout_op(gt.X, 3, 3), exception::OutOfRange);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> cmat qpp::CtrlGate::apply(
+///       const Eigen::MatrixBase<Derived>& state) const
+TEST(qpp_CtrlGate_apply, AllTests)
+{
+    // kets and density matrices, against the dense matrix
+    std::vector<idx> dims{2, 3, 3, 2};
+    cmat V = randU(4);
+    CtrlGate C(V, {1, 2}, {3, 0}, dims);
+    cmat full = C.to_dense();
+    ket psi = randket(36);
+    cmat rho = randrho(36);
+    EXPECT_NEAR(0, norm(C.apply(psi) - full * psi), 1e-7);
+    EXPECT_NEAR(0, norm(C.apply(rho) - full * rho * adjoint(full)), 1e-7);
+    cmat rho_out = rho;
+    C.apply_inplace(rho_out);
+    EXPECT_NEAR(0, norm(rho_out - full * rho * adjoint(full)), 1e-7);
+
+    // exceptions
+    EXPECT_THROW(C.apply(randket(12)), exception::DimsMismatchCvector);
+    EXPECT_THROW(C.apply(randrho(12)), exception::DimsMismatchMatrix);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> cmat qpp::CtrlGate::operator*(
+///       const Eigen::MatrixBase<Derived>& A) const
+TEST(qpp_CtrlGate_operator_times, AllTests)
+{
+    // matrix product, column by column
+    idx N = 6;
+    CtrlGate C = gt.CTRL_op(gt.H, {0, 4}, {2}, N);
+    cmat full = gt.CTRL(gt.H, {0, 4}, {2}, N);
+    ket psi = randket(64);
+    EXPECT_NEAR(0, norm(C * psi - full * psi), 1e-7);
+    cmat A = rand<cmat>(64, 5);
+    EXPECT_NEAR(0, norm(C * A - full * A), 1e-7);
+
+    // expanded out gate
+    CtrlGate E = gt.expandout_op(gt.Y, 3, N);
+    EXPECT_NEAR(0, norm(E * psi - gt.expandout(gt.Y, 3, N) * psi), 1e-7);
+
+    // exceptions
+    EXPECT_THROW(C * randket(32), exception::DimsMismatchMatrix);
+}
+/******************************************************************************/
@@ -0,0 +1,141 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "qpp.h"
+
+using namespace qpp;
+
+// Unit testing "classes/diagonal_gate.h"
+
+/******************************************************************************/
+/// BEGIN template<typename Derived> qpp::DiagonalGate&
+///       qpp::DiagonalGate::add(const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<idx>& subsys)
+TEST(qpp_DiagonalGate_add, AllTests)
+{
+    // a layer of CZs on a ring of 5 qubits, the diagonal is the gates
+    // applied one by one to the (unnormalized) all ones vector
+    idx N = 5;
+    DiagonalGate layer(std::vector<idx>(N, 2));
+    ket diag = ket::Ones(32);
+    for (idx i = 0; i < N; ++i)
+    {
+        layer.add(gt.CZ, {i, (i + 1) % N});
+        diag = apply(diag, gt.CZ, {i, (i + 1) % N});
+    }
+    EXPECT_NEAR(0, norm(layer.get_diag() - diag), 1e-7);
+    EXPECT_EQ(N, layer.get_num_factors());
+
+    // single qubit phases are absorbed into the factors that cover them
+    layer.add(gt.T, {2}).add(gt.S, {4});
+    EXPECT_EQ(N, layer.get_num_factors());
+    diag = apply(apply(diag, gt.T, {2}), gt.S, {4});
+    EXPECT_NEAR(0, norm(layer.get_diag() - diag), 1e-7);
+    EXPECT_NEAR(0, norm(layer.to_dense() - cmat(diag.asDiagonal())), 1e-7);
+
+    // qudits, subsystems in reversed order, a factor covering previous ones
+    std::vector<idx> dims{3, 2, 3};
+    DiagonalGate G(dims);
+    G.add(gt.Zd(3), {2});
+    cmat Dg = cmat::Zero(6, 6);
+    for (idx i = 0; i < 6; ++i)
+        Dg(i, i) = std::exp(1_i * static_cast<double>(i * i));
+    G.add(Dg, {2, 1});
+    EXPECT_EQ(1u, G.get_num_factors());
+    diag = apply(apply(ket::Ones(18), gt.Zd(3), {2}, dims), Dg, {2, 1}, dims);
+    EXPECT_NEAR(0, norm(G.get_diag() - diag), 1e-7);
+
+    // fusion of two diagonal gates
+    DiagonalGate G2(dims);
+    G2.add(gt.Zd(3), {0});
+    G2.add(G);
+    diag = apply(diag, gt.Zd(3), {0}, dims);
+    EXPECT_NEAR(0, norm(G2.get_diag() - diag), 1e-7);
+
+    // exceptions
+    EXPECT_THROW(G.add(gt.H, {1}), exception::CustomException);
+    EXPECT_THROW(G.add(gt.Z, {0}), exception::MatrixMismatchSubsys);
+    EXPECT_THROW(G.add(DiagonalGate({2, 2})), exception::DimsNotEqual);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> qpp::DiagonalGate&
+///       qpp::DiagonalGate::add_ctrl(const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<idx>& ctrl, const std::vector<idx>& subsys)
+TEST(qpp_DiagonalGate_add_ctrl, AllTests)
+{
+    // controlled phases of the QFT on 4 qubits
+    idx N = 4;
+    DiagonalGate G(std::vector<idx>(N, 2));
+    ket diag = ket::Ones(16);
+    for (idx i = 0; i < N; ++i)
+        for (idx j = i + 1; j < N; ++j)
+        {
+            cmat R = cmat::Identity(2, 2);
+            R(1, 1) = std::exp(2 * pi * 1_i /
+                               std::pow(2., static_cast<double>(j - i + 1)));
+            G.add_ctrl(R, {j}, {i});
+            diag = applyCTRL(diag, R, {j}, {i});
+        }
+    EXPECT_NEAR(0, norm(G.get_diag() - diag), 1e-7);
+
+    // qudits, two controls
+    DiagonalGate Gd({3, 3, 3});
+    Gd.add_ctrl(gt.Zd(3), {0, 2}, {1});
+    EXPECT_NEAR(0, norm(Gd.to_dense() - gt.CTRL(gt.Zd(3), {0, 2}, {1}, 3, 3)),
+                1e-7);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> cmat qpp::DiagonalGate::apply(
+///       const Eigen::MatrixBase<Derived>& A) const
+TEST(qpp_DiagonalGate_apply, AllTests)
+{
+    // graph state on 6 qubits, against the gate by gate construction
+    idx N = 6;
+    DiagonalGate layer(std::vector<idx>(N, 2));
+    ket psi = st.plus(N);
+    ket expected = psi;
+    for (idx i = 0; i < N; ++i)
+        for (idx j = i + 1; j < N; j += 2)
+        {
+            layer.add(gt.CZ, {i, j});
+            expected = applyCTRL(expected, gt.Z, {i}, {j});
+        }
+    EXPECT_NEAR(0, norm(layer.apply(psi) - expected), 1e-7);
+
+    // density matrices, qudits, only the first subsystems acted upon
+    std::vector<idx> dims{3, 2, 4};
+    DiagonalGate G(dims);
+    G.add(gt.Zd(3), {0}).add_ctrl(gt.Zd(3), {1}, {0});
+    cmat U = G.to_dense();
+    cmat rho = randrho(24);
+    EXPECT_NEAR(0, norm(G.apply(rho) - U * rho * adjoint(U)), 1e-7);
+    psi = randket(24);
+    ket psi_out = psi;
+    G.apply_inplace(psi_out);
+    EXPECT_NEAR(0, norm(psi_out - U * psi), 1e-7);
+    EXPECT_NEAR(0, norm(G.get_diag() - U.diagonal()), 1e-7);
+
+    // exceptions
+    EXPECT_THROW(G.apply(randket(12)), exception::DimsMismatchCvector);
+    EXPECT_THROW(G.apply(randrho(12)), exception::DimsMismatchMatrix);
+}
+/******************************************************************************/
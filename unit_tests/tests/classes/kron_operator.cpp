@@ -0,0 +1,104 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "qpp.h"
+
+using namespace qpp;
+
+// Unit testing "classes/kron_operator.h"
+
+/******************************************************************************/
+/// BEGIN cmat qpp::KronOperator::to_dense() const
+TEST(qpp_KronOperator_to_dense, AllTests)
+{
+    // Kronecker power of qubit gates
+    for (idx n = 1; n < 6; ++n)
+    {
+        KronOperator K(gt.H, n);
+        EXPECT_EQ(n, K.get_dims().size());
+        EXPECT_EQ(static_cast<idx>(std::pow(2, n)), K.get_D());
+        EXPECT_NEAR(0, norm(K.to_dense() - kronpow(gt.H, n)), 1e-7);
+    }
+
+    // mixed dimensions, compared with the product from left to right
+    std::vector<cmat> As{randU(2), randU(3), gt.Id(4), randU(2), randU(3)};
+    cmat expected = As[0];
+    for (idx i = 1; i < As.size(); ++i)
+        expected = kron(expected, As[i]);
+    KronOperator K(As);
+    EXPECT_EQ((std::vector<idx>{2, 3, 4, 2, 3}), K.get_dims());
+    EXPECT_NEAR(0, norm(K.to_dense() - expected), 1e-7);
+
+    // exceptions
+    EXPECT_THROW(KronOperator(std::vector<cmat>{}), exception::ZeroSize);
+    EXPECT_THROW(KronOperator(gt.H, 0), exception::OutOfRange);
+    EXPECT_THROW(KronOperator({gt.H, cmat::Zero(2, 3)}),
+                 exception::MatrixNotSquare);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> cmat qpp::KronOperator::apply(
+///       const Eigen::MatrixBase<Derived>& state) const
+TEST(qpp_KronOperator_apply, AllTests)
+{
+    // qubits, against the dense Kronecker power
+    KronOperator Hn(gt.H, 6);
+    cmat H6 = kronpow(gt.H, 6);
+    ket psi = randket(64);
+    EXPECT_NEAR(0, norm(Hn.apply(psi) - H6 * psi), 1e-7);
+    cmat rho = randrho(64);
+    EXPECT_NEAR(0, norm(Hn.apply(rho) - H6 * rho * adjoint(H6)), 1e-7);
+
+    // mixed dimensions, with identity and permutation factors
+    std::vector<cmat> As{randU(3), gt.Id2, gt.Xd(3), randU(2)};
+    KronOperator K(As);
+    cmat A = kron(As);
+    psi = randket(36);
+    EXPECT_NEAR(0, norm(K.apply(psi) - A * psi), 1e-7);
+    rho = randrho(36);
+    cmat rho_out = rho;
+    K.apply_inplace(rho_out);
+    EXPECT_NEAR(0, norm(rho_out - A * rho * adjoint(A)), 1e-7);
+
+    // exceptions
+    EXPECT_THROW(K.apply(randket(16)), exception::DimsMismatchCvector);
+    EXPECT_THROW(K.apply(randrho(16)), exception::DimsMismatchMatrix);
+    EXPECT_THROW(K.apply(cmat::Zero(36, 2)),
+                 exception::MatrixNotSquareNorCvector);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> cmat qpp::KronOperator::operator*(
+///       const Eigen::MatrixBase<Derived>& A) const
+TEST(qpp_KronOperator_operator_times, AllTests)
+{
+    std::vector<cmat> As{randU(2), randU(3), randU(2)};
+    KronOperator K(As);
+    cmat A = kron(As);
+
+    cmat B = rand<cmat>(12, 5);
+    EXPECT_NEAR(0, norm(K * B - A * B), 1e-7);
+    ket psi = randket(12);
+    EXPECT_NEAR(0, norm(K * psi - A * psi), 1e-7);
+
+    // exceptions
+    EXPECT_THROW(K * cmat::Zero(8, 2), exception::DimsMismatchMatrix);
+}
+/******************************************************************************/
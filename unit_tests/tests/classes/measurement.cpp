@@ -0,0 +1,143 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "qpp.h"
+
+using namespace qpp;
+
+// Unit testing "classes/measurement.h"
+
+
+/******************************************************************************/
+/// BEGIN cmat qpp::Measurement::get_state(idx i) const
+TEST(qpp_Measurement_get_state, AllTests)
+{
+    // Kraus operators on two subsystems, in reversed order, compare with
+    // explicit apply and ptrace
+    std::vector<idx> dims{2, 3, 2};
+    std::vector<cmat> Ks = randkraus(3, 4);
+    ket psi = randket(12);
+    cmat rho = randrho(12);
+    for (auto&& A : std::vector<cmat>{psi, rho})
+    {
+        Measurement m(A, Ks, {2, 0}, dims);
+        cmat rA = A.cols() == 1 ? cmat(prj(A) * std::pow(norm(A), 2)) : A;
+        for (idx i = 0; i < Ks.size(); ++i)
+        {
+            cmat tmp = apply(rA, Ks[i], {2, 0}, dims);
+            double p = std::abs(trace(tmp));
+            EXPECT_NEAR(p, m.get_probs()[i], 1e-7);
+            EXPECT_NEAR(0, norm(m.get_state(i) -
+                                ptrace(tmp, {0, 2}, dims) / p), 1e-7);
+        }
+    }
+
+    // orthonormal basis on a ket, the output states are kets
+    dims = {3, 2, 3};
+    psi = randket(18);
+    cmat V = randU(6);
+    Measurement mV(psi, V, {0, 1}, dims);
+    for (idx i = 0; i < 6; ++i)
+    {
+        ket v = V.col(i);
+        ket tmp = adjoint(kron(v, gt.Id(3))) * psi;
+        double p = std::pow(norm(tmp), 2);
+        EXPECT_NEAR(p, mV.get_probs()[i], 1e-7);
+        EXPECT_EQ(3, mV.get_state(i).rows());
+        EXPECT_EQ(1, mV.get_state(i).cols());
+        EXPECT_NEAR(0, norm(mV.get_state(i) - tmp / std::sqrt(p)), 1e-7);
+    }
+
+    // orthonormal basis on a density matrix
+    rho = randrho(18);
+    Measurement mVrho(rho, V, {1, 2}, dims);
+    for (idx i = 0; i < 6; ++i)
+    {
+        cmat tmp = apply(rho, prj(V.col(i)), {1, 2}, dims);
+        double p = std::abs(trace(tmp));
+        EXPECT_NEAR(p, mVrho.get_probs()[i], 1e-7);
+        EXPECT_NEAR(0, norm(mVrho.get_state(i) -
+                            ptrace(tmp, {1, 2}, dims) / p), 1e-7);
+    }
+
+    // non-normalized rank-1 POVM on a density matrix, the probabilities are
+    // <v|rho|v>, as for kets
+    cmat W = randn<cmat>(6, 2);
+    Measurement mWrho(rho, W, {1, 2}, dims);
+    cmat rho_subsys = ptrace(rho, {0}, dims);
+    for (idx i = 0; i < 2; ++i)
+        EXPECT_NEAR(std::abs((adjoint(W.col(i)) * rho_subsys *
+                              W.col(i)).value()), mWrho.get_probs()[i], 1e-7);
+
+    // the whole system, the output states are 1 x 1
+    Measurement mall(rho, gt.Id(18), {0, 1, 2}, dims);
+    EXPECT_NEAR(1, mall.get_state(mall.get_result())(0, 0).real(), 1e-7);
+
+    // zero-probability outcomes yield zero states
+    psi = mket({0, 1});
+    Measurement m0(psi, {prj(mket({0})), prj(mket({1}))}, {0});
+    EXPECT_EQ(0u, m0.get_result());
+    EXPECT_EQ(0, norm(m0.get_state(1)));
+    EXPECT_NEAR(0, norm(m0.get_state(0) - prj(mket({1}))), 1e-7);
+
+    // out of range outcome
+    EXPECT_THROW(m0.get_state(2), exception::OutOfRange);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> qpp::Measurement::Measurement(
+///       const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<cmat>& Ks,
+///       const std::vector<idx>& subsys,
+///       const std::vector<idx>& dims)
+TEST(qpp_Measurement_Measurement, AllTests)
+{
+    // probabilities sum to 1, the result is a possible outcome
+    ket psi = randket(8);
+    std::vector<cmat> Ks = randkraus(5, 4);
+    Measurement m(psi, Ks, {0, 2});
+    double sum = 0;
+    for (auto&& p : m.get_probs())
+        sum += p;
+    EXPECT_EQ(5u, m.get_probs().size());
+    EXPECT_NEAR(1, sum, 1e-7);
+    EXPECT_GT(m.get_probs()[m.get_result()], 0);
+
+    // qudits
+    cmat rho = randrho(27);
+    Measurement mq(rho, randU(3), {1}, 3);
+    EXPECT_EQ(3u, mq.get_probs().size());
+    EXPECT_EQ(9, mq.get_state(0).rows());
+
+    // exceptions
+    EXPECT_THROW(Measurement(psi, std::vector<cmat>{}, {0}),
+                 exception::ZeroSize);
+    EXPECT_THROW(Measurement(psi, Ks, {0}), exception::DimsMismatchMatrix);
+    EXPECT_THROW(Measurement(psi, Ks, {0, 3}), exception::SubsysMismatchDims);
+    EXPECT_THROW(Measurement(psi, Ks, {0, 1}, 1), exception::DimsInvalid);
+    EXPECT_THROW(Measurement(randn<cmat>(4, 2), Ks, {0, 1}),
+                 exception::MatrixNotSquareNorCvector);
+    EXPECT_THROW(Measurement(psi, randn<cmat>(2, 2), {0, 1}),
+                 exception::DimsMismatchMatrix);
+    EXPECT_THROW(Measurement(psi, Ks, {0, 1}, std::vector<idx>{2, 3}),
+                 exception::DimsMismatchCvector);
+}
+/******************************************************************************/
@@ -0,0 +1,129 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "qpp.h"
+
+using namespace qpp;
+
+// Unit testing "classes/monomial_gate.h"
+
+/******************************************************************************/
+/// BEGIN template<typename Derived> explicit qpp::MonomialGate::MonomialGate(
+///       const Eigen::MatrixBase<Derived>& A)
+TEST(qpp_MonomialGate_MonomialGate, AllTests)
+{
+    // the classical reversible gates, and a permutation with phases
+    for (auto&& A : {gt.X, gt.Y, gt.CNOT, gt.CNOTba, gt.SWAP, gt.TOF, gt.FRED,
+                     gt.Xd(5)})
+    {
+        MonomialGate U(A);
+        EXPECT_EQ(static_cast<idx>(A.rows()), U.get_D());
+        EXPECT_NEAR(0, norm(U.to_dense() - A), 1e-7);
+    }
+
+    // from the permutation and the phases
+    MonomialGate U({2, 0, 1}, {1_i, -1, 1});
+    cmat expected = cmat::Zero(3, 3);
+    expected(2, 0) = 1_i;
+    expected(0, 1) = -1;
+    expected(1, 2) = 1;
+    EXPECT_NEAR(0, norm(U.to_dense() - expected), 1e-7);
+
+    // exceptions
+    EXPECT_THROW(MonomialGate{gt.H}, exception::CustomException);
+    EXPECT_THROW(MonomialGate(std::vector<idx>{0, 0}),
+                 exception::PermInvalid);
+    EXPECT_THROW(MonomialGate({1, 0}, {1, 1, 1}), exception::SizeMismatch);
+}
+/******************************************************************************/
+/// BEGIN qpp::MonomialGate::MonomialGate(const std::function<idx(idx)>& f,
+///       idx D)
+TEST(qpp_MonomialGate_MonomialGate_function, AllTests)
+{
+    // modular multiplication by 7 mod 15 on 4 qubits, identity on 15
+    MonomialGate U([](idx x) { return x < 15 ? (7 * x) % 15 : x; }, 16);
+    for (idx x = 0; x < 16; ++x)
+    {
+        std::vector<idx> bits = n2multiidx(x, {2, 2, 2, 2});
+        std::vector<idx> y = n2multiidx(x < 15 ? (7 * x) % 15 : x,
+                                        {2, 2, 2, 2});
+        // on the last 4 qubits of 6
+        std::vector<idx> in{1, 0}, out{1, 0};
+        in.insert(std::end(in), std::begin(bits), std::end(bits));
+        out.insert(std::end(out), std::begin(y), std::end(y));
+        EXPECT_NEAR(0, norm(U.apply(mket(in), {2, 3, 4, 5}) - mket(out)),
+                    1e-7);
+    }
+
+    // not a bijection
+    EXPECT_THROW(MonomialGate([](idx x) { return x / 2; }, 4),
+                 exception::CustomException);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> cmat qpp::MonomialGate::apply(
+///       const Eigen::MatrixBase<Derived>& state,
+///       const std::vector<idx>& subsys,
+///       const std::vector<idx>& dims) const
+TEST(qpp_MonomialGate_apply, AllTests)
+{
+    // random permutation with phases on qudit subsystems in reversed order,
+    // compare with the dense gate
+    std::vector<idx> dims{2, 3, 2, 3};
+    std::vector<idx> perm = randperm(6);
+    std::vector<cplx> phases;
+    for (idx i = 0; i < 6; ++i)
+        phases.push_back(std::exp(1_i * rand(0., 2 * pi)));
+    MonomialGate U(perm, phases);
+    cmat A = U.to_dense();
+    // the full matrix, built element by element
+    cmat full = cmat::Zero(36, 36);
+    for (idx m = 0; m < 36; ++m)
+    {
+        std::vector<idx> midx = n2multiidx(m, dims);
+        idx a = midx[3] * 2 + midx[0];
+        for (idx b = 0; b < 6; ++b)
+        {
+            std::vector<idx> out = midx;
+            out[3] = b / 2;
+            out[0] = b % 2;
+            full(multiidx2n(out, dims), m) = A(b, a);
+        }
+    }
+    ket psi = randket(36);
+    EXPECT_NEAR(0, norm(U.apply(psi, {3, 0}, dims) - full * psi), 1e-7);
+    cmat rho = randrho(36);
+    EXPECT_NEAR(0, norm(U.apply(rho, {3, 0}, dims) -
+                        full * rho * adjoint(full)), 1e-7);
+
+    // Toffoli on qubits, in-place, density matrix
+    MonomialGate TOF(gt.TOF);
+    rho = randrho(32);
+    cmat rho_out = rho;
+    TOF.apply_inplace(rho_out, {4, 1, 2});
+    full = gt.CTRL(gt.X, {4, 1}, {2}, 5);
+    EXPECT_NEAR(0, norm(rho_out - full * rho * adjoint(full)), 1e-7);
+
+    // exceptions
+    EXPECT_THROW(TOF.apply(psi, {0, 1}, dims),
+                 exception::MatrixMismatchSubsys);
+}
+/******************************************************************************/
@@ -0,0 +1,97 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "qpp.h"
+
+using namespace qpp;
+
+// Unit testing "classes/pauli_sum.h"
+
+
+/******************************************************************************/
+/// BEGIN PauliSum& qpp::PauliSum::add(double coeff,
+///       const std::vector<cmat>& paulis,
+///       const std::vector<idx>& subsys)
+TEST(qpp_PauliSum_add, AllTests)
+{
+    // Pauli matrices from qpp::Gates, terms with the same string are merged
+    PauliSum H(4);
+    H.add(1, {gt.X, gt.Z}, {2, 0}).add(0.5, "ZIXI").add(2, {}, {});
+    EXPECT_EQ(std::vector<std::string>({"ZIXI", "IIII"}), H.get_strings());
+    EXPECT_EQ(std::vector<double>({1.5, 2}), H.get_coeffs());
+    EXPECT_EQ(4u, H.get_n());
+
+    // exceptions
+    EXPECT_THROW(H.add(1, {gt.H}, {0}), exception::CustomException);
+    EXPECT_THROW(H.add(1, {gt.X}, {4}), exception::SubsysMismatchDims);
+    EXPECT_THROW(H.add(1, {gt.X}, {0, 1}), exception::SizeMismatch);
+    EXPECT_THROW(H.add(1, "XXX"), exception::SizeMismatch);
+    EXPECT_THROW(H.add(1, "XXBX"), exception::CustomException);
+    EXPECT_THROW(PauliSum(0), exception::DimsInvalid);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> ket qpp::PauliSum::apply(
+///       const Eigen::MatrixBase<Derived>& psi) const
+TEST(qpp_PauliSum_apply, AllTests)
+{
+    // random Hamiltonian, compare with the dense matrix built with kron()
+    idx n = 5;
+    std::map<char, cmat> paulis{{'I', gt.Id2}, {'X', gt.X}, {'Y', gt.Y},
+                                {'Z', gt.Z}};
+    PauliSum H(n);
+    cmat Hd = cmat::Zero(32, 32);
+    std::string chars = "IXYZ";
+    for (idx t = 0; t < 20; ++t)
+    {
+        std::string P;
+        cmat op(1, 1);
+        op(0, 0) = 1;
+        for (idx q = 0; q < n; ++q)
+        {
+            // first half of the terms diagonal
+            P += t < 10 ? chars[3 * randidx(0, 1)] : chars[randidx(0, 3)];
+            op = kron(op, paulis[P.back()]);
+        }
+        double c = rand(-1., 1.);
+        H.add(c, P);
+        Hd += c * op;
+    }
+    ket psi = randket(32);
+    EXPECT_NEAR(0, norm(H.apply(psi) - Hd * psi), 1e-7);
+    EXPECT_NEAR(0, norm(H.to_dense() - Hd), 1e-7);
+    EXPECT_NEAR(0, norm(cmat(H.to_sparse()) - Hd), 1e-7);
+    cmat ev = adjoint(psi) * Hd * psi;
+    EXPECT_NEAR(std::real(ev(0, 0)), H.expval(psi), 1e-7);
+    cmat rho = randrho(32);
+    EXPECT_NEAR(std::real(trace(Hd * rho)), H.expval(rho), 1e-7);
+
+    // zero operator
+    PauliSum H0(n);
+    EXPECT_EQ(0, norm(H0.apply(psi)));
+    EXPECT_EQ(0, H0.to_sparse().nonZeros());
+
+    // exceptions
+    EXPECT_THROW(H.apply(randket(16)), exception::DimsMismatchCvector);
+    EXPECT_THROW(H.apply(rho), exception::MatrixNotCvector);
+    EXPECT_THROW(H.expval(randrho(16)), exception::DimsMismatchMatrix);
+}
+/******************************************************************************/
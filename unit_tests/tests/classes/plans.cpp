@@ -0,0 +1,220 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "qpp.h"
+
+using namespace qpp;
+
+// Unit testing "classes/plans.h"
+
+/******************************************************************************/
+/// BEGIN template<typename Derived> void qpp::PtracePlan::execute(
+///       const Eigen::MatrixBase<Derived>& A,
+///       dyn_mat<typename Derived::Scalar>& result) const
+TEST(qpp_PtracePlan_execute, AllTests)
+{
+    std::vector<idx> dims{2, 3, 2, 2};
+    PtracePlan plan({3, 1}, dims);
+
+    // the same plan executed on many states, reusing the result
+    cmat result;
+    for (idx i = 0; i < 5; ++i)
+    {
+        ket psi = randket(24);
+        plan.execute(psi, result);
+        EXPECT_NEAR(0, norm(result - ptrace(prj(psi), {3, 1}, dims)), 1e-7);
+
+        cmat rho = randrho(24);
+        plan.execute(rho, result);
+        EXPECT_NEAR(0, norm(result - ptrace(rho, {1, 3}, dims)), 1e-7);
+    }
+
+    // leading, trailing, interleaved, none and all traced out subsystems
+    ket psi = randket(24);
+    cmat rho = prj(psi);
+    for (auto&& subsys : std::vector<std::vector<idx>>{
+            {1, 0}, {2, 3}, {0, 2}, {}, {0, 1, 2, 3}})
+    {
+        PtracePlan p(subsys, dims);
+        EXPECT_NEAR(0, norm(p.execute(psi) - p.execute(rho)), 1e-7);
+    }
+
+    // one plan shared by several threads, interleaved subsystems
+    PtracePlan shared({0, 2}, dims);
+    std::vector<ket> kets;
+    for (idx i = 0; i < 8; ++i)
+        kets.emplace_back(randket(24));
+    std::vector<cmat> results(kets.size());
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx i = 0; i < kets.size(); ++i)
+        shared.execute(kets[i], results[i]);
+    for (idx i = 0; i < kets.size(); ++i)
+        EXPECT_NEAR(0, norm(results[i] - ptrace(prj(kets[i]), {0, 2}, dims)),
+                    1e-7);
+
+    // qubits
+    PtracePlan qplan({0}, 3);
+    cmat A = randH(2), B = randH(2), C = randH(2);
+    EXPECT_NEAR(0, norm(qplan.execute(kron(A, B, C)) -
+                        A.trace() * kron(B, C)), 1e-7);
+
+    // dimension mismatch
+    EXPECT_THROW(plan.execute(randket(16)), exception::DimsMismatchCvector);
+    EXPECT_THROW(plan.execute(randrho(16)), exception::DimsMismatchMatrix);
+    EXPECT_THROW(PtracePlan({4}, dims), exception::SubsysMismatchDims);
+
+    // the result is left untouched on a dimension mismatch
+    cmat before = result;
+    EXPECT_THROW(plan.execute(randket(16), result),
+                 exception::DimsMismatchCvector);
+    EXPECT_THROW(plan.execute(randrho(16), result),
+                 exception::DimsMismatchMatrix);
+    EXPECT_EQ(before.rows(), result.rows());
+    EXPECT_NEAR(0, norm(result - before), 1e-7);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> void qpp::PtracePlan::execute(
+///       const Eigen::MatrixBase<Derived>& A,
+///       dyn_mat<typename Derived::Scalar>& result,
+///       dyn_mat<typename Derived::Scalar>& workspace) const
+TEST(qpp_PtracePlan_execute_workspace, AllTests)
+{
+    // interleaved subsystems, the ket is gathered into the workspace, which
+    // is allocated once and then reused
+    std::vector<idx> dims{2, 3, 2, 2};
+    PtracePlan plan({0, 2}, dims);
+    cmat result, workspace;
+    plan.execute(randket(24), result, workspace);
+    EXPECT_EQ(6, workspace.rows());
+    EXPECT_EQ(4, workspace.cols());
+    const cplx* data = workspace.data();
+    for (idx i = 0; i < 5; ++i)
+    {
+        ket psi = randket(24);
+        plan.execute(psi, result, workspace);
+        EXPECT_EQ(data, workspace.data());
+        EXPECT_NEAR(0, norm(result - ptrace(prj(psi), {0, 2}, dims)), 1e-7);
+    }
+
+    // a workspace of the wrong size is resized
+    workspace = cmat(2, 2);
+    ket psi = randket(24);
+    plan.execute(psi, result, workspace);
+    EXPECT_EQ(6, workspace.rows());
+    EXPECT_NEAR(0, norm(result - ptrace(prj(psi), {0, 2}, dims)), 1e-7);
+
+    // density matrices do not use the workspace
+    cmat rho = randrho(24);
+    plan.execute(rho, result, workspace);
+    EXPECT_NEAR(0, norm(result - ptrace(rho, {0, 2}, dims)), 1e-7);
+
+    // one plan shared by several threads, each with its own workspace
+    std::vector<ket> kets;
+    for (idx i = 0; i < 8; ++i)
+        kets.emplace_back(randket(24));
+    std::vector<cmat> results(kets.size()), workspaces(kets.size());
+#ifdef WITH_OPENMP_
+#pragma omp parallel for
+#endif // WITH_OPENMP_
+    for (idx i = 0; i < kets.size(); ++i)
+        plan.execute(kets[i], results[i], workspaces[i]);
+    for (idx i = 0; i < kets.size(); ++i)
+        EXPECT_NEAR(0, norm(results[i] - ptrace(prj(kets[i]), {0, 2}, dims)),
+                    1e-7);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> void qpp::PtransposePlan::execute(
+///       const Eigen::MatrixBase<Derived>& A,
+///       dyn_mat<typename Derived::Scalar>& result) const
+TEST(qpp_PtransposePlan_execute, AllTests)
+{
+    std::vector<idx> dims{3, 2, 2};
+    PtransposePlan plan({2, 0}, dims);
+
+    cmat result;
+    for (idx i = 0; i < 5; ++i)
+    {
+        cmat A = randU(3), B = randU(2), C = randU(2);
+        plan.execute(kron(A, B, C), result);
+        EXPECT_NEAR(0, norm(result - kron(transpose(A), B, transpose(C))),
+                    1e-7);
+
+        ket psi = randket(12);
+        plan.execute(psi, result);
+        EXPECT_NEAR(0, norm(result - plan.execute(prj(psi))), 1e-7);
+    }
+
+    // qubits
+    PtransposePlan qplan({1}, 2);
+    EXPECT_NEAR(0, norm(qplan.execute(st.b00) - gt.SWAP / 2.), 1e-7);
+
+    // dimension mismatch
+    EXPECT_THROW(plan.execute(randket(8)), exception::DimsMismatchCvector);
+    EXPECT_THROW(plan.execute(randrho(8)), exception::DimsMismatchMatrix);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> void qpp::SyspermutePlan::execute(
+///       const Eigen::MatrixBase<Derived>& A,
+///       dyn_mat<typename Derived::Scalar>& result) const
+TEST(qpp_SyspermutePlan_execute, AllTests)
+{
+    std::vector<idx> dims{2, 3, 4};
+    SyspermutePlan plan({1, 2, 0}, dims);
+
+    cmat result;
+    for (idx i = 0; i < 5; ++i)
+    {
+        ket a = randket(2), b = randket(3), c = randket(4);
+        plan.execute(kron(a, b, c), result);
+        EXPECT_NEAR(0, norm(result - kron(b, c, a)), 1e-7);
+
+        cmat A = randU(2), B = randU(3), C = randU(4);
+        plan.execute(kron(A, B, C), result);
+        EXPECT_NEAR(0, norm(result - kron(B, C, A)), 1e-7);
+    }
+
+    // random permutations of product operators, large enough to be tiled
+    std::vector<idx> dims6{2, 3, 2, 4, 2, 3};
+    for (idx i = 0; i < 10; ++i)
+    {
+        std::vector<idx> perm = randperm(6);
+        std::vector<cmat> Us, Us_perm;
+        for (auto&& dim : dims6)
+            Us.push_back(randU(dim));
+        for (auto&& k : perm)
+            Us_perm.push_back(Us[k]);
+        SyspermutePlan p(perm, dims6);
+        EXPECT_NEAR(0, norm(p.execute(kron(Us)) - kron(Us_perm)), 1e-7);
+    }
+
+    // qubits
+    SyspermutePlan qplan({1, 0});
+    cmat rho = randrho(4);
+    EXPECT_NEAR(0, norm(qplan.execute(rho) - gt.SWAP * rho * gt.SWAP), 1e-7);
+
+    // invalid permutation
+    EXPECT_THROW(SyspermutePlan({0, 0, 1}, dims), exception::PermInvalid);
+    EXPECT_THROW(SyspermutePlan({0, 1}, dims), exception::PermMismatchDims);
+}
+/******************************************************************************/
@@ -0,0 +1,99 @@
+/*
+ * Quantum++
+ *
+ * Copyright (c) 2013 - 2017 Vlad Gheorghiu (vgheorgh@gmail.com)
+ *
+ * This file is part of Quantum++.
+ *
+ * Quantum++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Quantum++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quantum++.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "qpp.h"
+
+using namespace qpp;
+
+// Unit testing "classes/spectrum.h"
+
+
+/******************************************************************************/
+/// BEGIN template<typename Derived> explicit qpp::Spectrum::Spectrum(
+///       const Eigen::MatrixBase<Derived>& A, bool compute_evects = false)
+TEST(qpp_Spectrum_Spectrum, AllTests)
+{
+    // fixed eigenvalues
+    cmat U = randU(4);
+    dyn_col_vect<double> ev(4);
+    ev << 0.1, 0.4, 0.2, 0.3;
+    cmat rho = U * ev.cast<cplx>().asDiagonal() * adjoint(U);
+    Spectrum spec(rho, true);
+    std::vector<double> expected{0.4, 0.3, 0.2, 0.1};
+    EXPECT_EQ(4u, spec.get_D());
+    for (idx i = 0; i < 4; ++i)
+        EXPECT_NEAR(expected[i], spec.get_evals()[i], 1e-10);
+    EXPECT_NEAR(0.3, spec.purity(), 1e-10);
+    EXPECT_NEAR(1, spec.trace_norm(), 1e-10);
+
+    // eigenvectors
+    EXPECT_TRUE(spec.has_evects());
+    cmat V = spec.get_evects();
+    for (idx i = 0; i < 4; ++i)
+        EXPECT_NEAR(0, norm(rho * V.col(i) - expected[i] * V.col(i)), 1e-10);
+
+    // eigenvalues only
+    Spectrum spec2(rho);
+    EXPECT_FALSE(spec2.has_evects());
+    EXPECT_THROW(spec2.get_evects(), exception::CustomException);
+
+    // exceptions
+    EXPECT_THROW(Spectrum(randn<cmat>(3, 3)), exception::CustomException);
+    EXPECT_THROW(Spectrum(randn<cmat>(2, 3)), exception::MatrixNotSquare);
+    EXPECT_THROW(Spectrum(cmat(0, 0)), exception::ZeroSize);
+}
+/******************************************************************************/
+/// BEGIN double qpp::entropy(const Spectrum& spec),
+///       double qpp::renyi(const Spectrum& spec, double alpha),
+///       double qpp::tsallis(const Spectrum& spec, double q)
+TEST(qpp_Spectrum_entropies, AllTests)
+{
+    // one decomposition for all the entropies of a reduced state
+    cmat rhoA = ptrace2(randrho(24), {4, 6});
+    Spectrum spec(rhoA);
+    EXPECT_NEAR(qpp::entropy(rhoA), qpp::entropy(spec), 1e-10);
+    for (double alpha : {0., 0.5, 1., 2., 3.5, infty})
+        EXPECT_NEAR(qpp::renyi(rhoA, alpha), qpp::renyi(spec, alpha), 1e-10);
+    for (double q : {0., 0.5, 1., 2., 3.5})
+        EXPECT_NEAR(qpp::tsallis(rhoA, q), qpp::tsallis(spec, q), 1e-10);
+    EXPECT_NEAR(std::real(trace(rhoA * rhoA)), spec.purity(), 1e-10);
+}
+/******************************************************************************/
+/// BEGIN double qpp::negativity(const Spectrum& spec),
+///       double qpp::lognegativity(const Spectrum& spec)
+TEST(qpp_Spectrum_negativity, AllTests)
+{
+    std::vector<idx> dims{3, 4};
+    cmat rho = randrho(12);
+    Spectrum spec(ptranspose(rho, {0}, dims));
+    EXPECT_NEAR(qpp::negativity(rho, dims), qpp::negativity(spec), 1e-10);
+    EXPECT_NEAR(qpp::lognegativity(rho, dims), qpp::lognegativity(spec),
+                1e-10);
+
+    // random maximally entangled 2-qutrit state
+    idx d = 3;
+    rho = prj(kron(randU(d), randU(d)) * st.mes(d));
+    Spectrum spec2(ptranspose(rho, {0}, {d, d}));
+    EXPECT_NEAR((d - 1) / 2., qpp::negativity(spec2), 1e-7);
+    EXPECT_NEAR(std::log2(d), qpp::lognegativity(spec2), 1e-7);
+}
+/******************************************************************************/
@@ -86,6 +86,57 @@ TEST(qpp_entanglement_qubits, AllTests)
                 qpp::entanglement(psi3), 1e-7);
 }
 /******************************************************************************/
+/// BEGIN template<typename Derived> std::vector<double>
+///       qpp::entanglement_profile(const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<idx>& dims)
+TEST(qpp_entanglement_profile, AllTests)
+{
+    // compare with the entanglement across each cut
+    for (auto&& dims : std::vector<std::vector<idx>>{{2, 2}, {2, 3, 4, 2},
+                                                     {5, 2, 2, 2, 2},
+                                                     {2, 2, 2, 2, 2, 2, 3}})
+    {
+        idx D = prod(dims);
+        ket psi = randket(D);
+        std::vector<double> result = entanglement_profile(psi, dims);
+        EXPECT_EQ(dims.size() - 1, result.size());
+        idx DA = 1;
+        for (idx k = 0; k + 1 < dims.size(); ++k)
+        {
+            DA *= dims[k];
+            EXPECT_NEAR(entanglement(psi, {DA, D / DA}), result[k], 1e-7);
+        }
+    }
+
+    // product state
+    ket psi = kron(randket(2), randket(3), randket(2));
+    for (auto&& it : entanglement_profile(psi, {2, 3, 2}))
+        EXPECT_NEAR(0, it, 1e-7);
+
+    // single subsystem, no cuts
+    EXPECT_EQ(0u, entanglement_profile(randket(4), {4}).size());
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> std::vector<double>
+///       qpp::entanglement_profile(const Eigen::MatrixBase<Derived>& A,
+///       idx d = 2)
+TEST(qpp_entanglement_profile_qubits, AllTests)
+{
+    // GHZ state, 1 ebit across every cut
+    idx n = 6;
+    ket psi = (mket(std::vector<idx>(n, 0)) +
+               mket(std::vector<idx>(n, 1))) / std::sqrt(2);
+    for (auto&& it : entanglement_profile(psi))
+        EXPECT_NEAR(1, it, 1e-7);
+
+    // Bell pairs (0, 1), (2, 3), (4, 5)
+    psi = kron(st.b00, st.b00, st.b00);
+    std::vector<double> result = entanglement_profile(psi);
+    std::vector<double> expected{1, 0, 1, 0, 1};
+    for (idx k = 0; k < n - 1; ++k)
+        EXPECT_NEAR(expected[k], result[k], 1e-7);
+}
+/******************************************************************************/
 /// BEGIN template<typename Derived> double qpp::gconcurrence(
 ///       const Eigen::MatrixBase<Derived>& A)
 TEST(qpp_gconcurrence, AllTests)
@@ -377,6 +428,38 @@ TEST(qpp_schmidtA_schmidtB_qubits, AllTests)
     EXPECT_NEAR(0, norm(expected - psi), 1e-7);
 }
 /******************************************************************************/
+/// BEGIN template<typename Derived> cmat qpp::schmidtA/B(
+///       const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& dims,
+///       idx rank, double tol = 0)
+TEST(qpp_schmidtA_schmidtB_truncated, AllTests)
+{
+    // state of Schmidt rank 5 on 20 x 30, the truncated Schmidt bases
+    // diagonalize the reduced states
+    idx dA = 20, dB = 30, r = 5;
+    cmat UA = randU(dA);
+    cmat UB = randU(dB);
+    std::vector<double> c = randprob(r);
+    ket psi = ket::Zero(dA * dB);
+    for (idx i = 0; i < r; ++i)
+        psi += std::sqrt(c[i]) * kron(UA.col(i), UB.col(i));
+    dyn_col_vect<double> scf = schmidtcoeffs(psi, {dA, dB}, r);
+    cmat A = schmidtA(psi, {dA, dB}, r);
+    cmat B = schmidtB(psi, {dA, dB}, r);
+    EXPECT_EQ(dA, static_cast<idx>(A.rows()));
+    EXPECT_EQ(r, static_cast<idx>(A.cols()));
+    EXPECT_EQ(dB, static_cast<idx>(B.rows()));
+    EXPECT_EQ(r, static_cast<idx>(B.cols()));
+    cmat probs = scf.cwiseAbs2().cast<cplx>().asDiagonal();
+    EXPECT_NEAR(0, norm(adjoint(A) * ptrace2(prj(psi), {dA, dB}) * A - probs),
+                1e-7);
+    EXPECT_NEAR(0, norm(adjoint(B) * ptrace1(prj(psi), {dA, dB}) * B - probs),
+                1e-7);
+
+    // the Schmidt vectors are orthonormal
+    EXPECT_NEAR(0, norm(adjoint(A) * A - cmat::Identity(r, r)), 1e-7);
+    EXPECT_NEAR(0, norm(adjoint(B) * B - cmat::Identity(r, r)), 1e-7);
+}
+/******************************************************************************/
 /// BEGIN template<typename Derived> dyn_col_vect<double> qpp::schmidtcoeffs(
 ///       const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& dims)
 TEST(qpp_schmidtcoeffs, AllTests)
@@ -491,6 +574,50 @@ TEST(qpp_schmidtcoeffs_qubits, AllTests)
     EXPECT_NEAR(0, norm(result - expected), 1e-7);
 }
 /******************************************************************************/
+/// BEGIN template<typename Derived> dyn_col_vect<double> qpp::schmidtcoeffs(
+///       const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& dims,
+///       idx rank, double tol = 0)
+TEST(qpp_schmidtcoeffs_truncated, AllTests)
+{
+    // random state, the leading coefficients match the full ones
+    idx dA = 32, dB = 64;
+    ket psi = randket(dA * dB);
+    dyn_col_vect<double> full = schmidtcoeffs(psi, {dA, dB});
+    for (idx r : {1u, 4u, 10u, 32u})
+    {
+        dyn_col_vect<double> result = schmidtcoeffs(psi, {dA, dB}, r);
+        EXPECT_EQ(r, static_cast<idx>(result.rows()));
+        EXPECT_NEAR(0, norm(result - full.head(r)), 1e-7);
+    }
+    // no cap
+    EXPECT_NEAR(0, norm(schmidtcoeffs(psi, {dA, dB}, 0) - full), 1e-7);
+
+    // threshold, state with Schmidt coefficients decaying as 2^(-i)
+    dA = 40;
+    dB = 50;
+    cmat UA = randU(dA);
+    cmat UB = randU(dB);
+    psi = ket::Zero(dA * dB);
+    for (idx i = 0; i < dA; ++i)
+        psi += std::pow(2., -static_cast<double>(i)) *
+               kron(UA.col(i), UB.col(i));
+    psi /= norm(psi);
+    full = schmidtcoeffs(psi, {dA, dB});
+    dyn_col_vect<double> result = schmidtcoeffs(psi, {dA, dB}, 0, 1e-5);
+    idx expected_rank = 0;
+    while (full(expected_rank) > 1e-5)
+        ++expected_rank;
+    EXPECT_EQ(expected_rank, static_cast<idx>(result.rows()));
+    EXPECT_NEAR(0, norm(result - full.head(expected_rank)), 1e-7);
+    // the cap wins over the threshold
+    EXPECT_EQ(3u, schmidtcoeffs(psi, {dA, dB}, 3, 1e-5).rows());
+
+    // exceptions
+    EXPECT_THROW(schmidtcoeffs(psi, {dA, dB}, 3, -1), exception::OutOfRange);
+    EXPECT_THROW(schmidtcoeffs(psi, {dA, dA}, 3),
+                 exception::DimsMismatchCvector);
+}
+/******************************************************************************/
 /// BEGIN template<typename Derived> std::vector<double> qpp::schmidtprobs(
 ///       const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& dims)
 TEST(qpp_schmidtprobs, AllTests)
@@ -625,3 +752,44 @@ TEST(qpp_schmidtprobs_qubits, AllTests)
     EXPECT_NEAR(0, norm(result - expected), 1e-7);
 }
 /******************************************************************************/
+/// BEGIN template<typename Derived> std::vector<double> qpp::schmidtprobs(
+///       const Eigen::MatrixBase<Derived>& A, const std::vector<idx>& dims,
+///       idx rank, double tol = 0)
+TEST(qpp_schmidtprobs_truncated, AllTests)
+{
+    idx dA = 16, dB = 24;
+    ket psi = randket(dA * dB);
+    std::vector<double> full = schmidtprobs(psi, {dA, dB});
+    std::vector<double> result = schmidtprobs(psi, {dA, dB}, 6);
+    EXPECT_EQ(6u, result.size());
+    for (idx i = 0; i < result.size(); ++i)
+        EXPECT_NEAR(full[i], result[i], 1e-7);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> std::vector<std::vector<double>>
+///       qpp::schmidtprobs_profile(const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<idx>& dims)
+TEST(qpp_schmidtprobs_profile, AllTests)
+{
+    std::vector<idx> dims{3, 2, 2, 4, 2};
+    idx D = prod(dims);
+    ket psi = randket(D);
+    std::vector<std::vector<double>> result = schmidtprobs_profile(psi, dims);
+    idx DA = 1;
+    for (idx k = 0; k + 1 < dims.size(); ++k)
+    {
+        DA *= dims[k];
+        std::vector<double> expected = schmidtprobs(psi, {DA, D / DA});
+        EXPECT_EQ(expected.size(), result[k].size());
+        for (idx i = 0; i < expected.size(); ++i)
+            EXPECT_NEAR(expected[i], result[k][i], 1e-7);
+        EXPECT_NEAR(renyi(expected, 2), renyi(result[k], 2), 1e-7);
+    }
+
+    // exceptions
+    EXPECT_THROW(schmidtprobs_profile(psi, {3, 2, 2}),
+                 exception::DimsMismatchCvector);
+    EXPECT_THROW(schmidtprobs_profile(randrho(4), {2, 2}),
+                 exception::MatrixNotCvector);
+}
+/******************************************************************************/
@@ -179,13 +179,122 @@ TEST(qpp_evects, AllTests)
 TEST(qpp_expm, AllTests)
 {
 
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived1, typename Derived2> ket qpp::expmv(
+///       const Eigen::MatrixBase<Derived1>& A,
+///       const Eigen::MatrixBase<Derived2>& psi, cplx t = 1,
+///       double tol = 1e-12)
+TEST(qpp_expmv, AllTests)
+{
+    // time evolution, compare with the dense matrix exponential
+    for (idx D : {1u, 2u, 7u, 64u})
+    {
+        cmat H = randH(D);
+        ket psi = randket(D);
+        for (double time : {0., 0.1, 1., 10., 100.})
+        {
+            ket ref = expm(-1_i * time * H) * psi;
+            EXPECT_NEAR(0, norm(expmv(H, psi, -1_i * time) - ref),
+                        1e-9 * (1 + time));
+        }
+    }
+
+    // non-normal real matrix, real time
+    dmat A = randn<dmat>(20, 20);
+    ket psi = randket(20);
+    ket ref = expm(0.7 * A) * psi;
+    EXPECT_NEAR(0, norm(expmv(A, psi, 0.7) - ref) / norm(ref), 1e-9);
+    EXPECT_NEAR(0, norm(expmv(A, psi) - expm(A) * psi) / norm(ref), 1e-9);
+
+    // exceptions
+    EXPECT_THROW(expmv(randn<cmat>(2, 3), randket(2)),
+                 exception::MatrixNotSquare);
+    EXPECT_THROW(expmv(randH(3), randket(2)), exception::DimsMismatchCvector);
+    EXPECT_THROW(expmv(randH(2), randH(2)), exception::MatrixNotCvector);
+    EXPECT_THROW(expmv(randH(2), randket(2), 1, 0), exception::OutOfRange);
+    // unreachable tolerance
+    EXPECT_THROW(expmv(100 * randH(200), randket(200), -1_i, 1e-20),
+                 exception::CustomException);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> ket qpp::expmv(
+///       const std::function<ket(const ket&)>& A,
+///       const Eigen::MatrixBase<Derived>& psi, cplx t = 1,
+///       double tol = 1e-12)
+TEST(qpp_expmv_function, AllTests)
+{
+    // qpp::PauliSum Hamiltonian, transverse-field Ising chain
+    idx n = 8;
+    PauliSum H(n);
+    for (idx q = 0; q + 1 < n; ++q)
+        H.add(1, {gt.Z, gt.Z}, {q, q + 1});
+    for (idx q = 0; q < n; ++q)
+        H.add(0.7, {gt.X}, {q});
+    ket psi = randket(256);
+    ket result = expmv([&H](const ket& v) { return H.apply(v); }, psi,
+                       -1_i * 3.);
+    ket ref = expm(-1_i * 3. * H.to_dense()) * psi;
+    EXPECT_NEAR(0, norm(result - ref), 1e-9);
+
+    // the evolution is unitary
+    EXPECT_NEAR(1, norm(result), 1e-9);
+
+    // exceptions
+    EXPECT_THROW(expmv([](const ket& v) -> ket { return v.head(1); }, psi),
+                 exception::DimsMismatchCvector);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived1, typename Derived2> ket qpp::expmv(
+///       const Eigen::SparseMatrixBase<Derived1>& A,
+///       const Eigen::MatrixBase<Derived2>& psi, cplx t = 1,
+///       double tol = 1e-12)
+TEST(qpp_expmv_sparse, AllTests)
+{
+    // sparse Hamiltonian, compare with the dense version
+    PauliSum H(6);
+    H.add(1, "ZZIIXI").add(-0.5, "IYYIII").add(0.3, "XIIIIZ");
+    sp_cmat S = H.to_sparse();
+    ket psi = randket(64);
+    ket ref = expm(-1_i * 2. * H.to_dense()) * psi;
+    EXPECT_NEAR(0, norm(expmv(S, psi, -1_i * 2.) - ref), 1e-9);
+
+    // exceptions
+    EXPECT_THROW(expmv(S, randket(32)), exception::DimsMismatchCvector);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> cmat qpp::funm(
 ///       const Eigen::MatrixBase<Derived>& A, cplx (* f)(const cplx&))
 TEST(qpp_funm, AllTests)
 {
-
+    // Hermitian input, compare with the spectral decomposition
+    for (idx D : {1u, 2u, 10u})
+    {
+        cmat H = randH(D);
+        dyn_col_vect<double> ev = hevals(H);
+        cmat U = hevects(H);
+        cmat expH = U * ev.unaryExpr([](double x) -> cplx
+                                     { return std::exp(x); }).asDiagonal() *
+                    adjoint(U);
+        cmat result = funm(H, &std::exp);
+        EXPECT_NEAR(0, norm(result - expH), 1e-10);
+        // f(H) of a Hermitian H commutes with H
+        EXPECT_NEAR(0, norm(comm(result, H)), 1e-10);
+    }
+
+    // non-Hermitian (diagonalizable) input
+    cmat A = randn<cmat>(4, 4);
+    cmat expA = funm(A, &std::exp);
+    EXPECT_NEAR(0, norm(expA * funm(A, [](const cplx& z) -> cplx
+                                       { return std::exp(-z); }) -
+                        cmat::Identity(4, 4)), 1e-8);
+
+    // non-Hermitian input with entries below qpp::eps, f(B) = B
+    cmat B(2, 2);
+    B << 1, 1, 0, 2;
+    B *= 1e-13;
+    EXPECT_NEAR(0, norm(funm(B, [](const cplx& z) -> cplx { return z; }) - B) /
+                   norm(B), 1e-8);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_mat<typename Derived::Scalar>
@@ -404,14 +513,43 @@ TEST(qpp_sinm, AllTests)
 ///       const Eigen::MatrixBase<Derived>& A, const cplx z)
 TEST(qpp_spectralpowm, AllTests)
 {
+    // positive definite Hermitian input
+    cmat A = randn<cmat>(5, 5);
+    cmat P = adjoint(A) * A;
+    EXPECT_NEAR(0, norm(spectralpowm(P, 2) - P * P), 1e-8);
+    EXPECT_NEAR(0, norm(spectralpowm(P, -1) - inverse(P)), 1e-6);
+    cmat R = spectralpowm(P, 0.5);
+    EXPECT_NEAR(0, norm(R * R - P), 1e-8);
+    EXPECT_NEAR(0, norm(R - adjoint(R)), 1e-8);
+
+    // non-Hermitian input
+    EXPECT_NEAR(0, norm(spectralpowm(A, 3) - powm(A, 3)), 1e-8);
+
+    // A^0 = I
+    EXPECT_NEAR(0, norm(spectralpowm(A, 0) - cmat::Identity(5, 5)), 1e-12);
 
+    // non-Hermitian input with entries below qpp::eps
+    cmat B(2, 2);
+    B << 1, 1, 0, 2;
+    B *= 1e-13;
+    EXPECT_NEAR(0, norm(spectralpowm(B, -1) * B - cmat::Identity(2, 2)),
+                1e-8);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> cmat qpp::sqrtm(
 ///       const Eigen::MatrixBase<Derived>& A)
 TEST(qpp_sqrtm, AllTests)
 {
+    // density matrix
+    cmat rho = randrho(6);
+    cmat sqrt_rho = sqrtm(rho);
+    EXPECT_NEAR(0, norm(sqrt_rho * sqrt_rho - rho), 1e-10);
+    EXPECT_NEAR(0, norm(sqrt_rho - adjoint(sqrt_rho)), 1e-10);
 
+    // non-Hermitian input
+    cmat A = randn<cmat>(4, 4);
+    cmat sqrtA = sqrtm(A);
+    EXPECT_NEAR(0, norm(sqrtA * sqrtA - A), 1e-8);
 }
 /******************************************************************************/
 /// BEGIN template<typename Container> typename Container::value_type
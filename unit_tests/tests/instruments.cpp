@@ -26,6 +26,75 @@ using namespace qpp;
 
 // Unit testing "instruments.h"
 
+/******************************************************************************/
+/// BEGIN template<typename Derived> double qpp::expval(
+///       const Eigen::MatrixBase<Derived>& A,
+///       const std::string& P)
+TEST(qpp_expval, AllTests)
+{
+    // compare with the explicit Pauli operators
+    std::map<char, cmat> paulis{{'I', gt.Id2}, {'X', gt.X}, {'Y', gt.Y},
+                                {'Z', gt.Z}};
+    for (auto&& P : std::vector<std::string>{"Z", "Y", "XYZ", "YYIX",
+                                             "IIIII", "ZIYXY"})
+    {
+        cmat op(1, 1);
+        op(0, 0) = 1;
+        for (auto&& c : P)
+            op = kron(op, paulis[c]);
+        ket psi = randket(op.rows());
+        cmat rho = randrho(op.rows());
+        cmat ref = adjoint(psi) * op * psi;
+        EXPECT_NEAR(std::real(ref(0, 0)), expval(psi, P), 1e-7);
+        EXPECT_NEAR(std::real(trace(op * rho)), expval(rho, P), 1e-7);
+    }
+
+    // eigenstates
+    EXPECT_NEAR(-1, expval(mket({0, 1}), "ZZ"), 1e-7);
+    EXPECT_NEAR(-1, expval(kron(st.x0, st.y1), "XY"), 1e-7);
+    EXPECT_NEAR(0, expval(mket({0, 1}), "XI"), 1e-7);
+
+    // exceptions
+    ket psi = randket(8);
+    EXPECT_THROW(expval(psi, "XY"), exception::DimsMismatchCvector);
+    EXPECT_THROW(expval(prj(psi), "XYZI"), exception::DimsMismatchMatrix);
+    EXPECT_THROW(expval(psi, ""), exception::DimsInvalid);
+    EXPECT_THROW(expval(psi, "XAZ"), exception::CustomException);
+    EXPECT_THROW(expval(randket(9), "XYZ"), exception::DimsMismatchCvector);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> std::vector<double> qpp::expval(
+///       const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<std::string>& Ps)
+TEST(qpp_expval_vector, AllTests)
+{
+    // terms with the same and with different flip masks, compare with the
+    // single-string version
+    std::vector<std::string> Ps{"ZZII", "XXYY", "IZZI", "YYXX", "XIZI",
+                                "IIIZ", "YXYX", "ZIXI", "IIII"};
+    ket psi = randket(16);
+    cmat rho = randrho(16);
+    std::vector<double> evpsi = expval(psi, Ps);
+    std::vector<double> evrho = expval(rho, Ps);
+    EXPECT_EQ(Ps.size(), evpsi.size());
+    for (idx i = 0; i < Ps.size(); ++i)
+    {
+        EXPECT_NEAR(expval(psi, Ps[i]), evpsi[i], 1e-7);
+        EXPECT_NEAR(expval(rho, Ps[i]), evrho[i], 1e-7);
+    }
+    EXPECT_NEAR(1, evpsi.back(), 1e-7);
+
+    // larger state, more than one chunk
+    psi = randket(1u << 14);
+    std::vector<double> ev = expval(psi, {"XZIYIIZZIXIYZZ", "ZZIZIIZZIIIZZZ"});
+    EXPECT_NEAR(std::real((adjoint(psi) * apply(psi, gt.Z, {1})).value()),
+                expval(psi, "IZIIIIIIIIIIII"), 1e-7);
+    EXPECT_NEAR(expval(psi, "ZZIZIIZZIIIZZZ"), ev[1], 1e-7);
+
+    // exceptions
+    EXPECT_THROW(expval(psi, std::vector<std::string>{}), exception::ZeroSize);
+    EXPECT_THROW(expval(rho, {"XXXX", "XXX"}), exception::SizeMismatch);
+}
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_col_vect<typename Derived::Scalar>
 ///       qpp::ip(const Eigen::MatrixBase<Derived>& phi,
@@ -64,7 +133,26 @@ TEST(qpp_measure_full_orthonormal, AllTests)
 ///       const std::vector<idx>& dims)
 TEST(qpp_measure_rankone, AllTests)
 {
-
+    // non-normalized rank-1 POVM columns, the outcome probabilities are
+    // |<v|psi>|^2 for kets and |v|^2 <v|rho|v> for density matrices (Kraus
+    // operators |v><v|)
+    std::vector<idx> dims{2, 3, 2};
+    ket psi = randket(12);
+    cmat rho = prj(psi);
+    cmat V = randn<cmat>(4, 3);
+    cmat rho_subsys = ptrace(rho, {1}, dims);
+    auto mrho = measure(rho, V, {0, 2}, dims);
+    auto mpsi = measure(psi, V, {0, 2}, dims);
+    for (idx i = 0; i < 3; ++i)
+    {
+        double p = std::abs((adjoint(V.col(i)) * rho_subsys *
+                             V.col(i)).value());
+        double n2 = std::pow(norm(V.col(i)), 2);
+        EXPECT_NEAR(n2 * p, std::get<1>(mrho)[i], 1e-7);
+        EXPECT_NEAR(p, std::get<1>(mpsi)[i], 1e-7);
+        EXPECT_NEAR(0, norm(std::get<2>(mrho)[i] -
+                            prj(std::get<2>(mpsi)[i])), 1e-7);
+    }
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived>
@@ -138,6 +226,49 @@ TEST(qpp_measure_kraus_vector, AllTests)
 TEST(qpp_measure_kraus_vector_qubits, AllTests)
 {
 
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived>
+///       std::tuple<idx, std::vector<double>, std::vector<cmat>>
+///       qpp::measure(const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<sp_cmat>& Ks)
+TEST(qpp_measure_kraus_sparse, AllTests)
+{
+    // projectors onto the even and odd parity subspaces of 4 qubits, full
+    // and partial measurements, compare with the dense projectors
+    cmat P0 = cmat::Zero(16, 16);
+    for (idx i = 0; i < 16; ++i)
+        if (((i ^ (i >> 1) ^ (i >> 2) ^ (i >> 3)) & 1) == 0)
+            P0(i, i) = 1;
+    cmat P1 = gt.Id(16) - P0;
+    std::vector<cmat> Ks{P0, P1};
+    std::vector<sp_cmat> sKs{P0.sparseView(), P1.sparseView()};
+
+    ket psi = randket(16);
+    auto dense = measure(psi, Ks);
+    auto sparse = measure(psi, sKs);
+    for (idx i = 0; i < 2; ++i)
+    {
+        EXPECT_NEAR(std::get<1>(dense)[i], std::get<1>(sparse)[i], 1e-7);
+        EXPECT_NEAR(0, norm(std::get<2>(dense)[i] - std::get<2>(sparse)[i]),
+                    1e-7);
+    }
+    cmat rho = randrho(16);
+    dense = measure(rho, Ks);
+    sparse = measure(rho, sKs);
+    for (idx i = 0; i < 2; ++i)
+    {
+        EXPECT_NEAR(std::get<1>(dense)[i], std::get<1>(sparse)[i], 1e-7);
+        EXPECT_NEAR(0, norm(std::get<2>(dense)[i] - std::get<2>(sparse)[i]),
+                    1e-7);
+    }
+
+    // partial measurement of the parity of 4 qubits out of 6
+    rho = randrho(64);
+    dense = measure(rho, Ks, {5, 0, 2, 3});
+    sparse = measure(rho, sKs, {5, 0, 2, 3});
+    for (idx i = 0; i < 2; ++i)
+        EXPECT_NEAR(std::get<1>(dense)[i], std::get<1>(sparse)[i], 1e-7);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> std::tuple<std::vector<idx>, double, cmat>
@@ -146,7 +277,34 @@ TEST(qpp_measure_kraus_vector_qubits, AllTests)
 ///       idx d = 2)
 TEST(qpp_measure_seq_qubits, AllTests)
 {
+    // computational basis state, deterministic outcomes
+    ket psi = mket({0, 1, 1, 0});
+    auto m = measure_seq(psi, {2, 0});
+    EXPECT_EQ(std::vector<idx>({0, 1}), std::get<0>(m));
+    EXPECT_NEAR(1, std::get<1>(m), 1e-7);
+    EXPECT_NEAR(0, norm(std::get<2>(m) - mket({1, 0})), 1e-7);
 
+    // GHZ state, all outcomes are equal and the rest collapses accordingly
+    ket GHZ = (mket({0, 0, 0}) + mket({1, 1, 1})) / std::sqrt(2);
+    for (idx i = 0; i < 10; ++i)
+    {
+        m = measure_seq(GHZ, {0, 2});
+        std::vector<idx> res = std::get<0>(m);
+        EXPECT_EQ(res[0], res[1]);
+        EXPECT_NEAR(0.5, std::get<1>(m), 1e-7);
+        EXPECT_NEAR(0, norm(std::get<2>(m) - mket({res[0]})), 1e-7);
+
+        m = measure_seq(prj(GHZ), {0, 2});
+        res = std::get<0>(m);
+        EXPECT_EQ(res[0], res[1]);
+        EXPECT_NEAR(0.5, std::get<1>(m), 1e-7);
+        EXPECT_NEAR(0, norm(std::get<2>(m) - prj(mket({res[0]}))), 1e-7);
+    }
+
+    // all qubits measured
+    m = measure_seq(mket({1, 0}), {0, 1});
+    EXPECT_EQ(std::vector<idx>({1, 0}), std::get<0>(m));
+    EXPECT_NEAR(1, std::abs(std::get<2>(m)(0)), 1e-7);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> std::tuple<std::vector<idx>, double, cmat>
@@ -155,6 +313,182 @@ TEST(qpp_measure_seq_qubits, AllTests)
 ///       std::vector<idx> dims)
 TEST(qpp_measure_seq, AllTests)
 {
+    // product state, the outcome probability is the one of the measured
+    // subsystem, which is removed from the post-measurement state
+    std::vector<idx> dims{2, 3, 2};
+    ket a = randket(2), b = randket(3), c = randket(2);
+    for (idx i = 0; i < 10; ++i)
+    {
+        auto m = measure_seq(kron(a, b, c), {1}, dims);
+        idx res = std::get<0>(m)[0];
+        EXPECT_NEAR(std::norm(b(res)), std::get<1>(m), 1e-7);
+        cmat overlap = adjoint(std::get<2>(m)) * kron(a, c);
+        EXPECT_NEAR(1, std::abs(overlap(0, 0)), 1e-7);
+
+        m = measure_seq(prj(kron(a, b, c)), {1}, dims);
+        res = std::get<0>(m)[0];
+        EXPECT_NEAR(std::norm(b(res)), std::get<1>(m), 1e-7);
+        EXPECT_NEAR(0, norm(std::get<2>(m) - prj(kron(a, c))), 1e-7);
+    }
+
+    // joint probability of the outcomes, mixed state
+    dims = {3, 2, 3};
+    cmat rho = randrho(18);
+    for (idx i = 0; i < 10; ++i)
+    {
+        auto m = measure_seq(rho, {2, 0}, dims);
+        std::vector<idx> res = std::get<0>(m);
+        cmat proj = kron(mket({res[0]}, {3}), gt.Id2, mket({res[1]}, {3}));
+        cmat ref = adjoint(proj) * rho * proj;
+        double p = std::abs(trace(ref));
+        EXPECT_NEAR(p, std::get<1>(m), 1e-7);
+        EXPECT_NEAR(0, norm(std::get<2>(m) - ref / p), 1e-7);
+    }
+
+    EXPECT_THROW(measure_seq(rho, {3}, dims), exception::SubsysMismatchDims);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> std::tuple<std::vector<idx>, double>
+///       qpp::measure_inplace(Eigen::MatrixBase<Derived>& state,
+///       std::vector<idx> subsys,
+///       const std::vector<idx>& dims)
+TEST(qpp_measure_inplace, AllTests)
+{
+    // the collapsed state is the embedding of the state returned by
+    // qpp::measure_seq(), with the same dimensions
+    std::vector<idx> dims{3, 2, 3};
+    for (idx i = 0; i < 10; ++i)
+    {
+        ket psi = randket(18);
+        ket state = psi;
+        auto m = measure_inplace(state, {2, 0}, dims);
+        std::vector<idx> res = std::get<0>(m);
+        cmat proj = kron(mket({res[0]}, {3}), gt.Id2, mket({res[1]}, {3}));
+        ket ref = proj * adjoint(proj) * psi;
+        double p = std::pow(norm(ref), 2);
+        EXPECT_NEAR(p, std::get<1>(m), 1e-7);
+        EXPECT_EQ(18, state.rows());
+        EXPECT_NEAR(0, norm(state - ref / std::sqrt(p)), 1e-7);
+
+        cmat rho = randrho(18);
+        cmat rstate = rho;
+        m = measure_inplace(rstate, {1}, dims);
+        res = std::get<0>(m);
+        proj = kron(gt.Id(3), prj(mket({res[0]})), gt.Id(3));
+        cmat rref = proj * rho * proj;
+        p = std::abs(trace(rref));
+        EXPECT_NEAR(p, std::get<1>(m), 1e-7);
+        EXPECT_NEAR(0, norm(rstate - rref / p), 1e-7);
+    }
+
+    // no subsystems, the state is unchanged
+    ket psi = randket(18);
+    ket state = psi;
+    auto m = measure_inplace(state, {}, dims);
+    EXPECT_TRUE(std::get<0>(m).empty());
+    EXPECT_EQ(psi, state);
+
+    EXPECT_THROW(measure_inplace(state, {3}, dims),
+                 exception::SubsysMismatchDims);
+    EXPECT_THROW(measure_inplace(state, {0}, {2, 3}),
+                 exception::DimsMismatchCvector);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> std::tuple<std::vector<idx>, double>
+///       qpp::measure_inplace(Eigen::MatrixBase<Derived>& state,
+///       std::vector<idx> subsys,
+///       idx d = 2)
+TEST(qpp_measure_inplace_qubits, AllTests)
+{
+    // GHZ state, collapses onto |000> or |111>, repeated measurements give
+    // the same result
+    ket GHZ = (mket({0, 0, 0}) + mket({1, 1, 1})) / std::sqrt(2);
+    for (idx i = 0; i < 10; ++i)
+    {
+        ket psi = GHZ;
+        auto m = measure_inplace(psi, {1});
+        idx res = std::get<0>(m)[0];
+        EXPECT_NEAR(0.5, std::get<1>(m), 1e-7);
+        EXPECT_NEAR(0, norm(psi - mket({res, res, res})), 1e-7);
+        m = measure_inplace(psi, {0, 2});
+        EXPECT_EQ(std::vector<idx>({res, res}), std::get<0>(m));
+        EXPECT_NEAR(1, std::get<1>(m), 1e-7);
+
+        cmat rho = prj(GHZ);
+        m = measure_inplace(rho, {2});
+        res = std::get<0>(m)[0];
+        EXPECT_NEAR(0, norm(rho - prj(mket({res, res, res}))), 1e-7);
+    }
+
+    // evolution continues after a mid-circuit measurement
+    ket psi = mket({0, 0});
+    apply_inplace(psi, gt.H, {0});
+    auto m = measure_inplace(psi, {0});
+    applyCTRL_inplace(psi, gt.X, {0}, {1});
+    idx res = std::get<0>(m)[0];
+    EXPECT_NEAR(0, norm(psi - mket({res, res})), 1e-7);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> std::map<std::vector<idx>, idx>
+///       qpp::sample(idx num_samples,
+///       const Eigen::MatrixBase<Derived>& A,
+///       std::vector<idx> subsys,
+///       const std::vector<idx>& dims)
+TEST(qpp_sample, AllTests)
+{
+    // frequencies versus probabilities, mixed qudit state
+    std::vector<idx> dims{3, 2, 3};
+    cmat rho = randrho(18);
+    idx num_samples = 100000;
+    auto hist = sample(num_samples, rho, {2, 0}, dims);
+    idx total = 0;
+    for (auto&& elem : hist)
+    {
+        std::vector<idx> res = elem.first;
+        cmat proj = kron(mket({res[0]}, {3}), gt.Id2, mket({res[1]}, {3}));
+        double p = std::abs(trace(adjoint(proj) * rho * proj));
+        double f = static_cast<double>(elem.second) / num_samples;
+        // 6 standard deviations
+        EXPECT_NEAR(p, f, 6 * std::sqrt(p * (1 - p) / num_samples) + 1e-7);
+        total += elem.second;
+    }
+    EXPECT_EQ(num_samples, total);
+
+    // same for a ket
+    ket psi = randket(18);
+    hist = sample(num_samples, psi, {1}, dims);
+    for (auto&& elem : hist)
+    {
+        std::vector<idx> res = elem.first;
+        cmat proj = kron(gt.Id(3), mket({res[0]}), gt.Id(3));
+        double p = std::pow(norm(adjoint(proj) * psi), 2);
+        double f = static_cast<double>(elem.second) / num_samples;
+        EXPECT_NEAR(p, f, 6 * std::sqrt(p * (1 - p) / num_samples) + 1e-7);
+    }
+
+    EXPECT_EQ(0u, sample(0, psi, {1}, dims).size());
+    EXPECT_THROW(sample(10, psi, {3}, dims), exception::SubsysMismatchDims);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> std::map<std::vector<idx>, idx>
+///       qpp::sample(idx num_samples,
+///       const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<idx>& subsys,
+///       idx d = 2)
+TEST(qpp_sample_qubits, AllTests)
+{
+    // computational basis state, deterministic outcome
+    auto hist = sample(100, mket({1, 0, 1}), {2, 0});
+    EXPECT_EQ(1u, hist.size());
+    EXPECT_EQ(100u, (hist[{1, 1}]));
 
+    // GHZ state, only the correlated outcomes are sampled
+    ket GHZ = (mket({0, 0, 0}) + mket({1, 1, 1})) / std::sqrt(2);
+    idx num_samples = 100000;
+    hist = sample(num_samples, prj(GHZ), {0, 1, 2});
+    EXPECT_EQ(2u, hist.size());
+    EXPECT_EQ(num_samples, (hist[{0, 0, 0}] + hist[{1, 1, 1}]));
+    EXPECT_NEAR(0.5, static_cast<double>(hist[{0, 0, 0}]) / num_samples,
+                0.01);
 }
 /******************************************************************************/
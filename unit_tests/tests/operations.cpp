@@ -54,7 +54,155 @@ TEST(qpp_apply_qubits, AllTests)
 ///       const Eigen::MatrixBase<Derived>& A, const std::vector<cmat>& Ks)
 TEST(qpp_apply_full_kraus, AllTests)
 {
-
+    // compare with the explicit sum
+    cmat rho = randrho(6);
+    std::vector<cmat> Ks = randkraus(3, 6);
+    cmat result = cmat::Zero(6, 6);
+    for (auto&& K : Ks)
+        result += K * rho * adjoint(K);
+    EXPECT_NEAR(0, norm(apply(rho, Ks) - result), 1e-7);
+
+    // trace preserving
+    EXPECT_NEAR(1, std::abs(trace(apply(rho, Ks))), 1e-7);
+
+    EXPECT_THROW(apply(rho, std::vector<cmat>{}), exception::ZeroSize);
+    EXPECT_THROW(apply(rho, randkraus(2, 4)),
+                 exception::DimsMismatchMatrix);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived1, typename Derived2>
+///       void qpp::apply_inplace(
+///       Eigen::MatrixBase<Derived1>& state,
+///       const Eigen::MatrixBase<Derived2>& A,
+///       const std::vector<idx>& subsys,
+///       const std::vector<idx>& dims)
+TEST(qpp_apply_inplace, AllTests)
+{
+    // gate on a middle qudit, compare with the full operator
+    std::vector<idx> dims{2, 3, 2};
+    ket psi = randket(12);
+    cmat rho = randrho(12);
+    cmat U = randU(3);
+    cmat full = kron(gt.Id2, U, gt.Id2);
+
+    ket psi_out = psi;
+    apply_inplace(psi_out, U, {1}, dims);
+    EXPECT_NEAR(0, norm(psi_out - full * psi), 1e-7);
+
+    cmat rho_out = rho;
+    apply_inplace(rho_out, U, {1}, dims);
+    EXPECT_NEAR(0, norm(rho_out - full * rho * adjoint(full)), 1e-7);
+
+    // gate on non-adjacent subsystems in reversed order, product state
+    dims = {2, 3, 2};
+    ket a = randket(2), b = randket(3), c = randket(2);
+    cmat u1 = randU(2), u2 = randU(2);
+    psi_out = kron(a, b, c);
+    apply_inplace(psi_out, kron(u1, u2), {2, 0}, dims);
+    EXPECT_NEAR(0, norm(psi_out - kron(u2 * a, b, u1 * c)), 1e-7);
+
+    // pure state versus its density matrix
+    dims = {3, 2, 2, 3};
+    psi = randket(36);
+    rho = prj(psi);
+    U = randU(6);
+    apply_inplace(psi, U, {3, 1}, dims);
+    apply_inplace(rho, U, {3, 1}, dims);
+    EXPECT_NEAR(0, norm(prj(psi) - rho), 1e-7);
+
+    // must agree with qpp::apply()
+    ket phi = randket(36);
+    ket phi_out = phi;
+    apply_inplace(phi_out, U, {0, 2}, dims);
+    EXPECT_NEAR(0, norm(phi_out - apply(phi, U, {0, 2}, dims)), 1e-7);
+
+    // diagonal gates only rescale the amplitudes
+    dims = {2, 3, 2};
+    cmat Dg = cmat::Zero(6, 6);
+    for (idx i = 0; i < 6; ++i)
+        Dg(i, i) = std::exp(1_i * static_cast<double>(i));
+    full = kron(Dg, gt.Id2);
+    psi = randket(12);
+    psi_out = psi;
+    apply_inplace(psi_out, Dg, {0, 1}, dims);
+    EXPECT_NEAR(0, norm(psi_out - full * psi), 1e-7);
+    rho = randrho(12);
+    rho_out = rho;
+    apply_inplace(rho_out, Dg, {0, 1}, dims);
+    EXPECT_NEAR(0, norm(rho_out - full * rho * adjoint(full)), 1e-7);
+
+    // controlled diagonal qudit gate
+    full = gt.CTRL(gt.Zd(3), {2}, {0}, 3, 3);
+    psi = randket(27);
+    psi_out = psi;
+    applyCTRL_inplace(psi_out, gt.Zd(3), {2}, {0}, 3);
+    EXPECT_NEAR(0, norm(psi_out - full * psi), 1e-7);
+    rho = randrho(27);
+    rho_out = rho;
+    applyCTRL_inplace(rho_out, gt.Zd(3), {2}, {0}, 3);
+    EXPECT_NEAR(0, norm(rho_out - full * rho * adjoint(full)), 1e-7);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived1, typename Derived2>
+///       void qpp::apply_inplace(
+///       Eigen::MatrixBase<Derived1>& state,
+///       const Eigen::MatrixBase<Derived2>& A,
+///       const std::vector<idx>& subsys,
+///       idx d = 2)
+TEST(qpp_apply_inplace_qubits, AllTests)
+{
+    // 3 qubits, Hadamard on the middle one
+    ket psi = mket({0, 0, 0});
+    apply_inplace(psi, gt.H, {1});
+    EXPECT_NEAR(0, norm(psi - kron(st.z0, st.x0, st.z0)), 1e-7);
+
+    cmat rho = prj(mket({0, 0, 0}));
+    apply_inplace(rho, gt.H, {1});
+    EXPECT_NEAR(0, norm(rho - prj(kron(st.z0, st.x0, st.z0))), 1e-7);
+
+    // CNOT with control on qubit 2 and target on qubit 0
+    psi = mket({0, 1, 1});
+    apply_inplace(psi, gt.CNOT, {2, 0});
+    EXPECT_NEAR(0, norm(psi - mket({1, 1, 1})), 1e-7);
+
+    // 1-qubit gate on every qubit, compare with the full operator
+    idx N = 6;
+    cmat U = randU(2);
+    for (idx q = 0; q < N; ++q)
+    {
+        psi = randket(64);
+        ket psi_out = psi;
+        apply_inplace(psi_out, U, {q});
+        EXPECT_NEAR(0, norm(psi_out - gt.expandout(U, q, N) * psi), 1e-7);
+
+        cmat full = gt.expandout(U, q, N);
+        rho = randrho(64);
+        cmat rho_out = rho;
+        apply_inplace(rho_out, U, {q});
+        EXPECT_NEAR(0, norm(rho_out - full * rho * adjoint(full)), 1e-7);
+
+        cmat A = rand<cmat>(64, 64);
+        cmat A_out = A;
+        apply_inplace(A_out, U, {q});
+        EXPECT_NEAR(0, norm(A_out - full * A * adjoint(full)), 1e-7);
+    }
+
+    // 1 x 1 (diagonal) gate on no qubits, a global phase
+    cmat P(1, 1);
+    P << std::exp(1_i * 0.3);
+    psi = randket(64);
+    ket psi_out = psi;
+    apply_inplace(psi_out, P, {}, std::vector<idx>(N, 2));
+    EXPECT_NEAR(0, norm(psi_out - P(0, 0) * psi), 1e-7);
+    EXPECT_NEAR(0, norm(apply(psi, P, {}, std::vector<idx>(N, 2)) -
+                        P(0, 0) * psi), 1e-7);
+    cmat rho_out = prj(psi);
+    apply_inplace(rho_out, P, {}, std::vector<idx>(N, 2));
+    EXPECT_NEAR(0, norm(rho_out - prj(psi)), 1e-7);
+
+    // a gate on no subsystems must be 1 x 1
+    EXPECT_THROW(apply_inplace(psi_out, gt.H, {}, std::vector<idx>(N, 2)),
+                 exception::MatrixMismatchSubsys);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> cmat qpp::apply(
@@ -64,7 +212,31 @@ TEST(qpp_apply_full_kraus, AllTests)
 ///       const std::vector<idx>& dims)
 TEST(qpp_apply_kraus, AllTests)
 {
-
+    // compare with the sum of the Kraus operators applied one by one, both
+    // with many and with few Kraus operators (w.r.t. their dimension)
+    std::vector<idx> dims{2, 3, 2, 2};
+    cmat rho = randrho(24);
+    for (auto&& nk : {1, 2, 6})
+    {
+        std::vector<cmat> Ks = randkraus(nk, 6);
+        cmat result = cmat::Zero(24, 24);
+        for (auto&& K : Ks)
+            result += apply(rho, K, {3, 1}, dims);
+        EXPECT_NEAR(0, norm(apply(rho, Ks, {3, 1}, dims) - result), 1e-7);
+    }
+
+    // product state, the channel acts only on its subsystem
+    cmat A = randrho(2), B = randrho(3), C = randrho(2), D = randrho(2);
+    std::vector<cmat> Ks = randkraus(4, 3);
+    EXPECT_NEAR(0, norm(apply(kron(A, B, C, D), Ks, {1}, dims) -
+                        kron(A, apply(B, Ks), C, D)), 1e-7);
+
+    // non-Hermitian input
+    cmat X = rand<cmat>(24, 24);
+    cmat result = cmat::Zero(24, 24);
+    for (auto&& K : Ks)
+        result += apply(X, K, {1}, dims);
+    EXPECT_NEAR(0, norm(apply(X, Ks, {1}, dims) - result), 1e-7);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> cmat qpp::apply(
@@ -74,7 +246,99 @@ TEST(qpp_apply_kraus, AllTests)
 ///       idx d = 2)
 TEST(qpp_apply_kraus_qubits, AllTests)
 {
-
+    // amplitude damping on one qubit of a 3-qubit product state
+    double gamma = 0.3;
+    cmat K0(2, 2), K1(2, 2);
+    K0 << 1, 0, 0, std::sqrt(1 - gamma);
+    K1 << 0, std::sqrt(gamma), 0, 0;
+    cmat rho = prj(mket({1, 1, 0}));
+    cmat result = apply(rho, {K0, K1}, {1});
+    EXPECT_NEAR(0, norm(result - (1 - gamma) * prj(mket({1, 1, 0})) -
+                        gamma * prj(mket({1, 0, 0}))), 1e-7);
+
+    // 2-qubit channel on random qubits
+    std::vector<cmat> Ks = randkraus(5, 4);
+    rho = randrho(32);
+    result = cmat::Zero(32, 32);
+    for (auto&& K : Ks)
+        result += apply(rho, K, {4, 1});
+    EXPECT_NEAR(0, norm(apply(rho, Ks, {4, 1}) - result), 1e-7);
+
+    // few Kraus operators, on more blocks than are processed at once
+    Ks = randkraus(1, 4);
+    rho = randrho(1024);
+    EXPECT_NEAR(0, norm(apply(rho, Ks, {2, 7}) - apply(rho, Ks[0], {2, 7})),
+                1e-7);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived> cmat qpp::apply(
+///       const Eigen::MatrixBase<Derived>& A,
+///       const std::vector<sp_cmat>& Ks,
+///       const std::vector<idx>& subsys,
+///       const std::vector<idx>& dims)
+TEST(qpp_apply_kraus_sparse, AllTests)
+{
+    // sparse Kraus operators, on qudit subsystems and on the full system,
+    // compare with the dense Kraus operators
+    std::vector<idx> dims{2, 3, 2};
+    cmat rho = randrho(12);
+    std::vector<cmat> Ks = randkraus(3, 6);
+    std::vector<sp_cmat> sKs;
+    for (auto&& K : Ks)
+        sKs.push_back(K.sparseView());
+    EXPECT_NEAR(0, norm(apply(rho, sKs, {2, 1}, dims) -
+                        apply(rho, Ks, {2, 1}, dims)), 1e-7);
+
+    Ks = randkraus(2, 12);
+    sKs.clear();
+    for (auto&& K : Ks)
+        sKs.push_back(K.sparseView());
+    EXPECT_NEAR(0, norm(apply(rho, sKs) - apply(rho, Ks)), 1e-7);
+
+    // exceptions
+    EXPECT_THROW(apply(rho, sKs, {1}, dims), exception::MatrixMismatchSubsys);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived1, typename Derived2>
+///       dyn_mat<typename Derived1::Scalar> qpp::apply(
+///       const Eigen::MatrixBase<Derived1>& state,
+///       const Eigen::EigenBase<Derived2>& A,
+///       const std::vector<idx>& subsys,
+///       const std::vector<idx>& dims)
+TEST(qpp_apply_sparse, AllTests)
+{
+    // sparse gates, kets and density matrices, compare with the dense gates
+    std::vector<idx> dims{2, 3, 2, 2};
+    cmat U = randU(6);
+    sp_cmat S = U.sparseView();
+    ket psi = randket(24);
+    cmat rho = randrho(24);
+    EXPECT_NEAR(0, norm(apply(psi, S, {3, 1}, dims) -
+                        apply(psi, U, {3, 1}, dims)), 1e-7);
+    EXPECT_NEAR(0, norm(apply(rho, S, {3, 1}, dims) -
+                        apply(rho, U, {3, 1}, dims)), 1e-7);
+    ket psi_out = psi;
+    apply_inplace(psi_out, S, {3, 1}, dims);
+    EXPECT_NEAR(0, norm(psi_out - apply(psi, U, {3, 1}, dims)), 1e-7);
+
+    // a multi-controlled gate on all qubits, stored as a sparse matrix
+    idx N = 6;
+    cmat C = gt.CTRL(gt.H, {0, 1, 3, 4}, {2}, N);
+    sp_cmat SC = C.sparseView();
+    psi = randket(64);
+    rho = randrho(64);
+    std::vector<idx> all{0, 1, 2, 3, 4, 5};
+    EXPECT_NEAR(0, norm(apply(psi, SC, all) - C * psi), 1e-7);
+    EXPECT_NEAR(0, norm(apply(rho, SC, all) - C * rho * adjoint(C)), 1e-7);
+
+    // a sparse non-unitary operator on 3 of 6 qubits
+    cmat P = prj(mket({1, 0, 1})) + prj(mket({0, 1, 1}));
+    sp_cmat SP = P.sparseView();
+    EXPECT_NEAR(0, norm(apply(rho, SP, {5, 0, 2}) - apply(rho, P, {5, 0, 2})),
+                1e-7);
+
+    // exceptions
+    EXPECT_THROW(apply(psi, SP, {0, 1}), exception::MatrixMismatchSubsys);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived1, typename Derived2>
@@ -151,6 +415,166 @@ TEST(qpp_applyCTRL, EmptyControl)
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived1, typename Derived2>
+///       void qpp::applyCTRL_inplace(
+///       Eigen::MatrixBase<Derived1>& state,
+///       const Eigen::MatrixBase<Derived2>& A,
+///       const std::vector<idx>& ctrl,
+///       const std::vector<idx>& subsys,
+///       const std::vector<idx>& dims)
+TEST(qpp_applyCTRL_inplace, AllTests)
+{
+    // qutrits, compare with the full controlled gate
+    std::vector<idx> dims{3, 3, 3, 3};
+    std::vector<idx> ctrl{2, 0};
+    std::vector<idx> target{1};
+    cmat U = randU(3);
+    cmat CU = gt.CTRL(U, ctrl, target, 4, 3);
+
+    ket psi = randket(81);
+    ket psi_out = psi;
+    applyCTRL_inplace(psi_out, U, ctrl, target, dims);
+    EXPECT_NEAR(0, norm(psi_out - CU * psi), 1e-7);
+
+    cmat rho = randrho(81);
+    cmat rho_out = rho;
+    applyCTRL_inplace(rho_out, U, ctrl, target, dims);
+    EXPECT_NEAR(0, norm(rho_out - CU * rho * adjoint(CU)), 1e-7);
+
+    // non-Hermitian operator, the whole matrix must be computed
+    cmat A = rand<cmat>(81, 81);
+    cmat A_out = A;
+    applyCTRL_inplace(A_out, U, ctrl, target, dims);
+    EXPECT_NEAR(0, norm(A_out - CU * A * adjoint(CU)), 1e-7);
+
+    // qubits, two controls and a two-qubit target
+    dims = {2, 2, 2, 2, 2};
+    ctrl = {4, 1};
+    target = {3, 0};
+    U = randU(4);
+    CU = gt.CTRL(U, ctrl, target, 5);
+
+    psi = randket(32);
+    psi_out = psi;
+    applyCTRL_inplace(psi_out, U, ctrl, target, dims);
+    EXPECT_NEAR(0, norm(psi_out - CU * psi), 1e-7);
+
+    rho = randrho(32);
+    rho_out = rho;
+    applyCTRL_inplace(rho_out, U, ctrl, target, dims);
+    EXPECT_NEAR(0, norm(rho_out - CU * rho * adjoint(CU)), 1e-7);
+
+    // empty control, must agree with qpp::apply_inplace()
+    psi_out = psi;
+    applyCTRL_inplace(psi_out, U, {}, target, dims);
+    ket psi_apply = psi;
+    apply_inplace(psi_apply, U, target, dims);
+    EXPECT_NEAR(0, norm(psi_out - psi_apply), 1e-7);
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived1, typename Derived2>
+///       void qpp::applyCTRL_inplace(
+///       Eigen::MatrixBase<Derived1>& state,
+///       const Eigen::MatrixBase<Derived2>& A,
+///       const std::vector<idx>& ctrl,
+///       const std::vector<idx>& subsys,
+///       idx d = 2)
+TEST(qpp_applyCTRL_inplace_qubits, AllTests)
+{
+    // Toffoli on |110>, controls on qubits 0 and 1
+    ket psi = mket({1, 1, 0});
+    applyCTRL_inplace(psi, gt.X, {0, 1}, {2});
+    EXPECT_NEAR(0, norm(psi - mket({1, 1, 1})), 1e-7);
+
+    // control not activated
+    psi = mket({1, 0, 0});
+    applyCTRL_inplace(psi, gt.X, {0, 1}, {2});
+    EXPECT_NEAR(0, norm(psi - mket({1, 0, 0})), 1e-7);
+
+    cmat rho = prj(mket({1, 1, 0}));
+    applyCTRL_inplace(rho, gt.X, {0, 1}, {2});
+    EXPECT_NEAR(0, norm(rho - prj(mket({1, 1, 1}))), 1e-7);
+
+    // 3-qubit target, compare with the full controlled gate
+    cmat U = randU(8);
+    cmat CU = gt.CTRL(U, {3}, {5, 0, 2}, 6);
+    psi = randket(64);
+    ket psi_out = psi;
+    applyCTRL_inplace(psi_out, U, {3}, {5, 0, 2});
+    EXPECT_NEAR(0, norm(psi_out - CU * psi), 1e-7);
+
+    rho = randrho(64);
+    cmat rho_out = rho;
+    applyCTRL_inplace(rho_out, U, {3}, {5, 0, 2});
+    EXPECT_NEAR(0, norm(rho_out - CU * rho * adjoint(CU)), 1e-7);
+
+    cmat A = rand<cmat>(64, 64);
+    cmat A_out = A;
+    applyCTRL_inplace(A_out, U, {3}, {5, 0, 2});
+    EXPECT_NEAR(0, norm(A_out - CU * A * adjoint(CU)), 1e-7);
+
+    // 2-qubit gate on every pair of qubits, compare with the full operator
+    idx N = 6;
+    U = randU(4);
+    for (idx q1 = 0; q1 < N; ++q1)
+        for (idx q2 = 0; q2 < N; ++q2)
+        {
+            if (q1 == q2)
+                continue;
+            idx c = 0; // first qubit that is not a target
+            while (c == q1 || c == q2)
+                ++c;
+            CU = gt.CTRL(U, {c}, {q1, q2}, N);
+            psi = randket(64);
+            psi_out = psi;
+            applyCTRL_inplace(psi_out, U, {c}, {q1, q2});
+            EXPECT_NEAR(0, norm(psi_out - CU * psi), 1e-7);
+        }
+}
+/******************************************************************************/
+/// BEGIN inline bool qpp::internal::apply_ctrl_ket_qubits_simd(cplx* psi,
+///       const cmat& A, const QubitGateIndex& ix)
+TEST(qpp_applyCTRL_inplace_qubits_simd, AllTests)
+{
+    // vectorized kernels against the scalar ones, with 1, 2 and 3 free
+    // lowest qubits (AVX2 needs 1, AVX-512 needs 2)
+    idx N = 6;
+    for (idx nlow = 1; nlow <= 3; ++nlow)
+    {
+        idx q = N - 1 - nlow; // lowest qubit that is a target
+        for (auto&& gate : {std::make_pair(std::vector<idx>{},
+                                           std::vector<idx>{q}),
+                            std::make_pair(std::vector<idx>{},
+                                           std::vector<idx>{q, 0}),
+                            std::make_pair(std::vector<idx>{1},
+                                           std::vector<idx>{q, 0})})
+        {
+            cmat U = randU(static_cast<idx>(1) << gate.second.size());
+            internal::QubitGateIndex ix(gate.first, gate.second, N);
+            EXPECT_EQ(nlow, ix.min_fixed_pos());
+
+            ket psi = randket(64);
+            ket psi_simd = psi;
+            // false when built with NO_SIMD_ or not supported by the CPU
+            if (!internal::apply_ctrl_ket_qubits_simd(psi_simd.data(), U, ix))
+                continue;
+
+            // a run-time inner stride selects the scalar kernels
+            ket psi_scalar = psi;
+            Eigen::Map<ket, 0, Eigen::InnerStride<>> scalar_view(
+                    psi_scalar.data(), psi_scalar.size(),
+                    Eigen::InnerStride<>(1));
+            internal::apply_ctrl_ket_qubits_inplace(scalar_view, U, ix);
+            EXPECT_NEAR(0, norm(psi_simd - psi_scalar), 1e-12);
+
+            // and both against the full operator
+            cmat CU = CtrlGate(U, gate.first, gate.second,
+                               std::vector<idx>(N, 2)).to_dense();
+            EXPECT_NEAR(0, norm(psi_simd - CU * psi), 1e-7);
+        }
+    }
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived1, typename Derived2>
 ///       dyn_mat<typename Derived1::Scalar> qpp::applyCTRL(
 ///       const Eigen::MatrixBase<Derived1>& state,
 ///       const Eigen::MatrixBase<Derived2>& A,
@@ -160,6 +584,38 @@ TEST(qpp_applyCTRL, EmptyControl)
 TEST(qpp_applyCTRL_qubits, AllTests)
 {
 
+}
+/******************************************************************************/
+/// BEGIN template<typename Derived1, typename Derived2>
+///       dyn_mat<typename Derived1::Scalar> qpp::applyCTRL(
+///       const Eigen::MatrixBase<Derived1>& state,
+///       const Eigen::EigenBase<Derived2>& A,
+///       const std::vector<idx>& ctrl,
+///       const std::vector<idx>& subsys,
+///       const std::vector<idx>& dims)
+TEST(qpp_applyCTRL_sparse, AllTests)
+{
+    // controlled sparse gates, qubits and qudits (with powers of the gate),
+    // compare with the dense gates
+    cmat U = randU(4);
+    sp_cmat S = U.sparseView();
+    ket psi = randket(32);
+    cmat rho = randrho(32);
+    EXPECT_NEAR(0, norm(applyCTRL(psi, S, {0, 4}, {3, 1}) -
+                        applyCTRL(psi, U, {0, 4}, {3, 1})), 1e-7);
+    EXPECT_NEAR(0, norm(applyCTRL(rho, S, {2}, {3, 1}) -
+                        applyCTRL(rho, U, {2}, {3, 1})), 1e-7);
+
+    std::vector<idx> dims{3, 3, 3};
+    cmat V = randU(3);
+    sp_cmat SV = V.sparseView();
+    psi = randket(27);
+    rho = randrho(27);
+    cmat CV = gt.CTRL(V, {2}, {0}, 3, 3);
+    EXPECT_NEAR(0, norm(applyCTRL(psi, SV, {2}, {0}, dims) - CV * psi), 1e-7);
+    cmat rho_out = rho;
+    applyCTRL_inplace(rho_out, SV, {2}, {0}, dims);
+    EXPECT_NEAR(0, norm(rho_out - CV * rho * adjoint(CV)), 1e-7);
 }
 /******************************************************************************/
 /// BEGIN inline std::vector<cmat> qpp::choi2kraus(const cmat& A)
@@ -171,19 +627,60 @@ TEST(qpp_choi2kraus, AllTests)
 /// BEGIN inline cmat qpp::choi2super(const cmat& A)
 TEST(qpp_choi2super, AllTests)
 {
+    // Choi and superoperator matrices of the same channel
+    std::vector<cmat> Ks = randkraus(3, 3);
+    EXPECT_NEAR(0, norm(choi2super(kraus2choi(Ks)) - kraus2super(Ks)), 1e-7);
 
+    // the superoperator of the identity channel is the identity
+    EXPECT_NEAR(0, norm(choi2super(kraus2choi({gt.Id(4)})) - gt.Id(16)),
+                1e-7);
 }
 /******************************************************************************/
 /// BEGIN inline cmat qpp::kraus2choi(const std::vector<cmat>& Ks)
 TEST(qpp_kraus2choi, AllTests)
 {
-
+    // compare with the definition sum_i (I x K_i) |Omega><Omega| (I x K_i)^+
+    idx D = 3;
+    std::vector<cmat> Ks = randkraus(4, D);
+    ket MES = ket::Zero(D * D);
+    for (idx a = 0; a < D; ++a)
+        MES(a * D + a) = 1;
+    cmat result = cmat::Zero(D * D, D * D);
+    for (auto&& K : Ks)
+    {
+        cmat IK = kron(gt.Id(D), K);
+        result += IK * MES * adjoint(MES) * adjoint(IK);
+    }
+    EXPECT_NEAR(0, norm(kraus2choi(Ks) - result), 1e-7);
+
+    // the Choi matrix of a channel is positive semidefinite with trace D
+    EXPECT_NEAR(D, std::abs(trace(result)), 1e-7);
+    EXPECT_GT(hevals(kraus2choi(Ks)).minCoeff(), -1e-7);
 }
 /******************************************************************************/
 /// BEGIN inline cmat qpp::kraus2super(const std::vector<cmat>& Ks)
 TEST(qpp_kraus2super, AllTests)
 {
-
+    // result(ab, mn) = <a|E(|m><n|)|b>
+    idx D = 3;
+    std::vector<cmat> Ks = randkraus(4, D);
+    cmat S = kraus2super(Ks);
+    for (idx m = 0; m < D; ++m)
+        for (idx n = 0; n < D; ++n)
+        {
+            cmat MN = cmat::Zero(D, D);
+            MN(m, n) = 1;
+            cmat EMN = apply(MN, Ks);
+            for (idx a = 0; a < D; ++a)
+                for (idx b = 0; b < D; ++b)
+                    EXPECT_NEAR(0, std::abs(S(a * D + b, m * D + n) -
+                                            EMN(a, b)), 1e-7);
+        }
+
+    // acts on the row-major vectorization of the input
+    cmat rho = randrho(D);
+    EXPECT_NEAR(0, norm(reshape(S * reshape(transpose(rho), D * D, 1), D, D) -
+                        transpose(apply(rho, Ks))), 1e-7);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_mat<typename Derived::Scalar>
@@ -192,7 +689,29 @@ TEST(qpp_kraus2super, AllTests)
 ///       const std::vector<idx>& dims)
 TEST(qpp_ptrace, AllTests)
 {
-
+    // product density matrix
+    std::vector<idx> dims{2, 3, 2};
+    cmat A = randH(2), B = randH(3), C = randH(2);
+    cmat rho = kron(A, B, C);
+    EXPECT_NEAR(0, norm(ptrace(rho, {1}, dims) - B.trace() * kron(A, C)),
+                1e-7);
+    EXPECT_NEAR(0, norm(ptrace(rho, {2, 0}, dims) -
+                        A.trace() * C.trace() * B), 1e-7);
+    EXPECT_NEAR(0, norm(ptrace(rho, {}, dims) - rho), 1e-7);
+    EXPECT_NEAR(0, std::abs(ptrace(rho, {0, 1, 2}, dims)(0, 0) - trace(rho)),
+                1e-7);
+
+    // product ket
+    ket a = randket(2), b = randket(3), c = randket(2);
+    ket psi = kron(a, b, c);
+    EXPECT_NEAR(0, norm(ptrace(psi, {0, 2}, dims) - prj(b)), 1e-7);
+    EXPECT_NEAR(0, norm(ptrace(psi, {1}, dims) - kron(prj(a), prj(c))),
+                1e-7);
+
+    // ket and its density matrix agree
+    psi = randket(12);
+    EXPECT_NEAR(0, norm(ptrace(psi, {1}, dims) - ptrace(prj(psi), {1}, dims)),
+                1e-7);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_mat<typename Derived::Scalar>
@@ -201,7 +720,14 @@ TEST(qpp_ptrace, AllTests)
 ///       idx d = 2)
 TEST(qpp_ptrace_qubits, AllTests)
 {
-
+    cmat A = randH(2), B = randH(2), C = randH(2);
+    cmat rho = kron(A, B, C);
+    EXPECT_NEAR(0, norm(ptrace(rho, {0}) - A.trace() * kron(B, C)), 1e-7);
+    EXPECT_NEAR(0, norm(ptrace(rho, {0, 1}) - A.trace() * B.trace() * C),
+                1e-7);
+
+    ket psi = kron(st.z0, st.x0, st.z1);
+    EXPECT_NEAR(0, norm(ptrace(psi, {0, 2}) - prj(st.x0)), 1e-7);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_mat<typename Derived::Scalar>
@@ -240,7 +766,22 @@ TEST(qpp_ptrace2_qubits, AllTests)
 ///       const std::vector<idx>& dims)
 TEST(qpp_ptranspose, AllTests)
 {
-
+    // product density matrix
+    std::vector<idx> dims{2, 3, 2};
+    cmat A = randU(2), B = randU(3), C = randU(2);
+    cmat rho = kron(A, B, C);
+    EXPECT_NEAR(0, norm(ptranspose(rho, {1}, dims) -
+                        kron(A, transpose(B), C)), 1e-7);
+    EXPECT_NEAR(0, norm(ptranspose(rho, {2, 0}, dims) -
+                        kron(transpose(A), B, transpose(C))), 1e-7);
+    EXPECT_NEAR(0, norm(ptranspose(rho, {}, dims) - rho), 1e-7);
+    EXPECT_NEAR(0, norm(ptranspose(rho, {0, 1, 2}, dims) - transpose(rho)),
+                1e-7);
+
+    // ket and its density matrix agree
+    ket psi = randket(12);
+    EXPECT_NEAR(0, norm(ptranspose(psi, {0, 1}, dims) -
+                        ptranspose(prj(psi), {0, 1}, dims)), 1e-7);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_mat<typename Derived::Scalar>
@@ -249,13 +790,25 @@ TEST(qpp_ptranspose, AllTests)
 ///       idx d = 2)
 TEST(qpp_ptranspose_qubits, AllTests)
 {
+    cmat A = randU(2), B = randU(2), C = randU(2);
+    cmat rho = kron(A, B, C);
+    EXPECT_NEAR(0, norm(ptranspose(rho, {0}) - kron(transpose(A), B, C)),
+                1e-7);
 
+    // the partial transpose of a Bell state is SWAP/2
+    EXPECT_NEAR(0, norm(ptranspose(prj(st.b00), {1}) - gt.SWAP / 2.), 1e-7);
 }
 /******************************************************************************/
 /// BEGIN inline cmat qpp::super2choi(const cmat& A)
 TEST(qpp_super2choi, AllTests)
 {
+    // Choi and superoperator matrices of the same channel
+    std::vector<cmat> Ks = randkraus(3, 3);
+    EXPECT_NEAR(0, norm(super2choi(kraus2super(Ks)) - kraus2choi(Ks)), 1e-7);
 
+    // inverse of qpp::choi2super()
+    cmat A = rand<cmat>(9, 9);
+    EXPECT_NEAR(0, norm(super2choi(choi2super(A)) - A), 1e-7);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_mat<typename Derived::Scalar>
@@ -264,7 +817,18 @@ TEST(qpp_super2choi, AllTests)
 ///       const std::vector<idx>& dims)
 TEST(qpp_syspermute, AllTests)
 {
-
+    std::vector<idx> dims{2, 3, 4};
+    ket a = randket(2), b = randket(3), c = randket(4);
+    ket psi = kron(a, b, c);
+    // the subsystem perm[i] is permuted to the location i
+    EXPECT_NEAR(0, norm(syspermute(psi, {2, 0, 1}, dims) - kron(c, a, b)),
+                1e-7);
+    EXPECT_NEAR(0, norm(syspermute(psi, {0, 1, 2}, dims) - psi), 1e-7);
+
+    cmat A = randU(2), B = randU(3), C = randU(4);
+    cmat rho = kron(A, B, C);
+    EXPECT_NEAR(0, norm(syspermute(rho, {1, 2, 0}, dims) - kron(B, C, A)),
+                1e-7);
 }
 /******************************************************************************/
 /// BEGIN template<typename Derived> dyn_mat<typename Derived::Scalar>
@@ -273,6 +837,13 @@ TEST(qpp_syspermute, AllTests)
 ///       idx d = 2)
 TEST(qpp_syspermute_qubits, AllTests)
 {
-
+    ket psi = kron(st.z0, st.z1, st.x0);
+    EXPECT_NEAR(0, norm(syspermute(psi, {2, 1, 0}) -
+                        kron(st.x0, st.z1, st.z0)), 1e-7);
+
+    // permuting two qubits is the same as applying SWAP
+    cmat rho = randrho(4);
+    EXPECT_NEAR(0, norm(syspermute(rho, {1, 0}) - gt.SWAP * rho * gt.SWAP),
+                1e-7);
 }
 /******************************************************************************/